@@ -108,6 +108,13 @@ bool AppCfg::watchConfig(cfgmgr_watch_callback_t watch_callback, void* user_data
     return true;
 }
 
+bool AppCfg::watchConfigDiff(cfgmgr_watch_diff_callback_t watch_callback, void* user_data) {
+    // Creating /<AppName>/config key
+    std::string config_key = "/" + std::string(m_cfgmgr->app_name) + "/config";
+    // Calling the base cfgmgr_watch_diff C API
+    return cfgmgr_watch_diff(m_cfgmgr, config_key.c_str(), watch_callback, user_data);
+}
+
 bool AppCfg::watchInterface(cfgmgr_watch_callback_t watch_callback, void* user_data) {
     // Creating /<AppName>/interfaces key
     std::string interface_key = "/" + std::string(m_cfgmgr->app_name) + "/interfaces";
@@ -97,6 +97,28 @@ bool ConfigMgr::isDevMode() {
     return cfgmgr_is_dev_mode(m_cfgmgr);
 }
 
+std::vector<cfgmgr_msgbus_config_t> ConfigMgr::getAllMsgBusConfigs() {
+    LOG_DEBUG("In %s method", __func__);
+    // Calling the base C cfgmgr_get_all_msgbus_configs API
+    int num_configs = 0;
+    cfgmgr_msgbus_config_t* configs = cfgmgr_get_all_msgbus_configs(m_cfgmgr,
+                                                                    &num_configs);
+    if (configs == NULL) {
+        throw "Failed to fetch the msgbus configs";
+    }
+    std::vector<cfgmgr_msgbus_config_t> msgbus_configs(configs, configs + num_configs);
+    // The configs are owned by the caller now, only freeing the array
+    free(configs);
+    return msgbus_configs;
+}
+
+void ConfigMgr::refreshEnvOverrides() {
+    // Calling the base C cfgmgr_refresh_env_overrides API
+    if (!cfgmgr_refresh_env_overrides(m_cfgmgr)) {
+        throw "Failed to refresh the env overrides";
+    }
+}
+
 std::string ConfigMgr::getAppName() {
     // Calling the base C cfgmgr_get_appname_base API
     config_value_t* appname = cfgmgr_get_appname(m_cfgmgr);
@@ -137,6 +137,15 @@ namespace eii {
                  */
                 bool watchConfig(cfgmgr_watch_callback_t watch_callback, void* user_data);
 
+                /**
+                 * Register a callback to watch on app config, notified with the
+                 * members added, removed and changed since the previous config
+                 * @param watch_callback - callback object
+                 * @param user_data - user data to be sent to callback
+                 * @return bool - Boolean whether the callback was registered
+                 */
+                bool watchConfigDiff(cfgmgr_watch_diff_callback_t watch_callback, void* user_data);
+
                 /**
                  * Register a callback to watch on app interface
                  * @param watch_callback - callback object
@@ -24,6 +24,8 @@
  */
 
 #include <ctype.h>
+#include <pthread.h>
+#include <stdint.h>
 #include "eii/config_manager/kv_store_plugin/kv_store_plugin.h"
 #include "eii/config_manager/cfgmgr_util.h"
 
@@ -52,6 +54,19 @@
 extern "C" {
 #endif
 
+// State of a watch registered with cfgmgr_watch_diff()
+struct cfgmgr_diff_watch;
+struct cfgmgr_key_watch;
+
+// Name to interface index of the application interfaces
+struct cfgmgr_iface_index;
+
+// Memoized msgbus configs of the application interfaces
+struct cfgmgr_msgbus_cache;
+
+// Env overrides of the msgbus configs
+struct cfgmgr_env_overrides;
+
 /**
  * ConfigMgr context struct
  */
@@ -61,12 +76,39 @@ typedef struct  {
     // to be set in the Go/Py/Cpp bindings
     char* env_var;
 
-    // Application config
+    // Application config, replaced once when read from a snapshot that
+    // turns out to be stale
     config_t* app_config;
 
-    // Application interface
+    // App config read from the snapshot and replaced, kept until destroy
+    config_t* snapshot_app_config;
+
+    // Application interface, owned by iface_index
     config_t* app_interface;
 
+    // Index of the interfaces by name, rebuilt when the interfaces change.
+    // A reference is held on it until destroy
+    struct cfgmgr_iface_index* iface_index;
+
+    // Indexes replaced by a change of the interfaces, kept until destroy
+    struct cfgmgr_iface_index* replaced_iface_indexes;
+
+    // Revision of the interfaces, bumped when they change
+    uint64_t iface_revision;
+
+    // Msgbus configs memoized when CONFIGMGR_MSGBUS_CACHE is set to
+    // true, NULL otherwise
+    struct cfgmgr_msgbus_cache* msgbus_cache;
+
+    // PUBLISHER_, SUBSCRIBER_, SERVER_ and CLIENT_ env overrides read by
+    // the msgbus config builders, snapshotted once GlobalEnv is applied.
+    // A reference is held on them until they are refreshed
+    struct cfgmgr_env_overrides* env_overrides;
+
+    // Guards app_config, app_interface, iface_index, replaced_iface_indexes,
+    // iface_revision, msgbus_cache, env_overrides, key_watches_lost and diff_watches
+    pthread_mutex_t iface_mtx;
+
     // Application data store
     config_t* data_store;
 
@@ -82,6 +124,21 @@ typedef struct  {
     // kv_store_handle to hold the kv_store object
     void* kv_store_handle;
 
+    // Key material read by the msgbus config builders, resolved once per
+    // key revision in prod mode, NULL in dev mode
+    cfgmgr_key_resolver_t* key_resolver;
+
+    // Watches of the public keys and the private key that are not live,
+    // key_resolver being disabled until both are created again
+    unsigned int key_watches_lost;
+
+    // User data of the watches of the public keys and the private key,
+    // freed on destroy
+    struct cfgmgr_key_watch* key_watches;
+
+    // Watches registered with cfgmgr_watch_diff(), freed on destroy
+    struct cfgmgr_diff_watch* diff_watches;
+
 } cfgmgr_ctx_t;
 
 /**
@@ -100,8 +157,29 @@ typedef struct {
     // Holds the cfgmgr context
     cfgmgr_ctx_t* cfg_mgr;
 
+    // Index of the interfaces document interface points into, a
+    // reference is held on it until cfgmgr_interface_destroy()
+    struct cfgmgr_iface_index* iface_index;
+
 } cfgmgr_interface_t;
 
+/**
+ * Msgbus config of an interface returned by cfgmgr_get_all_msgbus_configs()
+ */
+typedef struct {
+
+    // Type of the interface
+    cfgmgr_iface_type_t type;
+
+    // Index of the interface among the interfaces of its type
+    int index;
+
+    // Msgbus config of the interface, as returned by
+    // cfgmgr_get_msgbus_config()
+    config_t* msgbus_config;
+
+} cfgmgr_msgbus_config_t;
+
 
 /**
  * To check whether environment is dev mode or prod mode
@@ -118,14 +196,17 @@ bool cfgmgr_is_dev_mode(cfgmgr_ctx_t* cfgmgr);
 config_value_t* cfgmgr_get_appname(cfgmgr_ctx_t* cfgmgr);
 
 /**
- * cfgmgr_get_app_config function to return app config
+ * cfgmgr_get_app_config function to return app config, when started from
+ * a stale snapshot the config returned before the snapshot keys are read
+ * again stays valid until cfgmgr_destroy()
  * @param cfgmgr - cfgmgr_ctx_t object
  *  @return NULL for any errors occured or config_t* on success
  */
 config_t* cfgmgr_get_app_config(cfgmgr_ctx_t* cfgmgr);
 
 /**
- * cfgmgr_get_app_interface function to return app interface
+ * cfgmgr_get_app_interface function to return app interface, it stays
+ * valid until cfgmgr_destroy() even if the interfaces are updated
  * @param cfgmgr - cfgmgr_ctx_t object
  *  @return NULL for any errors occured or config_t* on success
  */
@@ -140,7 +221,8 @@ config_t* cfgmgr_get_app_interface(cfgmgr_ctx_t* cfgmgr);
 config_value_t* cfgmgr_get_app_config_value(cfgmgr_ctx_t* cfgmgr, const char* key);
 
 /**
- * cfgmgr_get_app_interface_value function to fetch app interface value
+ * cfgmgr_get_app_interface_value function to fetch app interface value, an
+ * object or array value stays valid until cfgmgr_destroy()
  * @param cfgmgr - cfgmgr_ctx_t object
  * @param key - value of key to be fetched
  *  @return NULL for any errors occured or config_value_t* on success
@@ -150,11 +232,54 @@ config_value_t* cfgmgr_get_app_interface_value(cfgmgr_ctx_t* cfgmgr, const char*
 /**
  * cfgmgr_get_msgbus_config function to fetch msgbus config
  * 
+ * When CONFIGMGR_MSGBUS_CACHE is set to true the config is memoized, it is
+ * shared between the calls and immutable
  * @param ctx - cfgmgr_interface_t object
  *  @return NULL for any errors occured or config_value_t* on success
  */
 config_t* cfgmgr_get_msgbus_config(cfgmgr_interface_t* ctx);
 
+/**
+ * cfgmgr_get_all_msgbus_configs function to fetch the msgbus configs of
+ * every interface of the application
+ *
+ * The interfaces are resolved in one pass over the application interface
+ * and their configs are built concurrently, the keys read by several
+ * interfaces such as the application's own keys being fetched only once
+ * @param cfgmgr - cfgmgr_ctx_t object
+ * @param num_configs - set to the number of configs returned
+ *  @return NULL for any errors occured or an array of num_configs configs,
+ *          the publishers first then the subscribers, servers and clients,
+ *          each in index order, on success. To be freed with
+ *          cfgmgr_msgbus_configs_destroy()
+ */
+cfgmgr_msgbus_config_t* cfgmgr_get_all_msgbus_configs(cfgmgr_ctx_t* cfgmgr, int* num_configs);
+
+/**
+ * Destroy the configs returned by cfgmgr_get_all_msgbus_configs()
+ * @param configs - configs to destroy
+ * @param num_configs - number of configs
+ */
+void cfgmgr_msgbus_configs_destroy(cfgmgr_msgbus_config_t* configs, int num_configs);
+
+/**
+ * cfgmgr_refresh_env_overrides function to snapshot the PUBLISHER_,
+ * SUBSCRIBER_, SERVER_ and CLIENT_ env overrides again, the msgbus configs
+ * only see the env vars set before the last snapshot
+ * @param cfgmgr - cfgmgr_ctx_t object
+ *  @return true on success, false on failure
+ */
+bool cfgmgr_refresh_env_overrides(cfgmgr_ctx_t* cfgmgr);
+
+/**
+ * cfgmgr_get_key_stats function to fetch the statistics of the key
+ * material resolved for the msgbus configs
+ * @param cfgmgr - cfgmgr_ctx_t object
+ * @param stats - set to the statistics of the key resolver
+ *  @return true on success, false in dev mode where no keys are resolved
+ */
+bool cfgmgr_get_key_stats(cfgmgr_ctx_t* cfgmgr, cfgmgr_key_stats_t* stats);
+
 /**
  * get_endpoint_base function to fetch endpoint
  * 
@@ -246,6 +371,29 @@ void cfgmgr_watch(cfgmgr_ctx_t* cfgmgr, const char* key, cfgmgr_watch_callback_t
  */
 void cfgmgr_watch_prefix(cfgmgr_ctx_t* cfgmgr, char* prefix, cfgmgr_watch_callback_t watch_callback, void* user_data);
 
+/**
+ * Format for the callback of cfgmgr_watch_diff
+ * @param key - key changed
+ * @param value - new value of the key, NULL if it was deleted. Owned by the callee
+ * @param diff - members added, removed and changed since the previous value,
+ *               valid only during the call
+ * @param user_data - user_data passed to cfgmgr_watch_diff
+ */
+typedef void (*cfgmgr_watch_diff_callback_t)(const char* key, config_t* value,
+                                             const cfgmgr_config_diff_t* diff, void* user_data);
+
+/**
+ * function to register a callback notified of the structural diff of a
+ * JSON key. The value of the key is kept and every change is compared to
+ * the previous value, changes leaving the document identical are not notified
+ * @param cfgmgr - cfgmgr_ctx_t object
+ * @param key - key to watch on
+ * @param watch_callback - cfgmgr_watch_diff_callback_t object
+ * @param user_data - user_data to be sent to callback
+ * @return false for any errors occured or true on success
+ */
+bool cfgmgr_watch_diff(cfgmgr_ctx_t* cfgmgr, const char* key, cfgmgr_watch_diff_callback_t watch_callback, void* user_data);
+
 /**
  * cfgmgr_get_interface_value function to fetch interface value
  * @param cfgmgr_interface - cfgmgr_interface_t object
@@ -325,7 +473,8 @@ cfgmgr_interface_t* cfgmgr_get_client_by_index(cfgmgr_ctx_t* cfgmgr, int index);
 cfgmgr_ctx_t* cfgmgr_initialize();
 
 /**
- * Destroy cfgmgr_ctx_t* object.
+ * Destroy cfgmgr_ctx_t* object. Every watch registered through cfg_mgr is
+ * cancelled, no watch callback is invoked once this function returns.
  *
  * @param cfg_mgr - configuration to destroy
  */
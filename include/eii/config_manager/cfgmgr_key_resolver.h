@@ -0,0 +1,173 @@
+// Copyright (c) 2021 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @file
+ * @brief Key material read by the msgbus config builders, loaded once per
+ *        revision of the keys
+ */
+
+#ifndef EII_CFGMGR_KEY_RESOLVER_H
+#define EII_CFGMGR_KEY_RESOLVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <eii/config_manager/kv_store_plugin/kv_store_plugin.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Resolver of the public and private keys read by the msgbus config builders
+ */
+typedef struct cfgmgr_key_resolver cfgmgr_key_resolver_t;
+
+/**
+ * Key material resolved by a cfgmgr_key_resolver_t, shared by every caller
+ * resolving the same key until the keys change
+ */
+typedef struct cfgmgr_key cfgmgr_key_t;
+
+/**
+ * Counters of a key resolver
+ */
+typedef struct {
+    // Reads served from the resolved keys instead of the kv store
+    uint64_t fetches_saved;
+
+    // Reads forwarded to the kv store
+    uint64_t fetches;
+
+    // Times the resolved keys were dropped on a change of the keys
+    uint64_t invalidations;
+} cfgmgr_key_stats_t;
+
+/**
+ * Creates a key resolver reading the keys from a kv store. The resolved
+ * keys are kept until cfgmgr_key_resolver_invalidate() is called, the
+ * owner of the resolver must call it whenever the keys change.
+ *
+ * @param kv_store_client - client the keys are read with, not owned
+ * @param handle          - handle of kv_store_client
+ * @return cfgmgr_key_resolver_t, or NULL on failure
+ */
+cfgmgr_key_resolver_t* cfgmgr_key_resolver_new(kv_store_client_t* kv_store_client, void* handle);
+
+/**
+ * Resolves the value of a key. A key not found is read again on every call
+ *
+ * @param resolver - key resolver
+ * @param key      - key to be resolved
+ * @return key to be released with cfgmgr_key_release(), NULL if the key
+ *         was not found or on failure
+ */
+cfgmgr_key_t* cfgmgr_key_resolve(cfgmgr_key_resolver_t* resolver, const char* key);
+
+/**
+ * Resolves the values of several keys, the keys not resolved yet being
+ * read with a single request
+ *
+ * @param resolver - key resolver
+ * @param keys     - keys to be resolved
+ * @param num_keys - number of keys
+ * @param resolved - filled with num_keys keys in the order of keys, NULL for
+ *                   the keys not found. Every key must be released with
+ *                   cfgmgr_key_release()
+ * @return true on success, false on failure
+ */
+bool cfgmgr_key_resolve_many(cfgmgr_key_resolver_t* resolver, char** keys, size_t num_keys,
+                             cfgmgr_key_t** resolved);
+
+/**
+ * Resolves the values of every key under a prefix
+ *
+ * @param resolver - key resolver
+ * @param prefix   - key prefix to be resolved
+ * @return key to be released with cfgmgr_key_release(), its values being
+ *         empty if no key was found, NULL on failure
+ */
+cfgmgr_key_t* cfgmgr_key_resolve_prefix(cfgmgr_key_resolver_t* resolver, const char* prefix);
+
+/**
+ * Returns the value of a key resolved with cfgmgr_key_resolve() or
+ * cfgmgr_key_resolve_many()
+ *
+ * @param key - resolved key
+ * @return value owned by key
+ */
+const char* cfgmgr_key_value(const cfgmgr_key_t* key);
+
+/**
+ * Returns the values of a key resolved with cfgmgr_key_resolve_prefix()
+ *
+ * @param key        - resolved key
+ * @param num_values - filled with the number of values
+ * @return values owned by key
+ */
+const char* const* cfgmgr_key_values(const cfgmgr_key_t* key, size_t* num_values);
+
+/**
+ * Releases a resolved key
+ *
+ * @param key - key to be released, can be NULL
+ */
+void cfgmgr_key_release(cfgmgr_key_t* key);
+
+/**
+ * Drops the resolved keys, the next calls reading them from the kv store
+ * again. Keys already handed out stay valid until released
+ *
+ * @param resolver - key resolver
+ */
+void cfgmgr_key_resolver_invalidate(cfgmgr_key_resolver_t* resolver);
+
+/**
+ * Enables or disables a key resolver, dropping the resolved keys. A
+ * disabled resolver reads every key from the kv store without keeping it,
+ * for as long as the changes of the keys cannot be followed
+ *
+ * @param resolver - key resolver
+ * @param enabled  - true to keep the resolved keys, false to read them
+ *                   from the kv store on every call
+ */
+void cfgmgr_key_resolver_set_enabled(cfgmgr_key_resolver_t* resolver, bool enabled);
+
+/**
+ * Reads the counters of a key resolver
+ *
+ * @param resolver - key resolver
+ * @param stats    - counters to be filled
+ */
+void cfgmgr_key_resolver_get_stats(cfgmgr_key_resolver_t* resolver, cfgmgr_key_stats_t* stats);
+
+/**
+ * Destroys a key resolver. Keys already handed out stay valid until released
+ *
+ * @param resolver - key resolver to be destroyed
+ */
+void cfgmgr_key_resolver_destroy(cfgmgr_key_resolver_t* resolver);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EII_CFGMGR_KEY_RESOLVER_H
@@ -32,6 +32,7 @@
 #include <ctype.h>
 #include "eii/utils/json_config.h"
 #include "eii/config_manager/kv_store_plugin/kv_store_plugin.h"
+#include "eii/config_manager/cfgmgr_key_resolver.h"
 #define BROKERED "brokered"
 #define SOCKET_FILE "socket_file"
 #define ENDPOINT "EndPoint"
@@ -62,6 +63,43 @@ typedef enum {
     CFGMGR_CLIENT = 3,
 } cfgmgr_iface_type_t;
 
+/**
+ * Structural difference between two JSON configurations. Every member is a
+ * JSON pointer (RFC 6901) such as "/Publishers/0/Topics", "" being the
+ * whole document
+ */
+typedef struct {
+    // members present only in the new configuration
+    char** added;
+    size_t num_added;
+
+    // members present only in the previous configuration
+    char** removed;
+    size_t num_removed;
+
+    // members present in both whose value differs, compared as a whole
+    // unless both are objects or arrays
+    char** changed;
+    size_t num_changed;
+} cfgmgr_config_diff_t;
+
+/**
+ * cfgmgr_config_diff function to compute the members added, removed and changed
+ * between two JSON configurations. Objects are compared member by member and
+ * arrays element by element
+ * @param previous - previous configuration, NULL for an empty object
+ * @param current - new configuration, NULL for an empty object
+ * @param diff - filled with the differences, to be freed with cfgmgr_config_diff_free()
+ * @return true on success, false on failure
+ */
+bool cfgmgr_config_diff(const config_t* previous, const config_t* current, cfgmgr_config_diff_t* diff);
+
+/**
+ * cfgmgr_config_diff_free function to free the paths held by a cfgmgr_config_diff_t
+ * @param diff - difference filled by cfgmgr_config_diff()
+ */
+void cfgmgr_config_diff_free(cfgmgr_config_diff_t* diff);
+
 /**
  * cvt_to_char function to convert config_value_t* to char*
  * @param config_value_t* - config_value_t* object
@@ -93,29 +131,36 @@ bool get_ipc_config(config_t* c_json, config_value_t* config, const char* end_po
  */
 char* cvt_obj_str_to_char(config_value_t* cvt);
 
+/**
+ * add_allowed_clients_keys function adds the public keys of the AllowedClients of an interface to its message bus config
+ * @param c_json : Main config_t object where the entire message bus config is held
+ * @param allowed_clients : AllowedClients of the interface, "*" for every provisioned application
+ * @param key_resolver : resolver the public keys are read with
+ * @return true on sucess, false on fail
+ */
+bool add_allowed_clients_keys(config_t* c_json, config_value_t* allowed_clients, cfgmgr_key_resolver_t* key_resolver);
+
 /**
  * construct_tcp_publisher_prod function constructs the publisher message bus config for prod mode
  * @param app_name : Application name
  * @param c_json : Main config_t object where the entire message bus config is held
  * @param inner_json : nested json where endpoint and certificates details are stored
- * @param handle : kv store's handle
+ * @param key_resolver : resolver the keys are read with
  * @param config : publisher's interface config
- * @param kv_store_client : kv store client object
  * @return true on sucess, false on fail
  */
-bool construct_tcp_publisher_prod(char* app_name, config_t* c_json, config_t* inner_json, void* handle, config_value_t* config, kv_store_client_t* kv_store_client);
+bool construct_tcp_publisher_prod(char* app_name, config_t* c_json, config_t* inner_json, cfgmgr_key_resolver_t* key_resolver, config_value_t* config);
 
 /**
- * construct_tcp_publisher_prod function constructs the publisher message bus config for prod mode
+ * add_keys_to_config function adds the keys of a subscriber to its message bus config for prod mode
  * @param sub_topic : sub_topic config_t object where the entire message bus config is held
  * @param app_name : Application name
- * @param kv_store_client : kv store client object
- * @param handle : kv store's handle
+ * @param key_resolver : resolver the keys are read with
  * @param publisher_appname: PublisherAppName value
  * @param sub_config : subscriber's interface config
  * @return true on sucess, false on fail
  */
-bool add_keys_to_config(config_t* sub_topic, char* app_name, kv_store_client_t* kv_store_client, void* handle, config_value_t* publisher_appname, config_value_t* sub_config);
+bool add_keys_to_config(config_t* sub_topic, char* app_name, cfgmgr_key_resolver_t* key_resolver, config_value_t* publisher_appname, config_value_t* sub_config);
 
 #ifdef __cplusplus
 }
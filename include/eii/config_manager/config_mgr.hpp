@@ -29,6 +29,7 @@
 
 #include <string.h>
 #include <iostream>
+#include <vector>
 #include <safe_lib.h>
 #include <eii/utils/logger.h>
 #include "eii/utils/json_config.h"
@@ -108,6 +109,22 @@ namespace eii {
                  */
                 bool isDevMode();
 
+                /**
+                 * Get the msgbus configs of every interface, built concurrently
+                 * with the keys shared between the interfaces fetched once
+                 * @return std::vector<cfgmgr_msgbus_config_t> - msgbus configs of the
+                 *         publishers, subscribers, servers and clients, each in index
+                 *         order. Every msgbus_config must be freed with config_destroy()
+                 */
+                std::vector<cfgmgr_msgbus_config_t> getAllMsgBusConfigs();
+
+                /**
+                 * Snapshot the PUBLISHER_, SUBSCRIBER_, SERVER_ and CLIENT_
+                 * env overrides again, msgbus configs only see the env vars
+                 * set before the last snapshot
+                 */
+                void refreshEnvOverrides();
+
                 /**
                  * Get the AppName for any service
                  * @return std::string - AppName string
@@ -28,7 +28,12 @@
 #define _EII_ETCD_CLIENT_H
 
 #include <iostream>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <stdlib.h>
 #include <unistd.h>
@@ -42,8 +47,10 @@
 
 #include <eii/config_manager/kv_store_plugin/etcd_client/protobuf/rpc.grpc.pb.h>
 #include <eii/config_manager/kv_store_plugin/etcd_client/protobuf/kv.pb.h>
+#include <eii/config_manager/kv_store_plugin/etcd_client/etcd_watch_manager.h>
+#include <eii/config_manager/kv_store_plugin/etcd_client/etcd_snapshot.h>
+#include <eii/config_manager/kv_store_plugin/etcd_client/etcd_retry.h>
 
-#define ADDRESS_LEN 30
 using grpc::Channel;
 using grpc::ClientContext;
 using grpc::Status;
@@ -56,6 +63,8 @@ using etcdserverpb::RangeRequest;
 using etcdserverpb::PutRequest;
 using etcdserverpb::RequestOp;
 using etcdserverpb::PutResponse;
+using etcdserverpb::TxnRequest;
+using etcdserverpb::TxnResponse;
 using etcdserverpb::WatchCreateRequest;
 using etcdserverpb::WatchRequest;
 using etcdserverpb::WatchResponse;
@@ -69,6 +78,12 @@ using etcdserverpb::WatchResponse;
  */
 typedef void (*kv_store_watch_callback_t)(const char *key, config_t* value, void* cb_user_data);
 
+/**
+ * Value read from etcd server, shares the ownership of the response it was
+ * read from instead of holding a copy
+ */
+typedef std::shared_ptr<const std::string> etcd_value_ref_t;
+
 class EtcdClient {
     public:
         /**
@@ -78,6 +93,14 @@ class EtcdClient {
         */
         EtcdClient(const std::string& host, const std::string& port);
 
+        /**
+        * EtcdClient Constructor to connect to several members of an etcd
+        * cluster in dev mode. Requests are spread round robin over the
+        * members, skipping the members that cannot be reached
+        * @param endpoints - host:port of each member
+        */
+        EtcdClient(const std::vector<std::string>& endpoints);
+
         /**
         * EtcdClient Constructor to connect to etcd server in prod mode
         * @param host      - host name to connect to etcd server
@@ -88,6 +111,17 @@ class EtcdClient {
         */
         EtcdClient(const std::string& host, const std::string& port, const std::string& cert_file, const std::string& key_file, const std::string ca_file);
 
+        /**
+        * EtcdClient Constructor to connect to several members of an etcd
+        * cluster in prod mode. The certificate of each member is verified
+        * against the host of its endpoint
+        * @param endpoints - host:port of each member
+        * @param cert_file - etcd_client certificate file
+        * @param key_file  - etcd_client private key file
+        * @param ca_file   - ca_certificate file
+        */
+        EtcdClient(const std::vector<std::string>& endpoints, const std::string& cert_file, const std::string& key_file, const std::string ca_file);
+
         /**
         * Destructor
         */
@@ -107,6 +141,121 @@ class EtcdClient {
         */
         std::vector<std::string> get_prefix(std::string& key_prefix);
 
+        /**
+        * Sends a get request to etcd server with the given read options
+        * @param key_prefix is the prefix of the key to be read
+        * @param opts are the read options
+        * @param result is filled with the values found, or with the keys
+        *        if opts.keys_only is set, without ETCD_PREFIX. Left empty if
+        *        opts.count_only is set
+        * @return number of keys under the prefix, regardless of opts.limit,
+        *         -1 on failure
+        */
+        int64_t get_prefix(std::string& key_prefix, const kv_store_read_options_t& opts,
+                           std::vector<std::string>& result);
+
+        /**
+        * Reads the keys under a prefix in pages of at most page_size keys,
+        * each page is requested from etcd server once the previous one was
+        * handled. Every page is read at the revision of the first one
+        * @param key_prefix is the prefix of the key to be read
+        * @param page_size is the maximum number of keys of a page, 0 for the
+        *        default
+        * @param cb is called with the keys, without ETCD_PREFIX, and the
+        *        values of every page. Returning a value other than 0 stops
+        *        the scan
+        * @return 0 once every key was passed to cb or cb stopped the scan,
+        *         -1 on failure
+        */
+        int scan_prefix(std::string& key_prefix, size_t page_size,
+                        std::function<int(const std::vector<std::string>& keys,
+                                          const std::vector<std::string>& values)> cb);
+
+        /**
+        * Sends a single Txn request to etcd server reading all the keys
+        * @param keys are the keys to be read
+        * @return vector with the value of each key in the order of keys,
+        *         string literal "(NULL)" for the keys not found. Empty
+        *         vector on failure
+        */
+        std::vector<std::string> get_many(std::vector<std::string>& keys);
+
+        /**
+        * Reads the keys like get_many() without copying their values, each
+        * value points into the response it was read from and keeps it alive
+        * @param keys are the keys to be read
+        * @param revision if not NULL, filled with the revision the keys were read at
+        * @return vector with the value of each key in the order of keys,
+        *         NULL for the keys not found. Empty vector on failure
+        */
+        std::vector<etcd_value_ref_t> get_view(std::vector<std::string>& keys,
+                                               int64_t* revision = NULL);
+
+        /**
+        * Fetches every key under the given prefixes with a single Txn request
+        * and keeps them in a local table. Later get(), get_many() and
+        * get_prefix() calls for keys under these prefixes are served from
+        * the table instead of etcd server. The table follows the put() calls
+        * of this client only, it must be dropped once the changes made by
+        * others have to be read
+        * @param prefixes are the key prefixes to be fetched, an empty vector
+        *        drops the local table
+        * @return 0 on success, -1 on failure
+        */
+        int prefetch(std::vector<std::string>& prefixes);
+
+        /**
+        * Sets the deadline and retry policy of the requests and the backoff
+        * of the watch stream reconnects, etcd_retry_policy_default() is
+        * used otherwise
+        * @param policy - retry policy
+        */
+        void set_retry_policy(const etcd_retry_policy_t& policy);
+
+        /**
+        * Runs the watch callbacks on a pool of threads, so that a slow
+        * callback does not stall the delivery of the other watches. The
+        * callbacks of a watch are still notified in order. Must be called
+        * before the first watch
+        * @param num_threads - number of threads, 0 to run the callbacks on
+        *                      the thread reading the watch stream
+        * @param queue_size  - maximum number of changes queued per thread,
+        *                      further changes replace the queued change of
+        *                      their key or drop the oldest change queued.
+        *                      The creation and cancellation of a watch and
+        *                      the batches are never dropped
+        */
+        void set_watch_dispatcher(size_t num_threads, size_t queue_size);
+
+        /**
+        * Returns the number of watch changes dropped or replaced because
+        * the dispatcher queue of their watch was full
+        */
+        uint64_t get_dropped_watch_events();
+
+        /**
+        * Sets the consistency of the reads, only get_prefix() with options
+        * may override it per call.
+        * Serializable reads are answered by the etcd member contacted
+        * without going through the leader, they may return stale data.
+        * Must be called before any read
+        * @param serializable - whether reads are serializable, reads are
+        *        linearizable by default
+        */
+        void set_serializable(bool serializable);
+
+        /**
+        * Persists the prefetched keys to a snapshot file after every
+        * successful prefetch(). If the file already holds a valid snapshot,
+        * its keys are served right away and prefetch() of the same prefixes
+        * returns without contacting etcd server, while the keys are fetched
+        * again in the background. Watches then resume from the revision of
+        * the snapshot once the keys are fetched, so the changes made since
+        * the snapshot are notified. Must be called before any watch
+        * @param path is the snapshot file
+        */
+        void set_snapshot_file(const std::string& path);
+
         /**
         * Saves the value of a key to etcd. The key will be modified if already exists or created
         * if it does not exist.
@@ -134,10 +283,115 @@ class EtcdClient {
         */
         void watch_prefix(std::string& key, kv_store_watch_callback_t user_cb, void *user_data);
 
+        /**
+        * Watches for changes of a prefix of a key like watch_prefix, the changes
+        * made within window_ms of the first one are notified in a single call
+        * of batch_cb with the latest value of every key changed
+        * @param key is the value or directory to be watched
+        * @param window_ms time a change waits for further ones, 0 to only
+        *                  coalesce the changes received together
+        * @param batch_cb callback to notify of every batch
+        * @param user_data user_data to be passed, it can be NULL also
+        */
+        void watch_prefix_batched(std::string& key, int window_ms,
+                                  kv_store_watch_batch_callback_t batch_cb, void *user_data);
+
+        /**
+        * Watches for every change of a key or of a prefix of a key, deletes
+        * included, and notifies event_cb with the type and revision of the
+        * change and optionally the previous value. event_cb is also notified
+        * whenever the watch is created or canceled
+        * @param key is the value or directory to be watched
+        * @param opts whether key is a prefix and previous values are needed
+        * @param event_cb callback to notify of every change
+        * @param user_data user_data to be passed, it can be NULL also
+        * @return 0 if the watch is registered, -1 on failure
+        */
+        int watch_events(std::string& key, const kv_store_watch_options_t& opts,
+                         kv_store_watch_event_callback_t event_cb, void *user_data);
+
     private:
-        char address[ADDRESS_LEN];
         grpc::SslCredentialsOptions ssl_opts;
-        std::unique_ptr<KV::Stub> kv_stub;
+
+        // One channel per etcd member, shared by its KV stub and every watch
+        // registered through this client, so that the TLS handshake happens
+        // only once per member
+        std::vector<std::shared_ptr<Channel> > channels;
+        std::vector<std::unique_ptr<KV::Stub> > kv_stubs;
+
+        // Member the next request is sent to, round robin
+        std::atomic<size_t> next_member;
+
+        // Multiplexes every watch of this client onto one Watch stream
+        std::unique_ptr<WatchManager> watch_manager;
+
+        // Creates a channel to each of the endpoints with creds, along with
+        // its KV stub, and the watch manager on them
+        void create_channel(const std::vector<std::string>& endpoints,
+                            std::shared_ptr<grpc::ChannelCredentials> creds);
+
+        // Returns the KV stub of the next member whose channel is not
+        // failing, or of the next member if all of them are
+        KV::Stub* next_kv_stub();
+
+        // Keys fetched by prefetch(), keyed on the full etcd key
+        std::mutex prefetch_mtx;
+        std::vector<std::string> prefetched_prefixes;
+        std::map<std::string, etcd_value_ref_t> prefetched;
+
+        // Revision the prefetched keys were read at
+        int64_t prefetched_revision;
+
+        // Whether reads are serializable, unless get_prefix() is given
+        // another consistency in its options
+        bool serializable;
+
+        // Retry policy and the retries left in its budget
+        std::mutex retry_mtx;
+        etcd_retry_policy_t retry_policy;
+        double retry_tokens;
+
+        // Runs rpc on the KV stub of a member with the deadline of the retry
+        // policy, or timeout_ms if not 0, retrying it on the next member as
+        // the policy allows. name is used for logging
+        Status call(const char* name, std::function<Status(KV::Stub*, ClientContext*)> rpc,
+                    int timeout_ms = 0);
+
+        // Whether a read of the given consistency is serializable
+        bool is_serializable(kv_store_consistency_t consistency);
+
+        // Whether key falls under a prefetched prefix, prefetch_mtx must be held
+        bool is_prefetched(const std::string& key);
+
+        // Fetches the keys under prefixes into table along with the revision
+        // they were read at, with a deadline of timeout_ms instead of the
+        // one of the retry policy if not 0. Returns 0 on success, -1 on failure
+        int fetch_prefixes(const std::vector<std::string>& prefixes, int timeout_ms,
+                           std::map<std::string, etcd_value_ref_t>& table, int64_t& revision);
+
+        // Snapshot the prefetched keys are persisted to, empty if disabled
+        std::string snapshot_file;
+
+        // Whether the prefetched keys were loaded from snapshot_file
+        bool snapshot_loaded;
+
+        // Revision new watches start from, the revision following the
+        // snapshot until its keys are fetched again, 0 for the current
+        // revision afterwards
+        std::atomic<int64_t> watch_start_revision;
+
+        // Fetches the prefixes of the snapshot again until etcd server
+        // answers, then saves the snapshot and opens the watch stream. The
+        // prefetched keys are replaced unless they were dropped meanwhile
+        std::thread reconcile_thread;
+        std::mutex reconcile_mtx;
+        std::condition_variable reconcile_cv;
+        bool reconcile_stopping;
+        void reconcile(std::vector<std::string> prefixes);
+
+        // Writes the keys of table read at revision to snapshot_file if set
+        void save_snapshot(const std::vector<std::string>& prefixes,
+                           const std::map<std::string, etcd_value_ref_t>& table, int64_t revision);
 };
 
 #endif // _EII_ETCD_CLIENT_H
@@ -25,6 +25,7 @@
 
 #include <eii/utils/logger.h>
 #include <eii/config_manager/kv_store_plugin/kv_store_plugin.h>
+#include <eii/config_manager/kv_store_plugin/etcd_client/etcd_retry.h>
 
 #define ETCD_KV_STORE   "etcd_kv_store"
 
@@ -34,9 +35,18 @@
 typedef struct {
     char *hostname;
     char *port;
+    // comma separated host:port of every member, empty for a single one
+    char *endpoints;
     char *cert_file;
     char *key_file;
     char *ca_file;
+    char *snapshot_file;
+    bool serializable;
+    etcd_retry_policy_t retry_policy;
+    // threads running the watch callbacks, 0 to run them on the watch
+    // stream thread, and the maximum number of changes queued per thread
+    int dispatcher_threads;
+    int dispatcher_queue_size;
 } etcd_config_t;
 
 /**
@@ -53,4 +63,4 @@ kv_store_client_t* create_etcd_client(config_t* config);
  * Free etcd_config_t and resources held by kv_store_client object
  @param kv_store_client - @c kv_store_client_t object
  */
-void etcd_values_destroy(kv_store_client_t* kv_store_client);
\ No newline at end of file
+void etcd_values_destroy(kv_store_client_t* kv_store_client);
\ No newline at end of file
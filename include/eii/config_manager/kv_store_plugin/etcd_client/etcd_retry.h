@@ -0,0 +1,81 @@
+// Copyright (c) 2020 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @file
+ * @brief Deadline and retry policy of the requests of an EtcdClient
+**/
+
+#ifndef _EII_ETCD_RETRY_H
+#define _EII_ETCD_RETRY_H
+
+// Defaults of the retry policy
+#define ETCD_DEFAULT_TIMEOUT_MS         5000
+#define ETCD_DEFAULT_MAX_ATTEMPTS       3
+#define ETCD_DEFAULT_INITIAL_BACKOFF_MS 100
+#define ETCD_DEFAULT_MAX_BACKOFF_MS     5000
+#define ETCD_DEFAULT_RETRY_BUDGET       10
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Deadline and retry policy of the requests to etcd server
+ */
+typedef struct {
+    // deadline of a single attempt of a request, 0 for no deadline
+    int timeout_ms;
+
+    // maximum number of attempts of a request, 1 disables retries
+    int max_attempts;
+
+    // delay before the first retry, doubled after every retry up to
+    // max_backoff_ms. The same delays apply to reopening a watch stream
+    int initial_backoff_ms;
+    int max_backoff_ms;
+
+    // number of retries a client may make in a row. Every retry consumes
+    // one from the budget and every successful request refills a tenth,
+    // so that a failing etcd server is not flooded with retries
+    int retry_budget;
+} etcd_retry_policy_t;
+
+/**
+ * Fills policy with the default retry policy
+ * @param policy - policy to fill
+ */
+void etcd_retry_policy_default(etcd_retry_policy_t* policy);
+
+/**
+ * Returns the delay before a retry, growing exponentially with the number
+ * of the retry and randomized between half and all of it, so that clients
+ * failing together do not retry together
+ * @param policy - retry policy
+ * @param retry  - number of the retry, starting from 0
+ * @return delay in milliseconds
+ */
+int etcd_retry_backoff_ms(const etcd_retry_policy_t* policy, int retry);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _EII_ETCD_RETRY_H
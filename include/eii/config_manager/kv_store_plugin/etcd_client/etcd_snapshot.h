@@ -0,0 +1,83 @@
+// Copyright (c) 2020 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @file
+ * @brief On-disk snapshot of the keys prefetched by an EtcdClient
+**/
+
+#ifndef _EII_ETCD_SNAPSHOT_H
+#define _EII_ETCD_SNAPSHOT_H
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Snapshot layout, in host byte order since a snapshot is only read back
+ * on the node that wrote it:
+ *
+ *   magic[8] "EIISNAP1" | version u32 | crc32 of payload u32 |
+ *   payload length u64 | revision i64 | number of prefixes u32 |
+ *   number of keys u32 | payload
+ *
+ * The payload holds every prefix as (length u32, bytes), followed by every
+ * key as (key length u32, value length u32, key bytes, value bytes)
+ */
+#define ETCD_SNAPSHOT_MAGIC         "EIISNAP1"
+#define ETCD_SNAPSHOT_MAGIC_LEN     8
+#define ETCD_SNAPSHOT_VERSION       1
+#define ETCD_SNAPSHOT_HEADER_LEN    40
+
+/**
+ * Keys of an EtcdClient saved to or loaded from a snapshot
+ */
+typedef struct {
+    // etcd revision the keys were read at
+    int64_t revision;
+
+    // Prefixes the keys were fetched with, ETCD_PREFIX included
+    std::vector<std::string> prefixes;
+
+    // Keys and their values, keys include ETCD_PREFIX
+    std::map<std::string, std::string> kvs;
+} etcd_snapshot_t;
+
+/**
+ * Writes the snapshot to path. The snapshot is written to a temporary file
+ * which is synced and renamed over path, a crash leaves either the old or
+ * the new snapshot in place. The file is only readable by its owner since
+ * it holds private keys
+ * @param path     - snapshot file
+ * @param snapshot - keys to be written
+ * @return true on success, false otherwise
+ */
+bool etcd_snapshot_save(const std::string& path, const etcd_snapshot_t& snapshot);
+
+/**
+ * Memory maps the snapshot at path and reads it after verifying its checksum
+ * @param path     - snapshot file
+ * @param snapshot - filled with the keys of the snapshot
+ * @return true on success, false if the snapshot is missing or corrupted
+ */
+bool etcd_snapshot_load(const std::string& path, etcd_snapshot_t& snapshot);
+
+#endif // _EII_ETCD_SNAPSHOT_H
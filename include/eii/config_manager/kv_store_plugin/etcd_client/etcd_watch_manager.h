@@ -0,0 +1,475 @@
+// Copyright (c) 2020 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @file
+ * @brief Watch manager multiplexing all the watches of an EtcdClient
+ * onto a single etcd Watch stream
+**/
+
+#ifndef _EII_ETCD_WATCH_MANAGER_H
+#define _EII_ETCD_WATCH_MANAGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <grpcpp/grpcpp.h>
+#include <grpcpp/alarm.h>
+
+#include <eii/config_manager/kv_store_plugin/kv_store_plugin.h>
+#include <eii/config_manager/kv_store_plugin/etcd_client/etcd_retry.h>
+#include <eii/config_manager/kv_store_plugin/etcd_client/protobuf/rpc.grpc.pb.h>
+#include <eii/config_manager/kv_store_plugin/etcd_client/protobuf/kv.pb.h>
+
+/**
+ * A single watch registered with the WatchManager
+ */
+typedef struct {
+    // Create request sent (and re-sent on reconnect) for this watch
+    etcdserverpb::WatchCreateRequest create_req;
+
+    // User callback and user data to notify on changes
+    kv_store_watch_callback_t user_callback;
+    void* user_data;
+
+    // User callback notified of every event, deletes included, and of the
+    // creation and cancellation of the watch. NULL if only the puts are
+    // notified to user_callback or batch_callback
+    kv_store_watch_event_callback_t event_callback;
+
+    // Whether the values are handed as configs parsed on first access
+    // instead of cJSON configs
+    bool lazy_value;
+
+    // User callback notified of the changes in batches, NULL if every
+    // change is notified to user_callback as it arrives
+    kv_store_watch_batch_callback_t batch_callback;
+
+    // Time a change waits in the batch for further ones, 0 to deliver the
+    // batch once the changes of a response are processed
+    int window_ms;
+
+    // Latest value of every key changed since the last batch was delivered,
+    // and when to deliver it. Only accessed from the poller thread
+    std::map<std::string, std::string> batch;
+    std::chrono::steady_clock::time_point batch_deadline;
+
+    // Highest revision delivered to the subscriber, the watch resumes from
+    // the next revision whenever the stream is reopened. Only accessed from
+    // the poller thread of the stream once the watch is registered
+    int64_t revision;
+
+    // Keys whose latest event delivered to event_callback is a put, the
+    // ones missing from the range after a compaction are notified as
+    // deleted. Empty without event_callback, only accessed from the poller
+    // thread of the stream
+    std::set<std::string> keys;
+
+    // Rank of the watch among the watches of its WatchManager, every
+    // callback of the watch runs on the dispatcher thread of this slot
+    uint64_t dispatch_slot;
+} watch_subscription_t;
+
+class WatchManager;
+
+/**
+ * Operations posted on the completion queue for a Watch stream
+ */
+typedef enum {
+    WATCH_OP_START,
+    WATCH_OP_READ,
+    WATCH_OP_WRITE,
+    WATCH_OP_FINISH,
+    WATCH_OP_RETRY,
+    WATCH_OP_BATCH,
+    WATCH_OP_RESYNC,
+} watch_op_t;
+
+/**
+ * Tag identifying a completed operation of a WatchManager
+ */
+typedef struct {
+    WatchManager* mgr;
+    watch_op_t op;
+} watch_tag_t;
+
+/**
+ * Range read of a watched range whose resume revision was compacted
+ */
+typedef struct {
+    // Tag of the read, several resyncs may be outstanding at a time
+    watch_tag_t tag;
+    std::shared_ptr<watch_subscription_t> sub;
+
+    // Stream the subscription was canceled on, the watch is only created
+    // again on that stream
+    uint64_t stream_id;
+
+    grpc::ClientContext context;
+    etcdserverpb::RangeResponse reply;
+    grpc::Status status;
+    std::unique_ptr<grpc::ClientAsyncResponseReader<etcdserverpb::RangeResponse> > reader;
+} resync_call_t;
+
+/**
+ * Fixed pool of threads draining the completion queues of every
+ * WatchManager in the process. The pool is created with the first
+ * WatchManager and shut down when the last one is destroyed
+ */
+class WatchPollerPool {
+    public:
+        /**
+        * Returns the process wide pool, starting it if needed
+        */
+        static std::shared_ptr<WatchPollerPool> acquire();
+
+        /**
+        * Destructor, shuts down the completion queues and joins the pollers
+        */
+        ~WatchPollerPool();
+
+        /**
+        * Returns the completion queue to be used by a new Watch stream,
+        * streams are spread round robin over the pollers
+        */
+        grpc::CompletionQueue* next_cq();
+
+    private:
+        WatchPollerPool(int num_pollers);
+        static void poll(grpc::CompletionQueue* cq);
+
+        std::vector<std::unique_ptr<grpc::CompletionQueue> > cqs;
+        std::vector<std::thread> pollers;
+        std::mutex mtx;
+        size_t next;
+};
+
+/**
+ * Fixed pool of threads running the user callbacks of a WatchManager, so
+ * that a slow callback does not stall the Watch stream. The callbacks of a
+ * watch run in order on the same thread, different watches run in parallel
+ */
+class WatchDispatcher {
+    public:
+        /**
+        * WatchDispatcher Constructor
+        * @param num_threads - number of threads running the callbacks
+        * @param queue_size  - maximum number of callbacks queued per thread
+        */
+        WatchDispatcher(size_t num_threads, size_t queue_size);
+
+        /**
+        * Destructor, waits for the callbacks running to return and drops the
+        * ones still queued
+        */
+        ~WatchDispatcher();
+
+        /**
+        * Queues task on the thread of slot. When the queue of the thread is
+        * full, a coalescable task replaces the latest coalescable task of
+        * the same slot and key still queued, or else the oldest coalescable
+        * task queued is dropped. Tasks that are not coalescable are never
+        * dropped, the queue growing past its size for them
+        * @param slot     - dispatch slot of the watch notified by task, the
+        *                   tasks of a slot run in order
+        * @param key      - key whose change task notifies
+        * @param task     - callback invocation
+        * @param coalesce - whether task only notifies the latest value of
+        *                   key, so that a later change of key may replace it
+        */
+        void dispatch(uint64_t slot, const std::string& key,
+                      const std::function<void()>& task, bool coalesce);
+
+        /**
+        * Returns the number of tasks dropped or replaced because their
+        * queue was full
+        */
+        uint64_t get_dropped();
+
+    private:
+        typedef struct {
+            uint64_t slot;
+            std::string key;
+            std::function<void()> task;
+            bool coalesce;
+        } dispatcher_task_t;
+
+        typedef struct {
+            std::thread thread;
+            std::mutex mtx;
+            std::condition_variable cv;
+            std::deque<dispatcher_task_t> queue;
+            bool stopping;
+        } dispatcher_worker_t;
+
+        static void run(dispatcher_worker_t* worker);
+
+        std::vector<std::unique_ptr<dispatcher_worker_t> > workers;
+        size_t queue_size;
+        std::atomic<uint64_t> dropped;
+};
+
+class WatchManager {
+    public:
+        /**
+        * WatchManager Constructor
+        * @param channels - channel to each etcd member, the Watch stream is
+        *        opened on one of them and moves to the next one once broken
+        */
+        WatchManager(const std::vector<std::shared_ptr<grpc::Channel> >& channels);
+
+        /**
+        * Destructor, cancels the Watch stream and blocks until every
+        * operation outstanding on it has completed. No callback is
+        * invoked once the destructor returns
+        */
+        ~WatchManager();
+
+        /**
+        * Registers a watch on the shared Watch stream. The stream is
+        * started on the first call
+        * @param create_req    - WatchCreateRequest describing the key/range
+        * @param user_callback - callback to notify on every change
+        * @param user_data     - user data passed to the callback, can be NULL
+        */
+        void add_watch(const etcdserverpb::WatchCreateRequest& create_req,
+                       kv_store_watch_callback_t user_callback, void* user_data);
+
+        /**
+        * Registers a watch whose changes are coalesced: the changes made
+        * within window_ms of the first one are delivered in one call to
+        * batch_callback, with the latest value of every key changed
+        * @param create_req     - WatchCreateRequest describing the key/range
+        * @param window_ms      - time a change waits for further ones, 0 to
+        *                         only coalesce the changes of one response
+        * @param batch_callback - callback to notify of every batch
+        * @param user_data      - user data passed to the callback, can be NULL
+        */
+        void add_batched_watch(const etcdserverpb::WatchCreateRequest& create_req, int window_ms,
+                               kv_store_watch_batch_callback_t batch_callback, void* user_data);
+
+        /**
+        * Registers a watch notified of every event, puts and deletes, with
+        * the previous value if requested in create_req
+        * @param create_req     - WatchCreateRequest describing the key/range
+        * @param event_callback - callback to notify of every event
+        * @param user_data      - user data passed to the callback, can be NULL
+        * @param lazy_value     - whether the values are parsed on first access,
+        *                         see kv_store_lazy_config_new()
+        */
+        void add_event_watch(const etcdserverpb::WatchCreateRequest& create_req,
+                             kv_store_watch_event_callback_t event_callback, void* user_data,
+                             bool lazy_value);
+
+        /**
+        * Defers opening the Watch stream, watches added meanwhile are only
+        * registered on release(). Must be called before the first watch
+        */
+        void hold();
+
+        /**
+        * Opens the Watch stream deferred by hold()
+        */
+        void release();
+
+        /**
+        * Sets the backoff between two attempts to reopen the Watch stream
+        * @param policy - retry policy
+        */
+        void set_retry_policy(const etcd_retry_policy_t& policy);
+
+        /**
+        * Runs the callbacks on a WatchDispatcher instead of the poller
+        * thread of the stream. Must be called before the first watch
+        * @param num_threads - number of dispatcher threads, 0 to run the
+        *                      callbacks on the poller thread
+        * @param queue_size  - maximum number of changes queued per thread,
+        *                      further changes replace the queued change of
+        *                      their key or drop the oldest one
+        */
+        void set_dispatcher(size_t num_threads, size_t queue_size);
+
+        /**
+        * Returns the number of changes dropped or replaced because the
+        * dispatcher queue of their key was full
+        */
+        uint64_t get_dropped_events();
+
+        /**
+        * Handles a completed operation, called from the poller threads
+        * @param tag - tag of the operation that completed
+        * @param ok  - whether the operation succeeded
+        */
+        void handle_event(watch_tag_t* tag, bool ok);
+
+    private:
+        // Stubs of each etcd member, the stream and the resyncs use the
+        // ones of member
+        std::vector<std::unique_ptr<etcdserverpb::Watch::Stub> > watch_stubs;
+        std::vector<std::unique_ptr<etcdserverpb::KV::Stub> > kv_stubs;
+        size_t member;
+        std::shared_ptr<WatchPollerPool> pool;
+        grpc::CompletionQueue* cq;
+
+        // One tag per operation kind, at most one of each is outstanding
+        watch_tag_t start_tag;
+        watch_tag_t read_tag;
+        watch_tag_t write_tag;
+        watch_tag_t finish_tag;
+        watch_tag_t retry_tag;
+        watch_tag_t batch_tag;
+
+        // Guards every member below
+        std::mutex mtx;
+        std::condition_variable cv;
+        bool running;
+        bool held;
+
+        std::unique_ptr<grpc::ClientContext> context;
+        std::unique_ptr<grpc::ClientAsyncReaderWriter<etcdserverpb::WatchRequest,
+                                                      etcdserverpb::WatchResponse> > stream;
+        etcdserverpb::WatchResponse reply;
+        // Batch being delivered to the subscribers, swapped with reply on
+        // every read. Only accessed from the poller thread of the stream
+        etcdserverpb::WatchResponse delivered;
+        grpc::Status finish_status;
+        grpc::Alarm retry_alarm;
+        etcd_retry_policy_t retry_policy;
+
+        // Runs the callbacks, NULL to run them on the poller thread. Set
+        // before the first watch and only reset by the destructor
+        std::unique_ptr<WatchDispatcher> dispatcher;
+
+        // Attempts to reopen the stream since a watch was last created
+        int reconnects;
+
+        // Fires at the deadline of the earliest batch waiting for delivery
+        grpc::Alarm batch_alarm;
+        bool batch_in_flight;
+        std::chrono::steady_clock::time_point batch_alarm_deadline;
+
+        // State of the current stream
+        bool stream_broken;
+        bool start_in_flight;
+        bool read_in_flight;
+        bool write_in_flight;
+        bool finish_in_flight;
+        bool retry_in_flight;
+
+        // Incremented whenever a stream is opened
+        uint64_t stream_id;
+
+        // Outstanding resync reads keyed on their tag
+        std::map<watch_tag_t*, std::unique_ptr<resync_call_t> > resyncs;
+
+        // Requests waiting for the outstanding write to complete, the
+        // front element is the one being written
+        std::deque<etcdserverpb::WatchRequest> write_queue;
+
+        // All registered watches, re-created whenever the stream is reopened
+        std::vector<std::shared_ptr<watch_subscription_t> > subscriptions;
+
+        // Create requests written to the stream awaiting their created
+        // response. etcd acknowledges creates in the order they are sent,
+        // which is how a response's watch_id is matched to its subscription
+        std::deque<std::shared_ptr<watch_subscription_t> > pending;
+
+        // Active watches keyed on the watch_id assigned by etcd
+        std::map<int64_t, std::shared_ptr<watch_subscription_t> > watchers;
+
+        // Adds sub to the subscriptions and registers it on the stream
+        void register_watch(std::shared_ptr<watch_subscription_t> sub);
+
+        // Routes a single WatchResponse to its subscriber, mtx not held
+        void process_response(const etcdserverpb::WatchResponse& reply);
+
+        // Runs task on the dispatcher thread of sub, or inline without one.
+        // coalesce is set for the tasks notifying a single change of key
+        void dispatch(watch_subscription_t* sub, const std::string& key,
+                      const std::function<void()>& task, bool coalesce = true);
+
+        // Notifies the event callback of sub, if any, that its watch was
+        // created or canceled, mtx not held
+        void notify_state_change(std::shared_ptr<watch_subscription_t> sub,
+                                 kv_store_event_type_t type, int64_t revision);
+
+        // Notifies sub of an event, or adds the change to the batch of sub
+        void deliver(watch_subscription_t* sub, const mvccpb::Event& event);
+
+        // Hands the batch of sub over to its callback and clears it
+        void dispatch_batch(watch_subscription_t* sub);
+
+        // Delivers the batches whose deadline has passed, called from
+        // handle_event() when batch_alarm fires, mtx not held
+        void deliver_batches();
+
+        // Delivers the batch of sub if its window is 0 or else schedules
+        // its delivery, called once the changes of a response are delivered
+        void end_batch(std::shared_ptr<watch_subscription_t> sub);
+
+        // Recovers a watch whose resume revision was compacted: reads its
+        // range asynchronously, see complete_resync()
+        void resync(std::shared_ptr<watch_subscription_t> sub);
+
+        // Delivers the keys of the range read by call modified since the
+        // last delivered revision, the keys delivered and since deleted,
+        // and registers the watch again from the revision read, mtx not held
+        void complete_resync(resync_call_t* call);
+
+        // Below helpers must be called with mtx held
+
+        // Opens a new stream and queues the create request of every watch
+        void start_stream();
+
+        // Queues the create request of sub on the current stream
+        void send_create_request(std::shared_ptr<watch_subscription_t> sub);
+
+        // Starts writing the front of write_queue if no write is outstanding
+        void flush_writes();
+
+        // Marks the stream as broken and finishes it once idle
+        void break_stream();
+
+        // Releases a finished stream and schedules the reconnect
+        void reap_stream();
+
+        // Sets batch_alarm for deadline unless it fires earlier already
+        void schedule_batch(std::chrono::steady_clock::time_point deadline);
+
+        // Sets batch_alarm for the earliest batch pending, if any
+        void schedule_next_batch();
+
+        // Whether neither a stream nor its reconnect is outstanding
+        bool is_idle();
+
+        // Whether no operation at all is outstanding on the completion queue
+        bool is_drained();
+};
+
+#endif // _EII_ETCD_WATCH_MANAGER_H
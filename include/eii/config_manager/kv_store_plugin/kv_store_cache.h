@@ -0,0 +1,93 @@
+// Copyright (c) 2021 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @file
+ * @brief Read cache in front of a kv_store_client_t
+ */
+
+#ifndef EII_KV_STORE_CACHE_H
+#define EII_KV_STORE_CACHE_H
+
+#include <stdint.h>
+#include <eii/config_manager/kv_store_plugin/kv_store_plugin.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Counters of a kv store cache
+ */
+typedef struct {
+    // Reads served from the cache
+    uint64_t hits;
+
+    // Reads forwarded to the kv store
+    uint64_t misses;
+
+    // Entries dropped on a change notified by the watch, or on its loss
+    uint64_t invalidations;
+
+    // Reads forwarded to the kv store because the watch of their prefix
+    // was not created
+    uint64_t bypasses;
+
+    // Entries currently held
+    size_t entries;
+} kv_store_cache_stats_t;
+
+/**
+ * Wraps a kv_store_client_t with a read cache. Values read with get and
+ * get_many for keys under one of prefixes are kept in memory and dropped
+ * whenever the watch registered on init for their prefix notifies a put
+ * or a delete of the key.
+ * The keys of a prefix are only cached once its watch is created. They are
+ * dropped and read from the kv store again whenever the watch is canceled
+ * or its connection is lost, until it is created again.
+ * Every other call is forwarded to the wrapped client.
+ *
+ * The returned client takes ownership of kv_store_client, it is freed with
+ * kv_client_free() on the returned client. kv_store_client must not be
+ * initialized yet, the init of the returned client initializes it.
+ *
+ * @param kv_store_client - client to be wrapped
+ * @param prefixes        - key prefixes to be cached, copied
+ * @param num_prefixes    - number of prefixes
+ * @return kv_store_client_t, or NULL on failure in which case the caller
+ *         keeps the ownership of kv_store_client
+ */
+kv_store_client_t* kv_store_cache_new(kv_store_client_t* kv_store_client,
+                                      char** prefixes, size_t num_prefixes);
+
+/**
+ * Reads the counters of a cache created with kv_store_cache_new()
+ * @param kv_store_client - client returned by kv_store_cache_new()
+ * @param stats           - counters to be filled
+ * @return 0 on success, -1 on failure
+ */
+int kv_store_cache_get_stats(kv_store_client_t* kv_store_client,
+                             kv_store_cache_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
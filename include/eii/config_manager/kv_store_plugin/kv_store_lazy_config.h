@@ -0,0 +1,74 @@
+// Copyright (c) 2020 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @file
+ * @brief config_t over a raw kv store value, parsed on first access
+ */
+
+#ifndef EII_KV_STORE_LAZY_CONFIG_H
+#define EII_KV_STORE_LAZY_CONFIG_H
+
+#include <stddef.h>
+#include <eii/utils/config.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Creates a config_t over the value of a key without parsing it, as handed
+ * by the watches registered with the lazy_value option. Its cfg is not a
+ * cJSON object, the value is only parsed on the first get_config_value or
+ * set_config_value call. A value not in JSON format reads as an object with
+ * the key as its only member, a value which fails to parse reads as a config
+ * with no member.
+ *
+ * @param key   - key of the value
+ * @param value - value of the key, copied
+ * @param len   - length of value
+ * @return config_t on success, NULL on failure
+ */
+config_t* kv_store_lazy_config_new(const char* key, const char* value, size_t len);
+
+/**
+ * Returns the raw value of a config_t created with kv_store_lazy_config_new()
+ * without parsing it
+ *
+ * @param config - configuration
+ * @param len    - filled with the length of the value, can be NULL
+ * @return NUL terminated value owned by config, NULL if config is not lazy
+ */
+const char* kv_store_lazy_config_raw(const config_t* config, size_t* len);
+
+/**
+ * Returns the parsed JSON of a configuration, parsing it first if config
+ * was created with kv_store_lazy_config_new()
+ *
+ * @param config - JSON or lazy configuration
+ * @return cJSON object owned by config, NULL if the value fails to parse
+ */
+void* kv_store_lazy_config_json(const config_t* config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // EII_KV_STORE_LAZY_CONFIG_H
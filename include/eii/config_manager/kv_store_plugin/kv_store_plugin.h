@@ -46,6 +46,149 @@ extern "C" {
  */
 typedef void (*kv_store_watch_callback_t)(const char *key, config_t* value, void *cb_user_data);
 
+/**
+ * Format for the user callback notified of the changes of a watch in batches,
+ * with the latest value of every key changed since the previous batch
+ * @param keys          keys changed, valid only during the call
+ * @param values        updated values, every config_t is owned by the callee
+ * @param num           number of keys changed
+ * @param cb_user_data  user data passed
+ */
+typedef void (*kv_store_watch_batch_callback_t)(const char **keys, config_t **values,
+                                                size_t num, void *cb_user_data);
+
+/**
+ * Kind of change notified by a watch event
+ */
+typedef enum {
+        KV_STORE_EVENT_PUT = 0,
+        KV_STORE_EVENT_DELETE = 1,
+
+        // the watch is registered with the kv store, notified again whenever
+        // it is registered anew
+        KV_STORE_EVENT_CREATED = 2,
+
+        // the watch is refused or canceled by the kv store, or its connection
+        // is lost. Changes may be missed until the next KV_STORE_EVENT_CREATED
+        KV_STORE_EVENT_CANCELED = 3,
+} kv_store_event_type_t;
+
+/**
+ * Change of a key notified to a kv_store_watch_event_callback_t
+ */
+typedef struct {
+        kv_store_event_type_t type;
+
+        // key changed, or the watched key for KV_STORE_EVENT_CREATED and
+        // KV_STORE_EVENT_CANCELED. Valid only during the call
+        const char *key;
+
+        // new value, NULL unless type is KV_STORE_EVENT_PUT. Owned by the callee
+        config_t *value;
+
+        // value before the change, NULL unless requested with prev_value and
+        // the key existed. Also NULL for a KV_STORE_EVENT_DELETE recovered
+        // after the kv store compacted the changes the watch missed, the
+        // deleted value being gone. Owned by the callee
+        config_t *prev_value;
+
+        // revision of the change
+        int64_t mod_revision;
+} kv_store_watch_event_t;
+
+/**
+ * Format for the user callback notified of every change of a watched key,
+ * including deletes
+ * @param event         change of the key
+ * @param cb_user_data  user data passed
+ */
+typedef void (*kv_store_watch_event_callback_t)(const kv_store_watch_event_t *event,
+                                                void *cb_user_data);
+
+/**
+ * Options of watch_events, zero initialize to watch a single key without
+ * previous values
+ */
+typedef struct {
+        // watch every key starting with the key instead of the key alone
+        bool prefix;
+
+        // fill prev_value of the events with the value before the change
+        bool prev_value;
+
+        // revision to notify the changes from, 0 to only notify the changes
+        // made once the watch is registered
+        int64_t start_revision;
+
+        // hand value and prev_value as configs parsed on first access, see
+        // kv_store_lazy_config_new(). Their cfg is then not a cJSON object,
+        // they must be read through get_config_value or kv_store_lazy_config_json
+        bool lazy_value;
+} kv_store_watch_options_t;
+
+/**
+ * Format for the user callback receiving the pages of a scan_prefix call
+ * @param keys          keys of the page, in lexical order
+ * @param values        values of the keys
+ * @param num           number of keys of the page
+ * @param cb_user_data  user data passed
+ * @return 0 to continue the scan, any other value to stop it
+ */
+typedef int (*kv_store_scan_callback_t)(const char **keys, const char **values,
+                                        size_t num, void *cb_user_data);
+
+
+/**
+ * Value read from kv_store without being copied, it stays valid until it is
+ * released with the release_view function of the kv_store_client
+ */
+typedef struct {
+        // NUL terminated value, NULL if the key was not found
+        const char *data;
+
+        // length of data
+        size_t len;
+
+        // reference held on the storage of data
+        void *ref;
+
+        // revision of the kv store the value was read at, 0 if unknown
+        int64_t revision;
+} kv_store_value_view_t;
+
+/**
+ * Consistency of a read from kv_store, only given per call to
+ * get_prefix_with_options. Every other read, prefetch included, uses the
+ * consistency configured for the kv_store_client
+ */
+typedef enum {
+        // consistency configured for the kv_store_client
+        KV_STORE_CONSISTENCY_DEFAULT = 0,
+
+        // read through the quorum of the kv_store, never stale
+        KV_STORE_CONSISTENCY_LINEARIZABLE,
+
+        // read served by the member of the kv_store contacted without
+        // consensus, faster but may return stale data
+        KV_STORE_CONSISTENCY_SERIALIZABLE,
+} kv_store_consistency_t;
+
+/**
+ * Options of a get_prefix_with_options read
+ */
+typedef struct {
+        // return the keys instead of their values
+        bool keys_only;
+
+        // return only the number of keys under the prefix
+        bool count_only;
+
+        // maximum number of keys returned, 0 for no limit
+        int64_t limit;
+
+        // consistency of the read
+        kv_store_consistency_t consistency;
+} kv_store_read_options_t;
 
 /*
  * Representation of kv_store_client object
@@ -67,6 +210,44 @@ typedef struct {
         // a prefixed key from kv_store_client
         char* (*get_prefix) (void* handle, char *key);
 
+        // function pointer to assign to read a prefixed key like get_prefix
+        // with the given options. Returns an array of the values, or of the
+        // keys if opts->keys_only is set, NULL if no key was found or on
+        // failure. If opts->count_only is set, returns an integer holding
+        // the number of keys instead. The result must be destroyed with
+        // config_value_destroy by the caller
+        config_value_t* (*get_prefix_with_options) (void* handle, char *key,
+                                                     const kv_store_read_options_t *opts);
+
+        // function pointer to assign to read a prefixed key in pages of at
+        // most page_size keys, 0 for the default, passed to cb in lexical
+        // order. Only one page is held in memory at a time, the keys and
+        // values are valid until cb returns. Returns 0 once every key was
+        // passed or cb stopped the scan, -1 on failure
+        int (*scan_prefix) (void* handle, char *key, size_t page_size,
+                            kv_store_scan_callback_t cb, void* user_data);
+
+        // function pointer to assign to get the values of several keys from
+        // kv_store in a single request. Returns an array of num_keys values in
+        // the order of keys, NULL for the keys not found, or NULL on failure.
+        // The values and the array must be freed by the caller
+        char** (*get_many) (void* handle, char **keys, size_t num_keys);
+
+        // function pointer to assign to fetch every key under the prefixes
+        // into a local table, later get, get_many and get_prefix calls for
+        // those keys are served from it. num_prefixes 0 drops the table.
+        // Returns 0 on success, -1 on failure
+        int (*prefetch) (void* handle, char **prefixes, size_t num_prefixes);
+
+        // function pointer to assign to read the values of several keys like
+        // get_many without copying them. views must hold num_keys entries,
+        // filled in the order of keys. Every view must be released with
+        // release_view. Returns 0 on success, -1 on failure
+        int (*get_view) (void* handle, char **keys, size_t num_keys, kv_store_value_view_t *views);
+
+        // function pointer to assign to release a view filled by get_view
+        void (*release_view) (void* handle, kv_store_value_view_t *view);
+
         // function poiner to assign to store value of a particular key into kv_store
         int (*put) (void* handle, char *key, char *value);
 
@@ -78,6 +259,24 @@ typedef struct {
         // notify user if any change on key occured
         void (*watch_prefix) (void* handle, char *key, kv_store_watch_callback_t cb, void* user_data);
 
+        // function pointer to watch for any changes of a key prefix like watch_prefix,
+        // the changes made within window_ms of the first one are coalesced and
+        // notified in a single call of cb. window_ms 0 only coalesces the changes
+        // received together
+        void (*watch_prefix_batched) (void* handle, char *key, int window_ms,
+                                      kv_store_watch_batch_callback_t cb, void* user_data);
+
+        // function pointer to watch for any change of a key, or of a key prefix, including
+        // deletes. cb receives the event type, revision and optionally the previous value,
+        // along with the creation and the cancellation of the watch. Returns 0 if the
+        // watch is registered, -1 on failure in which case cb is never called
+        int (*watch_events) (void* handle, char *key, const kv_store_watch_options_t *opts,
+                             kv_store_watch_event_callback_t cb, void* user_data);
+
+        // function pointer to get the number of watch changes dropped, or replaced by
+        // a later change of their key, because the callbacks could not keep up
+        uint64_t (*get_dropped_watch_events) (void* handle);
+
         // function pointer to delete respective kv_store
         void (*deinit)(void* handle);
 } kv_store_client_t;
@@ -27,6 +27,26 @@
 #include <stdint.h>
 #include <cjson/cJSON.h>
 #include "eii/config_manager/cfgmgr.h"
+#include "eii/config_manager/kv_store_plugin/kv_store_cache.h"
+#include "eii/config_manager/kv_store_plugin/kv_store_lazy_config.h"
+
+// Whether the env var is set to true, case insensitive
+static bool is_env_true(const char* name) {
+    char env_var[MAX_MODE_LENGTH] = "";
+    int result = 1;
+    char* env_value = getenv(name);
+    if (env_value == NULL) {
+        return false;
+    }
+    int ind_env = strncpy_s(env_var, MAX_MODE_LENGTH, env_value, MAX_MODE_LENGTH - 1);
+    if (ind_env != 0) {
+        LOG_ERROR("failed to copy %s env value", name);
+        return false;
+    }
+    to_lower(env_var);
+    strcmp_s(env_var, strlen(env_var), "true", &result);
+    return result == 0;
+}
 
 // function to generate kv_store_config from env
 config_t* create_kv_store_config() {
@@ -43,6 +63,8 @@ config_t* create_kv_store_config() {
     config_value_t* cert_file = NULL;
     config_value_t* key_file = NULL;
     config_value_t* ca_file = NULL;
+    config_value_t* snapshot_file = NULL;
+    config_value_t* consistency = NULL;
     config_value_t* etcd_kv_store_cvt = NULL;
 
     // Creating final config object
@@ -276,6 +298,40 @@ config_t* create_kv_store_config() {
         }
     }
 
+    // Keeping a snapshot of the app keys to start from when
+    // CONFIGMGR_SNAPSHOT is set to the snapshot file
+    char* snapshot_env = getenv("CONFIGMGR_SNAPSHOT");
+    if (snapshot_env != NULL && strlen(snapshot_env) != 0) {
+        LOG_DEBUG("Snapshot file: %s", snapshot_env);
+        snapshot_file = config_value_new_string(snapshot_env);
+        if (snapshot_file == NULL) {
+            LOG_ERROR_0("Error creating config_value_t object");
+            goto err;
+        }
+        config_set_result = config_set(etcd_kv_store, "snapshot_file", snapshot_file);
+        if (!config_set_result) {
+            LOG_ERROR("Unable to set config value");
+            goto err;
+        }
+    }
+
+    // Reading with the consistency CONFIGMGR_CONSISTENCY is set to,
+    // serializable reads are served without a round trip to the leader
+    char* consistency_env = getenv("CONFIGMGR_CONSISTENCY");
+    if (consistency_env != NULL && strlen(consistency_env) != 0) {
+        LOG_DEBUG("Read consistency: %s", consistency_env);
+        consistency = config_value_new_string(consistency_env);
+        if (consistency == NULL) {
+            LOG_ERROR_0("Error creating config_value_t object");
+            goto err;
+        }
+        config_set_result = config_set(etcd_kv_store, "consistency", consistency);
+        if (!config_set_result) {
+            LOG_ERROR("Unable to set config value");
+            goto err;
+        }
+    }
+
     etcd_kv_store_cvt = config_value_new_object(etcd_kv_store->cfg, get_config_value, NULL);
     if (etcd_kv_store_cvt == NULL) {
         LOG_ERROR_0("Error creating config_value_t object");
@@ -308,6 +364,12 @@ config_t* create_kv_store_config() {
     if (ca_file != NULL) {
         config_value_destroy(ca_file);
     }
+    if (snapshot_file != NULL) {
+        config_value_destroy(snapshot_file);
+    }
+    if (consistency != NULL) {
+        config_value_destroy(consistency);
+    }
     if (etcd_kv_store_cvt != NULL) {
         config_value_destroy(etcd_kv_store_cvt);
     }
@@ -340,12 +402,525 @@ err:
     if (ca_file != NULL) {
         config_value_destroy(ca_file);
     }
+    if (snapshot_file != NULL) {
+        config_value_destroy(snapshot_file);
+    }
+    if (consistency != NULL) {
+        config_value_destroy(consistency);
+    }
     if (etcd_kv_store_cvt != NULL) {
         config_value_destroy(etcd_kv_store_cvt);
     }
     return NULL;
 }
 
+// Prefix of the env overrides of each interface type, in cfgmgr_iface_type_t order
+static const char* iface_env_prefixes[] = {"PUBLISHER_", "SUBSCRIBER_", "SERVER_", "CLIENT_"};
+
+// Msgbus config shared by every config_t handed out for a memo. The cfg
+// of those configs is json, a copy of the root of the built document
+// sharing its members, so that config_destroy() reaches the wrapper
+// from cfg. The configs are released by config_destroy(), which may run
+// after cfgmgr_destroy()
+typedef struct msgbus_shared {
+    // Must stay the first member
+    cJSON json;
+
+    // Built document, json points to its members
+    cJSON* built;
+
+    // Number of references held, updated atomically
+    int refs;
+} msgbus_shared_t;
+
+// Memoized msgbus config of an interface
+typedef struct msgbus_memo {
+    // Interface the config was built from
+    const cJSON* interface;
+    cfgmgr_iface_type_t type;
+
+    // Revisions of the interfaces, keys and env overrides the config
+    // was built with
+    uint64_t iface_revision;
+    int64_t kv_revision;
+    uint64_t env_revision;
+
+    // Config handed out, the memo holding one reference
+    msgbus_shared_t* shared;
+
+    struct msgbus_memo* next;
+} msgbus_memo_t;
+
+struct cfgmgr_msgbus_cache {
+    // Latest revision of the keys read by the msgbus config builders
+    int64_t kv_revision;
+
+    msgbus_memo_t* memos;
+};
+
+// Drops a reference to a shared msgbus config, used as the free_fn of
+// the configs handed out
+static void msgbus_shared_release(void* json) {
+    msgbus_shared_t* shared = (msgbus_shared_t*) json;
+    if (__atomic_sub_fetch(&shared->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        cJSON_Delete(shared->built);
+        free(shared);
+    }
+}
+
+// Shared msgbus configs are immutable
+static bool msgbus_shared_set(void* json, const char* key, config_value_t* value) {
+    LOG_ERROR("Memoized msgbus config is immutable, failed to set %s", key);
+    return false;
+}
+
+// Shares the msgbus config json, its first reference being the caller's
+static msgbus_shared_t* msgbus_shared_new(cJSON* json) {
+    msgbus_shared_t* shared = (msgbus_shared_t*) malloc(sizeof(msgbus_shared_t));
+    if (shared == NULL) {
+        LOG_ERROR_0("Malloc failed for the shared msgbus config");
+        return NULL;
+    }
+    shared->json = *json;
+    shared->built = json;
+    shared->refs = 1;
+    return shared;
+}
+
+// Hands out a new reference to a shared msgbus config
+static config_t* msgbus_shared_config(msgbus_shared_t* shared) {
+    __atomic_add_fetch(&shared->refs, 1, __ATOMIC_RELAXED);
+    config_t* config = config_new(
+            (void*) &shared->json, msgbus_shared_release, get_config_value, msgbus_shared_set);
+    if (config == NULL) {
+        LOG_ERROR_0("Failed to initialize configuration object");
+        msgbus_shared_release(&shared->json);
+    }
+    return config;
+}
+
+static void msgbus_memo_free(msgbus_memo_t* memo) {
+    if (memo->shared != NULL) {
+        msgbus_shared_release(&memo->shared->json);
+    }
+    free(memo);
+}
+
+// Frees a list of memos
+static void msgbus_memos_free(msgbus_memo_t* memos) {
+    while (memos != NULL) {
+        msgbus_memo_t* next = memos->next;
+        msgbus_memo_free(memos);
+        memos = next;
+    }
+}
+
+// Interface arrays of the interfaces document, in cfgmgr_iface_type_t order
+static const char* iface_type_keys[] = {PUBLISHERS, SUBSCRIBERS, SERVERS, CLIENTS};
+
+#define NUM_IFACE_TYPES (sizeof(iface_type_keys) / sizeof(iface_type_keys[0]))
+
+// Slot of an open addressing name to interface table
+typedef struct {
+    const char* name;
+    cJSON* interface;
+} iface_slot_t;
+
+// Index of an interfaces document by interface type and name. It is
+// never modified once built, a change of the interfaces replaces it.
+// References are held by the cfgmgr_ctx_t until it is destroyed, by
+// every cfgmgr_interface_t pointing into its document and by the readers
+// of the interfaces while they read. The last one released frees it
+struct cfgmgr_iface_index {
+    // Interfaces document, owned by the index
+    config_t* app_interface;
+
+    // Name to interface tables, their capacity being a power of two
+    iface_slot_t* slots[NUM_IFACE_TYPES];
+    size_t capacity[NUM_IFACE_TYPES];
+
+    // Number of references held, updated atomically
+    int refcount;
+
+    // Index replaced before this one, both kept by the cfgmgr_ctx_t
+    struct cfgmgr_iface_index* replaced_next;
+};
+
+#define FNV_OFFSET_BASIS 14695981039346656037ULL
+
+// Continues the FNV-1a hash of a string up to its end or to terminator
+static uint64_t fnv1a_update(uint64_t hash, const char* str, char terminator) {
+    for (const char* c = str; *c != '\0' && *c != terminator; c++) {
+        hash ^= (unsigned char) *c;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// FNV-1a hash of an interface name
+static size_t iface_hash(const char* name) {
+    return (size_t) fnv1a_update(FNV_OFFSET_BASIS, name, '\0');
+}
+
+// Frees an index and its document
+static void iface_index_free(struct cfgmgr_iface_index* index) {
+    for (size_t i = 0; i < NUM_IFACE_TYPES; i++) {
+        free(index->slots[i]);
+    }
+    if (index->app_interface != NULL) {
+        config_destroy(index->app_interface);
+    }
+    free(index);
+}
+
+// Takes one more reference on an index already referenced by the caller
+static struct cfgmgr_iface_index* iface_index_ref(struct cfgmgr_iface_index* index) {
+    __atomic_add_fetch(&index->refcount, 1, __ATOMIC_RELAXED);
+    return index;
+}
+
+// Releases a reference on an index, freeing it with the last one
+static void iface_index_release(struct cfgmgr_iface_index* index) {
+    if (index != NULL && __atomic_sub_fetch(&index->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        iface_index_free(index);
+    }
+}
+
+// Indexes every named interface of app_interface, which is owned by the
+// index on success
+static struct cfgmgr_iface_index* iface_index_new(config_t* app_interface) {
+    const cJSON* json = (const cJSON*) kv_store_lazy_config_json(app_interface);
+    if (json == NULL || !cJSON_IsObject(json)) {
+        LOG_ERROR_0("Interfaces are not a JSON object");
+        return NULL;
+    }
+    struct cfgmgr_iface_index* index = (struct cfgmgr_iface_index*) calloc(1, sizeof(struct cfgmgr_iface_index));
+    if (index == NULL) {
+        LOG_ERROR_0("Calloc failed for the interface index");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < NUM_IFACE_TYPES; i++) {
+        cJSON* interfaces = cJSON_GetObjectItem(json, iface_type_keys[i]);
+        if (!cJSON_IsArray(interfaces) || cJSON_GetArraySize(interfaces) == 0) {
+            continue;
+        }
+        // Keeping the load factor at or below one half
+        size_t capacity = 2;
+        while (capacity < 2 * (size_t) cJSON_GetArraySize(interfaces)) {
+            capacity <<= 1;
+        }
+        index->slots[i] = (iface_slot_t*) calloc(capacity, sizeof(iface_slot_t));
+        if (index->slots[i] == NULL) {
+            LOG_ERROR_0("Calloc failed for the interface index");
+            goto err;
+        }
+        index->capacity[i] = capacity;
+
+        cJSON* interface = NULL;
+        cJSON_ArrayForEach(interface, interfaces) {
+            cJSON* name = cJSON_GetObjectItem(interface, NAME);
+            if (!cJSON_IsString(name)) {
+                LOG_WARN("Skipping a %s interface without a Name", iface_type_keys[i]);
+                continue;
+            }
+            size_t pos = iface_hash(name->valuestring) & (capacity - 1);
+            while (index->slots[i][pos].name != NULL &&
+                    strcmp(index->slots[i][pos].name, name->valuestring) != 0) {
+                pos = (pos + 1) & (capacity - 1);
+            }
+            // The first interface of a name is the one looked up
+            if (index->slots[i][pos].name == NULL) {
+                index->slots[i][pos].name = name->valuestring;
+                index->slots[i][pos].interface = interface;
+            }
+        }
+    }
+    index->app_interface = app_interface;
+    index->refcount = 1;
+    return index;
+
+err:
+    iface_index_free(index);
+    return NULL;
+}
+
+// Looks up the interface of a type by name, NULL if it does not exist
+static cJSON* iface_index_find(const struct cfgmgr_iface_index* index, cfgmgr_iface_type_t type, const char* name) {
+    size_t capacity = index->capacity[type];
+    if (capacity == 0) {
+        return NULL;
+    }
+    const iface_slot_t* slots = index->slots[type];
+    size_t pos = iface_hash(name) & (capacity - 1);
+    while (slots[pos].name != NULL) {
+        if (strcmp(slots[pos].name, name) == 0) {
+            return slots[pos].interface;
+        }
+        pos = (pos + 1) & (capacity - 1);
+    }
+    return NULL;
+}
+
+extern char** environ;
+
+// Env overrides of the msgbus configs, the vars of the environment named
+// after one of iface_env_prefixes. It is never modified once built, a
+// refresh replaces it. References are held by the cfgmgr_ctx_t while the
+// table is current and by the msgbus config builders reading it, the last
+// one released frees it
+struct cfgmgr_env_overrides {
+    // Open addressing table of "NAME=value" copies, its capacity being
+    // a power of two
+    char** entries;
+    size_t capacity;
+
+    // Bumped by every refresh
+    uint64_t revision;
+
+    // Number of references held, updated atomically
+    int refcount;
+};
+
+// Frees a table of env overrides
+static void env_overrides_free(struct cfgmgr_env_overrides* overrides) {
+    for (size_t i = 0; i < overrides->capacity; i++) {
+        free(overrides->entries[i]);
+    }
+    free(overrides->entries);
+    free(overrides);
+}
+
+// Releases a reference on a table of env overrides, freeing it with the
+// last one
+static void env_overrides_release(struct cfgmgr_env_overrides* overrides) {
+    if (overrides != NULL && __atomic_sub_fetch(&overrides->refcount, 1, __ATOMIC_ACQ_REL) == 0) {
+        env_overrides_free(overrides);
+    }
+}
+
+// Whether the env var is an override of one of the interface types
+static bool env_is_override(const char* var) {
+    for (size_t i = 0; i < NUM_IFACE_TYPES; i++) {
+        if (strncmp(var, iface_env_prefixes[i], strlen(iface_env_prefixes[i])) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Snapshots the env overrides of the environment
+static struct cfgmgr_env_overrides* env_overrides_new(uint64_t revision) {
+    struct cfgmgr_env_overrides* overrides = (struct cfgmgr_env_overrides*) calloc(1, sizeof(struct cfgmgr_env_overrides));
+    if (overrides == NULL) {
+        LOG_ERROR_0("Calloc failed for the env overrides");
+        return NULL;
+    }
+    overrides->revision = revision;
+    overrides->refcount = 1;
+
+    size_t num_overrides = 0;
+    for (char** var = environ; *var != NULL; var++) {
+        if (env_is_override(*var)) {
+            num_overrides++;
+        }
+    }
+    // Keeping the load factor at or below one half
+    overrides->capacity = 2;
+    while (overrides->capacity < 2 * num_overrides) {
+        overrides->capacity <<= 1;
+    }
+    overrides->entries = (char**) calloc(overrides->capacity, sizeof(char*));
+    if (overrides->entries == NULL) {
+        LOG_ERROR_0("Calloc failed for the env overrides");
+        free(overrides);
+        return NULL;
+    }
+
+    for (char** var = environ; *var != NULL; var++) {
+        if (!env_is_override(*var) || strchr(*var, '=') == NULL) {
+            continue;
+        }
+        size_t len = strlen(*var) + 1;
+        char* entry = (char*) malloc(len);
+        if (entry == NULL) {
+            LOG_ERROR_0("Malloc failed for the env override");
+            env_overrides_free(overrides);
+            return NULL;
+        }
+        if (strcpy_s(entry, len, *var) != 0) {
+            LOG_ERROR_0("Failed to copy the env override");
+            free(entry);
+            env_overrides_free(overrides);
+            return NULL;
+        }
+        size_t pos = (size_t) fnv1a_update(FNV_OFFSET_BASIS, entry, '=') & (overrides->capacity - 1);
+        while (overrides->entries[pos] != NULL) {
+            pos = (pos + 1) & (overrides->capacity - 1);
+        }
+        overrides->entries[pos] = entry;
+    }
+    return overrides;
+}
+
+// Value of the env override named prefix + name + suffix, name and suffix
+// being optional, NULL if it is not set. Nothing is allocated
+static char* env_override_get(const struct cfgmgr_env_overrides* overrides,
+                              const char* prefix, const char* name, const char* suffix) {
+    const char* parts[] = {prefix, name, suffix};
+    const size_t num_parts = sizeof(parts) / sizeof(parts[0]);
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < num_parts; i++) {
+        if (parts[i] != NULL) {
+            hash = fnv1a_update(hash, parts[i], '\0');
+        }
+    }
+
+    size_t pos = (size_t) hash & (overrides->capacity - 1);
+    while (overrides->entries[pos] != NULL) {
+        // Matching "NAME=value" against the parts of the name
+        char* c = overrides->entries[pos];
+        for (size_t i = 0; i < num_parts && c != NULL; i++) {
+            for (const char* p = parts[i]; p != NULL && *p != '\0'; p++, c++) {
+                if (*c != *p) {
+                    c = NULL;
+                    break;
+                }
+            }
+        }
+        if (c != NULL && *c == '=') {
+            return c + 1;
+        }
+        pos = (pos + 1) & (overrides->capacity - 1);
+    }
+    return NULL;
+}
+
+// Current env overrides of cfgmgr, with a reference taken on them which
+// must be released with env_overrides_release()
+static struct cfgmgr_env_overrides* env_overrides_acquire(cfgmgr_ctx_t* cfgmgr) {
+    pthread_mutex_lock(&cfgmgr->iface_mtx);
+    struct cfgmgr_env_overrides* overrides = cfgmgr->env_overrides;
+    __atomic_add_fetch(&overrides->refcount, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&cfgmgr->iface_mtx);
+    return overrides;
+}
+
+bool cfgmgr_get_key_stats(cfgmgr_ctx_t* cfgmgr, cfgmgr_key_stats_t* stats) {
+    LOG_DEBUG("In %s function", __func__);
+    if (cfgmgr->key_resolver == NULL) {
+        return false;
+    }
+    cfgmgr_key_resolver_get_stats(cfgmgr->key_resolver, stats);
+    return true;
+}
+
+bool cfgmgr_refresh_env_overrides(cfgmgr_ctx_t* cfgmgr) {
+    LOG_DEBUG("In %s function", __func__);
+    pthread_mutex_lock(&cfgmgr->iface_mtx);
+    struct cfgmgr_env_overrides* overrides = env_overrides_new(cfgmgr->env_overrides->revision + 1);
+    if (overrides == NULL) {
+        pthread_mutex_unlock(&cfgmgr->iface_mtx);
+        LOG_ERROR_0("Failed to refresh the env overrides");
+        return false;
+    }
+    struct cfgmgr_env_overrides* replaced = cfgmgr->env_overrides;
+    cfgmgr->env_overrides = overrides;
+    pthread_mutex_unlock(&cfgmgr->iface_mtx);
+    env_overrides_release(replaced);
+    return true;
+}
+
+// Current interfaces index of cfgmgr, with a reference taken on it which
+// must be released with iface_index_release()
+static struct cfgmgr_iface_index* iface_index_acquire(cfgmgr_ctx_t* cfgmgr) {
+    pthread_mutex_lock(&cfgmgr->iface_mtx);
+    struct cfgmgr_iface_index* index = iface_index_ref(cfgmgr->iface_index);
+    pthread_mutex_unlock(&cfgmgr->iface_mtx);
+    return index;
+}
+
+// Replaces the interfaces and their index when the interfaces of the
+// app are updated in the kv store
+static void iface_watch_callback(const char* key, config_t* value, void* user_data) {
+    cfgmgr_ctx_t* cfgmgr = (cfgmgr_ctx_t*) user_data;
+    if (value == NULL) {
+        return;
+    }
+    struct cfgmgr_iface_index* index = iface_index_new(value);
+    if (index == NULL) {
+        LOG_ERROR("Failed to index the interfaces updated at %s, keeping the previous ones", key);
+        config_destroy(value);
+        return;
+    }
+    // Memoized msgbus configs of the replaced interfaces are dropped, the
+    // replaced index is kept until destroy as its document may still be
+    // held by callers of cfgmgr_get_app_interface()
+    msgbus_memo_t* stale = NULL;
+    pthread_mutex_lock(&cfgmgr->iface_mtx);
+    struct cfgmgr_iface_index* replaced = cfgmgr->iface_index;
+    replaced->replaced_next = cfgmgr->replaced_iface_indexes;
+    cfgmgr->replaced_iface_indexes = replaced;
+    cfgmgr->iface_index = index;
+    cfgmgr->app_interface = index->app_interface;
+    cfgmgr->iface_revision++;
+    if (cfgmgr->msgbus_cache != NULL) {
+        stale = cfgmgr->msgbus_cache->memos;
+        cfgmgr->msgbus_cache->memos = NULL;
+    }
+    pthread_mutex_unlock(&cfgmgr->iface_mtx);
+    msgbus_memos_free(stale);
+    LOG_DEBUG("Interfaces updated at %s reindexed", key);
+}
+
+// Replaces the app config read from the snapshot with the one read from
+// the kv store once its watch is created, i.e. once the snapshot keys are
+// fetched again. Only done once, the replaced config is kept until
+// cfgmgr_destroy() as callers may still hold it
+static void app_config_reconcile_callback(const kv_store_watch_event_t* event, void* user_data) {
+    cfgmgr_ctx_t* cfgmgr = (cfgmgr_ctx_t*) user_data;
+    if (event->value != NULL) {
+        config_destroy(event->value);
+    }
+    if (event->prev_value != NULL) {
+        config_destroy(event->prev_value);
+    }
+    if (event->type != KV_STORE_EVENT_CREATED || cfgmgr->snapshot_app_config != NULL) {
+        return;
+    }
+    // The watched key carries the kv store prefix, get() prepends it again
+    size_t init_len = strlen("/") + strlen(cfgmgr->app_name) + strlen("/config") + 1;
+    char* config_char = concat_s(init_len, 3, "/", cfgmgr->app_name, "/config");
+    if (config_char == NULL) {
+        LOG_WARN_0("Concatenation of the app config key failed, keeping the app config of the snapshot");
+        return;
+    }
+    char* value = cfgmgr->kv_store_client->get(cfgmgr->kv_store_handle, config_char);
+    if (value == NULL) {
+        LOG_WARN("Failed to read %s again, keeping the app config of the snapshot", config_char);
+        free(config_char);
+        return;
+    }
+    config_t* app_config = json_config_new_from_buffer(value);
+    free(value);
+    if (app_config == NULL) {
+        LOG_WARN("Failed to parse %s, keeping the app config of the snapshot", config_char);
+        free(config_char);
+        return;
+    }
+    free(config_char);
+    pthread_mutex_lock(&cfgmgr->iface_mtx);
+    if (cJSON_Compare((cJSON*) cfgmgr->app_config->cfg, (cJSON*) app_config->cfg, true)) {
+        pthread_mutex_unlock(&cfgmgr->iface_mtx);
+        config_destroy(app_config);
+        return;
+    }
+    cfgmgr->snapshot_app_config = cfgmgr->app_config;
+    cfgmgr->app_config = app_config;
+    pthread_mutex_unlock(&cfgmgr->iface_mtx);
+    LOG_INFO("App config of the snapshot replaced by %s", event->key);
+}
+
 cfgmgr_interface_t* cfgmgr_interface_initialize() {
     LOG_DEBUG("In %s function", __func__);
     cfgmgr_interface_t *cfgmgr_ctx = (cfgmgr_interface_t *)malloc(sizeof(cfgmgr_interface_t));
@@ -353,88 +928,41 @@ cfgmgr_interface_t* cfgmgr_interface_initialize() {
         LOG_ERROR_0("Malloc failed for cfgmgr_ctx_t");
         return NULL;
     }
+    cfgmgr_ctx->interface = NULL;
+    cfgmgr_ctx->iface_index = NULL;
     return cfgmgr_ctx;
 }
 
 cfgmgr_interface_t* cfgmgr_get_interface_by_name(cfgmgr_ctx_t* cfgmgr, const char* name, cfgmgr_iface_type_t type) {
     LOG_DEBUG("In %s function", __func__);
-    char* interface_type = NULL;
-    if (type == CFGMGR_PUBLISHER) {
-        interface_type = PUBLISHERS;
-    } else if (type == CFGMGR_SUBSCRIBER) {
-        interface_type = SUBSCRIBERS;
-    } else if (type == CFGMGR_SERVER) {
-        interface_type = SERVERS;
-    } else if (type == CFGMGR_CLIENT) {
-        interface_type = CLIENTS;
-    } else {
+    if (type < CFGMGR_PUBLISHER || type > CFGMGR_CLIENT) {
         LOG_ERROR_0("Interface type not supported");
         return NULL;
     }
-    int result = 0;
-    cfgmgr_interface_t* ctx = NULL;
-    config_value_t* config_name = NULL;
-    config_value_t* interface = NULL;
-
-    config_t* app_interface = cfgmgr->app_interface;
-    ctx = cfgmgr_interface_initialize();
+    cfgmgr_interface_t* ctx = cfgmgr_interface_initialize();
     if (ctx == NULL) {
         LOG_ERROR_0("cfgmgr initialization failed");
-        goto err;
+        return NULL;
     }
 
-    // Fetching list of Publisher interfaces
-    interface = app_interface->get_config_value(app_interface->cfg, interface_type);
+    // The interface points into the document of the index, the reference
+    // held by ctx keeps it alive
+    ctx->iface_index = iface_index_acquire(cfgmgr);
+    cJSON* interface = iface_index_find(ctx->iface_index, type, name);
     if (interface == NULL) {
-        LOG_ERROR_0("interface initialization failed");
-        goto err;
-    }
-
-    size_t arr_len = config_value_array_len(interface);
-    if (arr_len == 0) {
-        LOG_ERROR_0("Empty array is not supported, atleast one value should be given.");
-        goto err;
-    }
-    // Iterating through available publisher configs
-    for (size_t i = 0; i < arr_len; i++) {
-        // Fetch name of individual publisher config
-        config_value_t* config = config_value_array_get(interface, i);
-        if (config == NULL) {
-            LOG_ERROR_0("config initialization failed");
-            goto err;
-        }
-        config_name = config_value_object_get(config, "Name");
-        if (config_name == NULL || config_name->body.string == NULL) {
-            LOG_ERROR_0("config_name initialization failed");
-            goto err;
-        }
-        // Verifying publisher config with name exists
-        strcmp_s(config_name->body.string, strlen(config_name->body.string), name, &result);
-        if(result == 0) {
-            ctx->cfg_mgr = cfgmgr;
-            ctx->interface = config;
-            ctx->type = type;
-            goto err;
-        } else if(i == config_value_array_len(interface)) {
-            LOG_ERROR("Publisher by name %s not found", name);
-            goto err;
-        } else {
-            if (config_name != NULL) {
-                config_value_destroy(config_name);
-            }
-            if (config != NULL) {
-                config_value_destroy(config);
-            }
-        }
+        LOG_ERROR("%s by name %s not found", iface_type_keys[type], name);
+        cfgmgr_interface_destroy(ctx);
+        return NULL;
     }
 
-err:
-    if (interface != NULL) {
-        config_value_destroy(interface);
-    }
-    if (config_name != NULL) {
-        config_value_destroy(config_name);
+    ctx->interface = config_value_new_object((void*) interface, get_config_value, NULL);
+    if (ctx->interface == NULL) {
+        LOG_ERROR_0("config initialization failed");
+        cfgmgr_interface_destroy(ctx);
+        return NULL;
     }
+    ctx->cfg_mgr = cfgmgr;
+    ctx->type = type;
     return ctx;
 }
 
@@ -455,13 +983,17 @@ cfgmgr_interface_t* cfgmgr_get_interface_by_index(cfgmgr_ctx_t* cfgmgr, int inde
     }
     config_value_t* config = NULL;
     config_value_t* interface = NULL;
-    config_t* app_interface = cfgmgr->app_interface;
+    config_t* app_interface = NULL;
     cfgmgr_interface_t* ctx = NULL;
     ctx = cfgmgr_interface_initialize();
     if (ctx == NULL) {
         LOG_ERROR_0("cfgmgr initialization failed");
         goto err;
     }
+    // The interface points into the document of the index, the reference
+    // held by ctx keeps it alive
+    ctx->iface_index = iface_index_acquire(cfgmgr);
+    app_interface = ctx->iface_index->app_interface;
 
     // Fetching list of Publisher interfaces
     interface = app_interface->get_config_value(app_interface->cfg, interface_type);
@@ -700,6 +1232,10 @@ bool cfgmgr_set_topics(cfgmgr_interface_t* ctx, char const* const* topics_list,
         LOG_ERROR_0("Unable to set config value");
         goto err;
     }
+    // Configs memoized from the interface are stale
+    pthread_mutex_lock(&ctx->cfg_mgr->iface_mtx);
+    ctx->cfg_mgr->iface_revision++;
+    pthread_mutex_unlock(&ctx->cfg_mgr->iface_mtx);
     if (config_arr_cvt != NULL) {
         config_value_destroy(config_arr_cvt);
     }
@@ -751,8 +1287,11 @@ config_value_t* cfgmgr_get_allowed_clients(cfgmgr_interface_t* ctx) {
     return clients;
 }
 
-config_t* cfgmgr_get_msgbus_config_pub(cfgmgr_interface_t* ctx) {
+// Builds the msgbus config of a publisher interface
+static config_t* msgbus_config_build_pub(cfgmgr_interface_t* ctx) {
     LOG_DEBUG("In %s function", __func__);
+    // Env overrides read by the builder, the values point into them
+    struct cfgmgr_env_overrides* overrides = NULL;
     config_t* m_config = NULL;
     config_value_t* broker_app_name = NULL;
     char** host_port = NULL;
@@ -762,8 +1301,7 @@ config_t* cfgmgr_get_msgbus_config_pub(cfgmgr_interface_t* ctx) {
     config_value_t* pub_config = ctx->interface;
     char* app_name = ctx->cfg_mgr->app_name;
     int dev_mode = ctx->cfg_mgr->dev_mode;
-    kv_store_client_t* kv_store_client = ctx->cfg_mgr->kv_store_client;
-    void* kv_store_handle = ctx->cfg_mgr->kv_store_handle;
+    cfgmgr_key_resolver_t* key_resolver = ctx->cfg_mgr->key_resolver;
     config_value_t* publish_config_type = NULL;
     config_value_t* publish_config_endpoint = NULL;
     config_value_t* publish_config_name = NULL;
@@ -834,14 +1372,9 @@ config_t* cfgmgr_get_msgbus_config_pub(cfgmgr_interface_t* ctx) {
     }
 
     // Overriding endpoint with PUBLISHER_<Name>_ENDPOINT if set
-    size_t init_len = strlen("PUBLISHER_") + strlen(publish_config_name->body.string) + strlen("_ENDPOINT") + 2;
-    char* ep_override_env = concat_s(init_len, 3, "PUBLISHER_", publish_config_name->body.string, "_ENDPOINT");
-    if (ep_override_env == NULL) {
-        LOG_ERROR_0("concatenation for ep_override_env failed");
-        goto err;
-    }
+    overrides = env_overrides_acquire(ctx->cfg_mgr);
     char publisher_ep[MAX_ENDPOINT_LENGTH] = "";
-    char* ep_override = getenv(ep_override_env);
+    char* ep_override = env_override_get(overrides, "PUBLISHER_", publish_config_name->body.string, "_ENDPOINT");
     if (ep_override != NULL) {
 
         int ret = strncpy_s(publisher_ep, MAX_ENDPOINT_LENGTH + 1,
@@ -852,17 +1385,16 @@ config_t* cfgmgr_get_msgbus_config_pub(cfgmgr_interface_t* ctx) {
         }
 
         if (strlen(publisher_ep) != 0) {
-            LOG_DEBUG("Overriding endpoint with %s", ep_override_env);
+            LOG_DEBUG("Overriding endpoint with PUBLISHER_%s_ENDPOINT", publish_config_name->body.string);
             end_point = publisher_ep;
         }
     } else {
-        LOG_DEBUG("env not set for overridding %s, and hence endpoint taking from interface ", ep_override_env);
+        LOG_DEBUG("env not set for overridding PUBLISHER_%s_ENDPOINT, and hence endpoint taking from interface ", publish_config_name->body.string);
     }
-    free(ep_override_env);
 
     // Overriding endpoint with PUBLISHER_ENDPOINT if set
     // Note: This overrides all the publisher endpoints if set
-    char* pub_ep_env  = getenv("PUBLISHER_ENDPOINT");
+    char* pub_ep_env  = env_override_get(overrides, "PUBLISHER_ENDPOINT", NULL, NULL);
     if (pub_ep_env != NULL) {
 
         int ret = strncpy_s(publisher_ep, MAX_ENDPOINT_LENGTH + 1,
@@ -881,26 +1413,19 @@ config_t* cfgmgr_get_msgbus_config_pub(cfgmgr_interface_t* ctx) {
     }
 
     // Overriding endpoint with PUBLISHER_<Name>_TYPE if set
-    init_len = strlen("PUBLISHER_") + strlen(publish_config_name->body.string) + strlen("_TYPE") + 2;
-    char* type_override_env = concat_s(init_len, 3, "PUBLISHER_", publish_config_name->body.string, "_TYPE");
-    if (type_override_env == NULL) {
-        LOG_ERROR_0("concatenation for type_override_env failed");
-        goto err;
-    }
-    char* type_override = getenv(type_override_env);
+    char* type_override = env_override_get(overrides, "PUBLISHER_", publish_config_name->body.string, "_TYPE");
     if (type_override != NULL) {
         if (strlen(type_override) != 0) {
-            LOG_DEBUG("Overriding endpoint with %s", type_override_env);
+            LOG_DEBUG("Overriding endpoint with PUBLISHER_%s_TYPE", publish_config_name->body.string);
             type = type_override;
         }
     } else {
-        LOG_DEBUG("env not set for overridding %s, and hence type taking from interface ", type_override_env);
+        LOG_DEBUG("env not set for overridding PUBLISHER_%s_TYPE, and hence type taking from interface ", publish_config_name->body.string);
     }
-    free(type_override_env);
 
     // Overriding endpoint with PUBLISHER_TYPE if set
     // Note: This overrides all the publisher type if set
-    char* publisher_type = getenv("PUBLISHER_TYPE");
+    char* publisher_type = env_override_get(overrides, "PUBLISHER_TYPE", NULL, NULL);
     if (publisher_type != NULL) {
         LOG_DEBUG_0("Overriding endpoint with PUBLISHER_TYPE");
         if (strlen(publisher_type) != 0) {
@@ -1012,13 +1537,13 @@ config_t* cfgmgr_get_msgbus_config_pub(cfgmgr_interface_t* ctx) {
                 // If a publisher is using broker to communicate with its respective subscriber
                 // then publisher will act as a subscriber to X-SUB, hence publishers
                 // message bus config looks like a subscriber one.
-                ret_val = add_keys_to_config(zmq_tcp_publish_cvt, app_name, kv_store_client, kv_store_handle, broker_app_name, pub_config);
+                ret_val = add_keys_to_config(zmq_tcp_publish_cvt, app_name, key_resolver, broker_app_name, pub_config);
                 if(!ret_val) {
                     LOG_ERROR_0("Failed to add respective cert keys");
                     goto err;
                 }
             } else{
-                ret_val = construct_tcp_publisher_prod(app_name, m_config, zmq_tcp_publish_cvt, kv_store_handle, pub_config, kv_store_client);
+                ret_val = construct_tcp_publisher_prod(app_name, m_config, zmq_tcp_publish_cvt, key_resolver, pub_config);
                 if(!ret_val) {
                     LOG_ERROR_0("Failed to construct tcp config struct");
                     goto err;
@@ -1119,6 +1644,7 @@ config_t* cfgmgr_get_msgbus_config_pub(cfgmgr_interface_t* ctx) {
     }
 
 err:
+    env_overrides_release(overrides);
     if (type_value != NULL) {
         config_value_destroy(type_value);
     }
@@ -1178,8 +1704,11 @@ err:
     return m_config;
 }
 
-config_t* cfgmgr_get_msgbus_config_sub(cfgmgr_interface_t* ctx) {
+// Builds the msgbus config of a subscriber interface
+static config_t* msgbus_config_build_sub(cfgmgr_interface_t* ctx) {
     LOG_DEBUG("In %s function", __func__);
+    // Env overrides read by the builder, the values point into them
+    struct cfgmgr_env_overrides* overrides = NULL;
     char** host_port = NULL;
     char* host = NULL;
     char* port = NULL;
@@ -1193,14 +1722,11 @@ config_t* cfgmgr_get_msgbus_config_sub(cfgmgr_interface_t* ctx) {
     char* config_value_cr = NULL;
     config_value_t* subscribe_config_name = NULL;
     config_value_t* subscribe_config_endpoint = NULL;
-    char* type_override_env = NULL;
     char* type_override = NULL;
     config_value_t* subscribe_config_type = NULL;
-    char* ep_override_env = NULL;
     char* ep_override = NULL;
     config_value_t* zmq_recv_hwm_value = NULL;
     config_t* topics = NULL;
-    kv_store_client_t* kv_store_client = NULL;
     config_t* c_json = NULL;
     config_value_t* type_cvt = NULL;
     config_value_t* zmq_tcp_host = NULL;
@@ -1215,8 +1741,7 @@ config_t* cfgmgr_get_msgbus_config_sub(cfgmgr_interface_t* ctx) {
         dev_mode = true;
     }
 
-    kv_store_client = ctx->cfg_mgr->kv_store_client;
-    void* kv_store_handle = ctx->cfg_mgr->kv_store_handle;
+    cfgmgr_key_resolver_t* key_resolver = ctx->cfg_mgr->key_resolver;
 
     // Creating final config object
     c_json = json_config_new_from_buffer("{}");
@@ -1265,15 +1790,9 @@ config_t* cfgmgr_get_msgbus_config_sub(cfgmgr_interface_t* ctx) {
     }
 
     // Overriding endpoint with SUBSCRIBER_<Name>_ENDPOINT if set
-    size_t init_len = strlen("SUBSCRIBER_") + strlen(subscribe_config_name->body.string) + strlen("_ENDPOINT") + 2;
-    ep_override_env = concat_s(init_len, 3, "SUBSCRIBER_", subscribe_config_name->body.string, "_ENDPOINT");
-    if (ep_override_env == NULL) {
-        LOG_ERROR_0("concatenation for ep_override_env failed");
-        goto err;
-    }
-
+    overrides = env_overrides_acquire(ctx->cfg_mgr);
     char subscriber_ep[MAX_ENDPOINT_LENGTH] = "";
-    ep_override = getenv(ep_override_env);
+    ep_override = env_override_get(overrides, "SUBSCRIBER_", subscribe_config_name->body.string, "_ENDPOINT");
     if (ep_override != NULL) {
 
         int ret = strncpy_s(subscriber_ep, MAX_ENDPOINT_LENGTH + 1,
@@ -1284,16 +1803,16 @@ config_t* cfgmgr_get_msgbus_config_sub(cfgmgr_interface_t* ctx) {
         }
 
         if (strlen(subscriber_ep) != 0) {
-            LOG_DEBUG("Overriding endpoint with %s", ep_override_env);
+            LOG_DEBUG("Overriding endpoint with SUBSCRIBER_%s_ENDPOINT", subscribe_config_name->body.string);
             end_point = subscriber_ep;
         }
     } else {
-        LOG_DEBUG("env not set for overridding %s, and hence endpoint taking from interface ", ep_override_env);
+        LOG_DEBUG("env not set for overridding SUBSCRIBER_%s_ENDPOINT, and hence endpoint taking from interface ", subscribe_config_name->body.string);
     }
 
     // Overriding endpoint with SUBSCRIBER_ENDPOINT if set
     // Note: This overrides all the subscriber type if set
-    char* sub_ep_env = getenv("SUBSCRIBER_ENDPOINT");
+    char* sub_ep_env = env_override_get(overrides, "SUBSCRIBER_ENDPOINT", NULL, NULL);
     if (sub_ep_env != NULL) {
         int ret = strncpy_s(subscriber_ep, MAX_ENDPOINT_LENGTH + 1,
                         sub_ep_env, MAX_ENDPOINT_LENGTH);
@@ -1311,25 +1830,19 @@ config_t* cfgmgr_get_msgbus_config_sub(cfgmgr_interface_t* ctx) {
     }
 
     // Overriding endpoint with SUBSCRIBER_<Name>_TYPE if set
-    init_len = strlen("SUBSCRIBER_") + strlen(subscribe_config_name->body.string) + strlen("_TYPE") + 2;
-    type_override_env = concat_s(init_len, 3, "SUBSCRIBER_", subscribe_config_name->body.string, "_TYPE");
-    if (type_override_env == NULL) {
-        LOG_ERROR_0("concatenation for type_override_env failed");
-        goto err;
-    }
-    type_override = getenv(type_override_env);
+    type_override = env_override_get(overrides, "SUBSCRIBER_", subscribe_config_name->body.string, "_TYPE");
     if (type_override != NULL) {
         if (strlen(type_override) != 0) {
-            LOG_DEBUG("Overriding endpoint with %s", type_override_env);
+            LOG_DEBUG("Overriding endpoint with SUBSCRIBER_%s_TYPE", subscribe_config_name->body.string);
             type = type_override;
         }
     } else {
-        LOG_DEBUG("env not set for overridding %s, and hence type taking from interface ", type_override_env);
+        LOG_DEBUG("env not set for overridding SUBSCRIBER_%s_TYPE, and hence type taking from interface ", subscribe_config_name->body.string);
     }
 
     // Overriding endpoint with SUBSCRIBER_TYPE if set
     // Note: This overrides all the subscriber endpoints if set
-    char* subscriber_type = getenv("SUBSCRIBER_TYPE");
+    char* subscriber_type = env_override_get(overrides, "SUBSCRIBER_TYPE", NULL, NULL);
     if (subscriber_type != NULL) {
         LOG_DEBUG_0("Overriding endpoint with SUBSCRIBER_TYPE");
         if (strlen(subscriber_type) != 0) {
@@ -1451,13 +1964,13 @@ config_t* cfgmgr_get_msgbus_config_sub(cfgmgr_interface_t* ctx) {
                 if(ret == 0) {
                     // In case of ZmqBroker, it is "X-SUB" which needs "publishers" way of
                     // messagebus config, hence calling "construct_tcp_publisher_prod()" function
-                    ret_val = construct_tcp_publisher_prod(app_name, c_json, topics, kv_store_handle, sub_config, kv_store_client);
+                    ret_val = construct_tcp_publisher_prod(app_name, c_json, topics, key_resolver, sub_config);
                      if(!ret_val) {
                         LOG_ERROR_0("Failed in construct_tcp_publisher_prod()");
                         goto err;
                     }
                 }else {
-                    ret_val = add_keys_to_config(topics, app_name, kv_store_client, kv_store_handle, publisher_appname, sub_config);
+                    ret_val = add_keys_to_config(topics, app_name, key_resolver, publisher_appname, sub_config);
                     if(!ret_val) {
                         LOG_ERROR_0("Failed in add_keys_to_config()");
                         goto err;
@@ -1555,6 +2068,7 @@ config_t* cfgmgr_get_msgbus_config_sub(cfgmgr_interface_t* ctx) {
     }
 
 err:
+    env_overrides_release(overrides);
     if (type_value != NULL) {
         config_value_destroy(type_value);
     }
@@ -1582,12 +2096,6 @@ err:
     if (subscribe_config_name != NULL) {
         config_value_destroy(subscribe_config_name);
     }
-    if (ep_override_env != NULL) {
-        free(ep_override_env);
-    }
-    if (type_override_env != NULL) {
-        free(type_override_env);
-    }
     if (zmq_recv_hwm_value != NULL) {
         config_value_destroy(zmq_recv_hwm_value);
     }
@@ -1612,35 +2120,28 @@ err:
 return c_json;
 }
 
-config_t* cfgmgr_get_msgbus_config_server(cfgmgr_interface_t* ctx) {
+// Builds the msgbus config of a server interface
+static config_t* msgbus_config_build_server(cfgmgr_interface_t* ctx) {
     LOG_DEBUG("In %s function", __func__);
+    // Env overrides read by the builder, the values point into them
+    struct cfgmgr_env_overrides* overrides = NULL;
     config_value_t* serv_config = ctx->interface;
     char* app_name = ctx->cfg_mgr->app_name;
     int dev_mode = ctx->cfg_mgr->dev_mode;
-    kv_store_client_t* kv_store_client = ctx->cfg_mgr->kv_store_client;
-    void* kv_store_handle = ctx->cfg_mgr->kv_store_handle;
-    config_value_t* temp_array_value = NULL;
+    cfgmgr_key_resolver_t* key_resolver = ctx->cfg_mgr->key_resolver;
     config_value_t* server_name = NULL;
     config_value_t* server_config_type = NULL;
-    char* ep_override_env = NULL;
     char** host_port = NULL;
-    char* type_override_env = NULL;
     config_value_t* server_json_clients = NULL;
-    config_value_t* pub_key_values = NULL;
     char* pub_pri_key = NULL;
-    char* server_secret_key = NULL;
+    cfgmgr_key_t* server_secret_key = NULL;
     config_value_t* server_endpoint = NULL;
-    char* grab_public_key = NULL;
-    char* client_public_key = NULL;
     char* config_value_cr = NULL;
-    char **all_clients = NULL;
     config_value_t* type_cvt = NULL;
     config_value_t* zmq_recv_hwm_value = NULL;
     config_t* server_topic = NULL;
     config_value_t* zmq_tcp_host = NULL;
     config_value_t* zmq_tcp_port = NULL;
-    config_t* all_clients_arr_config = NULL;
-    config_value_t* all_clients_cvt = NULL;
     config_value_t* server_secret_key_cvt = NULL;
     config_value_t* server_topic_cvt = NULL;
     config_value_t* type_value = NULL;
@@ -1686,15 +2187,9 @@ config_t* cfgmgr_get_msgbus_config_server(cfgmgr_interface_t* ctx) {
     char* end_point = server_endpoint->body.string;
 
     // // Overriding endpoint with SERVER_<Name>_ENDPOINT if set
-    size_t init_len = strlen("SERVER_") + strlen(server_name->body.string) + strlen("_ENDPOINT") + 2;
-    ep_override_env = concat_s(init_len, 3, "SERVER_", server_name->body.string, "_ENDPOINT");
-    if (ep_override_env == NULL) {
-        LOG_ERROR_0("concatenation for ep_override_env failed");
-        goto err;
-    }
-
+    overrides = env_overrides_acquire(ctx->cfg_mgr);
     char server_ep[MAX_ENDPOINT_LENGTH] = "";
-    char* ep_override = getenv(ep_override_env);
+    char* ep_override = env_override_get(overrides, "SERVER_", server_name->body.string, "_ENDPOINT");
     if (ep_override != NULL) {
 
         int ret = strncpy_s(server_ep, MAX_ENDPOINT_LENGTH + 1,
@@ -1705,7 +2200,7 @@ config_t* cfgmgr_get_msgbus_config_server(cfgmgr_interface_t* ctx) {
         }
 
         if (strlen(server_ep) != 0) {
-            LOG_DEBUG("Overriding endpoint with %s", ep_override_env);
+            LOG_DEBUG("Overriding endpoint with SERVER_%s_ENDPOINT", server_name->body.string);
             end_point = server_ep;
         }
     } else {
@@ -1714,7 +2209,7 @@ config_t* cfgmgr_get_msgbus_config_server(cfgmgr_interface_t* ctx) {
 
     // Overriding endpoint with SERVER_ENDPOINT if set
     // Note: This overrides all the server endpoints if set
-    char* server_ep_env = getenv("SERVER_ENDPOINT");
+    char* server_ep_env = env_override_get(overrides, "SERVER_ENDPOINT", NULL, NULL);
     if (server_ep_env != NULL) {
         int ret = strncpy_s(server_ep, MAX_ENDPOINT_LENGTH + 1,
                         server_ep_env, MAX_ENDPOINT_LENGTH);
@@ -1732,16 +2227,10 @@ config_t* cfgmgr_get_msgbus_config_server(cfgmgr_interface_t* ctx) {
     }
 
     // Overriding endpoint with SERVER_<Name>_TYPE if set
-    init_len = strlen("SERVER_") + strlen(server_name->body.string) + strlen("_TYPE") + 2;
-    type_override_env = concat_s(init_len, 3, "SERVER_", server_name->body.string, "_TYPE");
-    if (type_override_env == NULL) {
-        LOG_ERROR_0("concatenation for type_override_env failed");
-        goto err;
-    }
-    char* type_override = getenv(type_override_env);
+    char* type_override = env_override_get(overrides, "SERVER_", server_name->body.string, "_TYPE");
     if (type_override != NULL) {
         if (strlen(type_override) != 0) {
-            LOG_DEBUG("Overriding endpoint with %s", type_override_env);
+            LOG_DEBUG("Overriding endpoint with SERVER_%s_TYPE", server_name->body.string);
             type = type_override;
         }
     } else {
@@ -1750,7 +2239,7 @@ config_t* cfgmgr_get_msgbus_config_server(cfgmgr_interface_t* ctx) {
 
     // Overriding endpoint with SERVER_TYPE if set
     // Note: This overrides all the server type if set
-    char* server_type = getenv("SERVER_TYPE");
+    char* server_type = env_override_get(overrides, "SERVER_TYPE", NULL, NULL);
     if (server_type != NULL) {
         LOG_DEBUG_0("Overriding endpoint with SERVER_TYPE");
         if (strlen(server_type) != 0) {
@@ -1843,105 +2332,25 @@ config_t* cfgmgr_get_msgbus_config_server(cfgmgr_interface_t* ctx) {
                 goto err;
             }
 
-            // Checking if Allowed clients is empty string
-            if (config_value_array_len(server_json_clients) == 0) {
-                LOG_ERROR_0("Empty String is not supported in AllowedClients. Atleast one allowed clients is required");
+            if (!add_allowed_clients_keys(c_json, server_json_clients, key_resolver)) {
+                LOG_ERROR_0("Failed to add the public keys of AllowedClients");
                 goto err;
             }
 
-            // Fetch the first item in allowed_clients
-            temp_array_value = config_value_array_get(server_json_clients, 0);
-            if (temp_array_value == NULL || temp_array_value->body.string == NULL) {
-                LOG_ERROR_0("temp_array_value initialization failed");
+            // Fetching Publisher private key & adding it to server_topic object
+            size_t init_len = strlen("/") + strlen(PRIVATE_KEY) + strlen(app_name) + 2;
+            pub_pri_key = concat_s(init_len, 3, "/", app_name, PRIVATE_KEY);
+            if (pub_pri_key == NULL) {
+                LOG_ERROR_0("concatenation for pub_pri_key failed");
+                goto err;
+            }
+            server_secret_key = cfgmgr_key_resolve(key_resolver, pub_pri_key);
+            if (server_secret_key == NULL) {
+                LOG_ERROR("Value is not found for the key: %s", pub_pri_key);
                 goto err;
             }
-            int result;
-            strcmp_s(temp_array_value->body.string, strlen(temp_array_value->body.string), "*", &result);
-            // If only one item in allowed_clients and it is *
-            // Add all available Publickeys
-            if ((config_value_array_len(server_json_clients) == 1) && (result == 0)) {
-                pub_key_values = kv_store_client->get_prefix(kv_store_handle, "/Publickeys/");
-                if (pub_key_values == NULL) {
-                    LOG_ERROR_0("pub_key_values initialization failed");
-                    goto err;
-                }
-
-                config_set_result = config_set(c_json, "allowed_clients", pub_key_values);
-                if (!config_set_result) {
-                    LOG_ERROR_0("Unable to set config value");
-                    goto err;
-                }
-            } else {
-                config_value_t* array_value;
-                size_t arr_len = config_value_array_len(server_json_clients);
-                if(arr_len == 0){
-                    LOG_ERROR_0("Empty array is not supported, atleast one value should be given.");
-                    goto err;
-                }
-                all_clients = (char**)calloc(arr_len, sizeof(char*));
-                if (all_clients == NULL) {
-                    LOG_ERROR_0("all_clients initialization failed");
-                    goto err;
-                }
-                for (int i =0; i < arr_len; i++) {
-                    // Fetching individual public keys of all AllowedClients
-                    array_value = config_value_array_get(server_json_clients, i);
-                    if (array_value == NULL) {
-                        LOG_ERROR_0("array_value initialization failed");
-                        goto err;
-                    }
-                    size_t init_len = strlen(PUBLIC_KEYS) + strlen(array_value->body.string) + 2;
-                    char* grab_public_key = concat_s(init_len, 2, PUBLIC_KEYS, array_value->body.string);
-                    if (grab_public_key == NULL) {
-                        LOG_ERROR_0("concatenation for grab_public_key failed");
-                        goto err;
-                    }
-                    const char* client_public_key = kv_store_client->get(kv_store_handle, grab_public_key);
-                    if(client_public_key == NULL){
-                        // If any service isn't provisioned, ignore if key not found
-                        LOG_DEBUG("Value is not found for the key: %s", grab_public_key);
-                        all_clients[i] = NULL;
-                    } else {
-                        all_clients[i] = client_public_key;
-                    }
-                    free(grab_public_key);
-
-                    config_value_destroy(array_value);
-                }
-                // Adding all public keys of clients to allowed_clients of config
-                all_clients_arr_config = json_config_new_array(all_clients, arr_len);
-                if (all_clients_arr_config == NULL) {
-                    LOG_ERROR_0("Failed to create all_clients_arr_config config_t object");
-                    goto err;
-                }
 
-                all_clients_cvt = config_value_new_object(all_clients_arr_config->cfg, get_config_value, NULL);
-                if (all_clients_cvt == NULL) {
-                    LOG_ERROR_0("Unable to create config_value_t all_clients_cvt object");
-                    goto err;
-                }
-
-                config_set_result = config_set(c_json, "allowed_clients", all_clients_cvt);
-                if (!config_set_result) {
-                    LOG_ERROR_0("Unable to set config value");
-                    goto err;
-                }
-            }
-
-            // Fetching Publisher private key & adding it to server_topic object
-            size_t init_len = strlen("/") + strlen(PRIVATE_KEY) + strlen(app_name) + 2;
-            pub_pri_key = concat_s(init_len, 3, "/", app_name, PRIVATE_KEY);
-            if (pub_pri_key == NULL) {
-                LOG_ERROR_0("concatenation for pub_pri_key failed");
-                goto err;
-            }
-            server_secret_key = kv_store_client->get(kv_store_handle, pub_pri_key);
-            if (server_secret_key == NULL) {
-                LOG_ERROR("Value is not found for the key: %s", pub_pri_key);
-                goto err;
-            }
-
-            server_secret_key_cvt = config_value_new_string(server_secret_key);
+            server_secret_key_cvt = config_value_new_string(cfgmgr_key_value(server_secret_key));
             if (server_secret_key_cvt == NULL) {
                 LOG_ERROR_0("Get server_secret_key_cvt failed");
                 goto err;
@@ -2032,6 +2441,7 @@ config_t* cfgmgr_get_msgbus_config_server(cfgmgr_interface_t* ctx) {
 
 
 err:
+    env_overrides_release(overrides);
     if (type_value != NULL) {
         config_value_destroy(type_value);
     }
@@ -2044,48 +2454,28 @@ err:
     if (zmq_tcp_server_host != NULL) {
         config_value_destroy(zmq_tcp_server_host);
     }
-    if (temp_array_value != NULL) {
-        config_value_destroy(temp_array_value);
-    }
     if (server_name != NULL) {
         config_value_destroy(server_name);
     }
     if (server_config_type != NULL) {
         config_value_destroy(server_config_type);
     }
-    if (ep_override_env != NULL) {
-        free(ep_override_env);
-    }
     if (host_port != NULL) {
         free_mem(host_port);
     }
-    if (type_override_env != NULL) {
-        free(type_override_env);
-    }
     if (server_json_clients != NULL) {
         config_value_destroy(server_json_clients);
     }
-    if (pub_key_values != NULL) {
-        config_value_destroy(pub_key_values);
-    }
     if (server_endpoint != NULL) {
         config_value_destroy(server_endpoint);
     }
     if (pub_pri_key != NULL) {
         free(pub_pri_key);
     }
-    if (server_secret_key != NULL) {
-        free(server_secret_key);
-    }
+    cfgmgr_key_release(server_secret_key);
     if (config_value_cr != NULL) {
         free(config_value_cr);
     }
-    if (grab_public_key != NULL) {
-        free(grab_public_key);
-    }
-    if (client_public_key != NULL) {
-        free(client_public_key);
-    }
     if (type_cvt != NULL) {
         config_value_destroy(type_cvt);
     }
@@ -2101,18 +2491,6 @@ err:
     if (zmq_tcp_port != NULL) {
         config_value_destroy(zmq_tcp_port);
     }
-    if (all_clients_arr_config != NULL) {
-        free(all_clients_arr_config);
-    }
-    if (all_clients_cvt != NULL) {
-        free(all_clients_cvt);
-    }
-    // Only freeing the calloc for all_clients
-    // since overall freeing of all_clients
-    // will be handled by all_clients_cvt
-    if (all_clients != NULL) {
-        free(all_clients);
-    }
     if (server_secret_key_cvt != NULL) {
         config_value_destroy(server_secret_key_cvt);
     }
@@ -2122,14 +2500,16 @@ err:
     return c_json;
 }
 
-config_t* cfgmgr_get_msgbus_config_client(cfgmgr_interface_t* ctx) {
+// Builds the msgbus config of a client interface
+static config_t* msgbus_config_build_client(cfgmgr_interface_t* ctx) {
     LOG_DEBUG("In %s function", __func__);
+    // Env overrides read by the builder, the values point into them
+    struct cfgmgr_env_overrides* overrides = NULL;
     // Initializing base_cfg variables
     config_value_t* cli_config = ctx->interface;
     char* app_name = ctx->cfg_mgr->app_name;
     int dev_mode = ctx->cfg_mgr->dev_mode;
-    kv_store_client_t* kv_store_client = ctx->cfg_mgr->kv_store_client;
-    void* kv_store_handle = ctx->cfg_mgr->kv_store_handle;
+    cfgmgr_key_resolver_t* key_resolver = ctx->cfg_mgr->key_resolver;
     config_t* m_config = NULL;
     config_value_t* server_appname = NULL;
     config_value_t* zmq_recv_hwm_value = NULL;
@@ -2138,14 +2518,7 @@ config_t* cfgmgr_get_msgbus_config_client(cfgmgr_interface_t* ctx) {
     char** host_port = NULL;
     char* host = NULL;
     char* port = NULL;
-    char* s_client_pri_key = NULL;
-    char* s_client_public_key = NULL;
-    char* retreive_server_pub_key = NULL;
-    char* sub_public_key = NULL;
-    char* sub_pri_key = NULL;
-    char* type_override_env = NULL;
     char* type_override = NULL;
-    char* ep_override_env = NULL;
     char* config_value = NULL;
     config_t* c_json = NULL;
     config_value_t* client_name = NULL;
@@ -2153,9 +2526,6 @@ config_t* cfgmgr_get_msgbus_config_client(cfgmgr_interface_t* ctx) {
     config_t* client_topic = NULL;
     config_value_t* zmq_tcp_host = NULL;
     config_value_t* zmq_tcp_port = NULL;
-    config_value_t* server_public_key_cvt = NULL;
-    config_value_t* client_public_key_cvt = NULL;
-    config_value_t* sub_pri_key_cvt = NULL;
     config_value_t* client_topic_cvt = NULL;
     config_value_t* type_value = NULL;
     config_value_t* client_data = NULL;
@@ -2199,14 +2569,9 @@ config_t* cfgmgr_get_msgbus_config_client(cfgmgr_interface_t* ctx) {
     char* end_point = client_endpoint->body.string;
 
     // Overriding endpoint with CLIENT_<Name>_ENDPOINT if set
-    size_t init_len = strlen("CLIENT_") + strlen(client_name->body.string) + strlen("_ENDPOINT") + 2;
-    ep_override_env = concat_s(init_len, 3, "CLIENT_", client_name->body.string, "_ENDPOINT");
-    if (ep_override_env == NULL) {
-        LOG_ERROR_0("concatenation for ep_override_env failed");
-        goto err;
-    }
+    overrides = env_overrides_acquire(ctx->cfg_mgr);
     char client_ep[MAX_ENDPOINT_LENGTH] = "";
-    char* ep_override = getenv(ep_override_env);
+    char* ep_override = env_override_get(overrides, "CLIENT_", client_name->body.string, "_ENDPOINT");
     if (ep_override != NULL) {
 
         int ret = strncpy_s(client_ep, MAX_ENDPOINT_LENGTH + 1,
@@ -2217,16 +2582,16 @@ config_t* cfgmgr_get_msgbus_config_client(cfgmgr_interface_t* ctx) {
         }
 
         if (strlen(client_ep) != 0) {
-            LOG_DEBUG("Overriding endpoint with %s", ep_override_env);
+            LOG_DEBUG("Overriding endpoint with CLIENT_%s_ENDPOINT", client_name->body.string);
             end_point = client_ep;
         }
     } else {
-        LOG_DEBUG("env not set for overridding %s, and hence endpoint taking from interface ", ep_override_env);
+        LOG_DEBUG("env not set for overridding CLIENT_%s_ENDPOINT, and hence endpoint taking from interface ", client_name->body.string);
     }
 
     // Overriding endpoint with CLIENT_ENDPOINT if set
     // Note: This overrides all the client endpoints if set
-    char* client_ep_env = getenv("CLIENT_ENDPOINT");
+    char* client_ep_env = env_override_get(overrides, "CLIENT_ENDPOINT", NULL, NULL);
     if (client_ep_env != NULL) {
 
         int ret = strncpy_s(client_ep, MAX_ENDPOINT_LENGTH + 1,
@@ -2245,25 +2610,19 @@ config_t* cfgmgr_get_msgbus_config_client(cfgmgr_interface_t* ctx) {
     }
 
     // Overriding endpoint with CLIENT_<Name>_TYPE if set
-    init_len = strlen("CLIENT_") + strlen(client_name->body.string) + strlen("_TYPE") + 2;
-    type_override_env = concat_s(init_len, 3, "CLIENT_", client_name->body.string, "_TYPE");
-    if (type_override_env == NULL) {
-        LOG_ERROR_0("concatenation for type_override_env failed");
-        goto err;
-    }
-    type_override = getenv(type_override_env);
+    type_override = env_override_get(overrides, "CLIENT_", client_name->body.string, "_TYPE");
     if (type_override != NULL) {
         if (strlen(type_override) != 0) {
-            LOG_DEBUG("Overriding endpoint with %s", type_override_env);
+            LOG_DEBUG("Overriding endpoint with CLIENT_%s_TYPE", client_name->body.string);
             type = type_override;
         }
     } else {
-        LOG_DEBUG("env not set for overridding %s, and hence type taking from interface ", type_override_env);
+        LOG_DEBUG("env not set for overridding CLIENT_%s_TYPE, and hence type taking from interface ", client_name->body.string);
     }
 
     // Overriding endpoint with CLIENT_TYPE if set
     // Note: This overrides all the client type if set
-    char* client_type = getenv("CLIENT_TYPE");
+    char* client_type = env_override_get(overrides, "CLIENT_TYPE", NULL, NULL);
     if (client_type != NULL) {
         LOG_DEBUG_0("Overriding endpoint with CLIENT_TYPE");
         if (strlen(client_type) != 0) {
@@ -2303,6 +2662,7 @@ config_t* cfgmgr_get_msgbus_config_client(cfgmgr_interface_t* ctx) {
         bool ret = get_ipc_config(c_json, cli_config, end_point, CFGMGR_CLIENT);
         if (ret == false) {
             LOG_ERROR_0("IPC configuration for client failed");
+            env_overrides_release(overrides);
             return NULL;
         }
     } else if (!strcmp(type, "zmq_tcp")) {
@@ -2359,78 +2719,10 @@ config_t* cfgmgr_get_msgbus_config_client(cfgmgr_interface_t* ctx) {
                 goto err;
             }
 
-            // Adding server public key to config
-            size_t init_len = strlen(PUBLIC_KEYS) + strlen(server_appname->body.string) + 2;
-            retreive_server_pub_key = concat_s(init_len, 2, PUBLIC_KEYS, server_appname->body.string);
-            if (retreive_server_pub_key == NULL) {
-                LOG_ERROR_0("concatenation PUBLIC_KEYS and server_appname string failed");
-                goto err;
-            }
-            char* server_public_key = kv_store_client->get(kv_store_handle, retreive_server_pub_key);
-            if(server_public_key == NULL){
-                LOG_DEBUG("Value is not found for the key: %s", retreive_server_pub_key);
-            } else {
-                server_public_key_cvt = config_value_new_string(server_public_key);
-                if (server_public_key_cvt == NULL) {
-                    LOG_ERROR_0("Get server_secret_key_cvt failed");
-                    goto err;
-                }
-                config_set_result = config_set(client_topic, "server_public_key", server_public_key_cvt);
-                if (!config_set_result) {
-                    LOG_ERROR("Unable to set config value");
-                }
-
-                // free server_pub_key
-                if (server_public_key != NULL) {
-                    free(server_public_key);
-                }
-            }
-
-            // Adding client public key to config
-            init_len = strlen(PUBLIC_KEYS) + strlen(app_name) + strlen(app_name) + 2;
-            s_client_public_key = concat_s(init_len, 2, PUBLIC_KEYS, app_name);
-            if (s_client_public_key == NULL) {
-                LOG_ERROR_0("concatenation PUBLIC_KEYS and appname string failed");
-                goto err;
-            }
-            sub_public_key = kv_store_client->get(kv_store_handle, s_client_public_key);
-            if(sub_public_key == NULL){
-                LOG_ERROR("Value is not found for the key: %s", s_client_public_key);
-                goto err;
-            }
-
-            client_public_key_cvt = config_value_new_string(sub_public_key);
-            if (client_public_key_cvt == NULL) {
-                LOG_ERROR_0("Get client_public_key_cvt failed");
-                goto err;
-            }
-            config_set_result = config_set(client_topic, "client_public_key", client_public_key_cvt);
-            if (!config_set_result) {
-                LOG_ERROR_0("Unable to set config value");
-                goto err;
-            }
-
-            // Adding client private key to config
-            init_len = strlen("/") + strlen(app_name) + strlen(PRIVATE_KEY) + 2;
-            s_client_pri_key = concat_s(init_len, 3, "/", app_name, PRIVATE_KEY);
-            if (s_client_pri_key == NULL) {
-                LOG_ERROR_0("concatenation PRIVATE_KEY and appname string failed");
-                goto err;
-            }
-            sub_pri_key = kv_store_client->get(kv_store_handle, s_client_pri_key);
-            if(sub_pri_key == NULL){
-                LOG_ERROR("Value is not found for the key: %s", s_client_pri_key);
-                goto err;
-            }
-
-            sub_pri_key_cvt = config_value_new_string(sub_pri_key);
-            if (sub_pri_key_cvt == NULL) {
-                LOG_ERROR_0("Get sub_pri_key_cvt failed");
-                goto err;
-            }
-            config_set_result = config_set(client_topic, "client_secret_key", sub_pri_key_cvt);
-            if (!config_set_result) {
-                LOG_ERROR_0("Unable to set config value");
+            // Adding server public key and client keys to config
+            bool ret = add_keys_to_config(client_topic, app_name, key_resolver, server_appname, cli_config);
+            if (!ret) {
+                LOG_ERROR_0("Failed to add server public key and client keys to config");
                 goto err;
             }
         } else {
@@ -2512,6 +2804,7 @@ config_t* cfgmgr_get_msgbus_config_client(cfgmgr_interface_t* ctx) {
     }
 
 err:
+    env_overrides_release(overrides);
     if (type_value != NULL) {
         config_value_destroy(type_value);
     }
@@ -2524,21 +2817,6 @@ err:
     if (zmq_tcp_client_host != NULL) {
         config_value_destroy(zmq_tcp_client_host);
     }
-    if (s_client_pri_key != NULL) {
-        free(s_client_pri_key);
-    }
-    if (s_client_public_key != NULL) {
-        free(s_client_public_key);
-    }
-    if (retreive_server_pub_key != NULL) {
-        free(retreive_server_pub_key);
-    }
-    if (sub_public_key != NULL) {
-        free(sub_public_key);
-    }
-    if (sub_pri_key != NULL) {
-        free(sub_pri_key);
-    }
     if (config_value != NULL) {
         free(config_value);
     }
@@ -2554,12 +2832,6 @@ err:
     if (client_name != NULL) {
         config_value_destroy(client_name);
     }
-    if (ep_override_env != NULL) {
-        free(ep_override_env);
-    }
-    if (type_override_env != NULL) {
-        free(type_override_env);
-    }
     if (zmq_recv_hwm_value != NULL) {
         config_value_destroy(zmq_recv_hwm_value);
     }
@@ -2578,32 +2850,23 @@ err:
     if (zmq_tcp_port != NULL) {
         config_value_destroy(zmq_tcp_port);
     }
-    if (server_public_key_cvt != NULL) {
-        config_value_destroy(server_public_key_cvt);
-    }
-    if (client_public_key_cvt != NULL) {
-        config_value_destroy(client_public_key_cvt);
-    }
-    if (sub_pri_key_cvt != NULL) {
-        config_value_destroy(sub_pri_key_cvt);
-    }
     if (client_topic_cvt != NULL) {
         config_value_destroy(client_topic_cvt);
     }
     return c_json;
 }
 
-config_t* cfgmgr_get_msgbus_config(cfgmgr_interface_t* ctx) {
-    LOG_DEBUG("In %s function", __func__);
+// Builds the msgbus config of an interface as an interface of type
+static config_t* msgbus_config_build(cfgmgr_interface_t* ctx, cfgmgr_iface_type_t type) {
     config_t* config;
-    if (ctx->type == CFGMGR_PUBLISHER) {
-        config = cfgmgr_get_msgbus_config_pub(ctx);
-    } else if (ctx->type == CFGMGR_SUBSCRIBER) {
-        config = cfgmgr_get_msgbus_config_sub(ctx);
-    } else if (ctx->type == CFGMGR_SERVER) {
-        config = cfgmgr_get_msgbus_config_server(ctx);
-    } else if (ctx->type == CFGMGR_CLIENT) {
-        config = cfgmgr_get_msgbus_config_client(ctx);
+    if (type == CFGMGR_PUBLISHER) {
+        config = msgbus_config_build_pub(ctx);
+    } else if (type == CFGMGR_SUBSCRIBER) {
+        config = msgbus_config_build_sub(ctx);
+    } else if (type == CFGMGR_SERVER) {
+        config = msgbus_config_build_server(ctx);
+    } else if (type == CFGMGR_CLIENT) {
+        config = msgbus_config_build_client(ctx);
     } else {
         LOG_ERROR_0("Interface type not supported");
         return NULL;
@@ -2611,6 +2874,373 @@ config_t* cfgmgr_get_msgbus_config(cfgmgr_interface_t* ctx) {
     return config;
 }
 
+// Looks up the memo of an interface, the caller holding iface_mtx
+static msgbus_memo_t* msgbus_memo_find(struct cfgmgr_msgbus_cache* cache, const cJSON* interface, cfgmgr_iface_type_t type) {
+    for (msgbus_memo_t* memo = cache->memos; memo != NULL; memo = memo->next) {
+        if (memo->interface == interface && memo->type == type) {
+            return memo;
+        }
+    }
+    return NULL;
+}
+
+// Returns the memoized msgbus config of the interface as an interface of
+// type, building and memoizing it when the interfaces, the keys read by
+// the builder or the env overrides changed since it was last built
+static config_t* msgbus_cache_get(cfgmgr_interface_t* ctx, cfgmgr_iface_type_t type) {
+    cfgmgr_ctx_t* cfgmgr = ctx->cfg_mgr;
+    struct cfgmgr_msgbus_cache* cache = cfgmgr->msgbus_cache;
+    const cJSON* interface = (const cJSON*) ctx->interface->body.object->object;
+    config_t* config = NULL;
+
+    pthread_mutex_lock(&cfgmgr->iface_mtx);
+    msgbus_memo_t* memo = msgbus_memo_find(cache, interface, type);
+    if (memo != NULL && memo->iface_revision == cfgmgr->iface_revision &&
+            memo->kv_revision == cache->kv_revision &&
+            memo->env_revision == cfgmgr->env_overrides->revision) {
+        config = msgbus_shared_config(memo->shared);
+        pthread_mutex_unlock(&cfgmgr->iface_mtx);
+        return config;
+    }
+    // Taking the revisions before building, a change made while building
+    // leaves the memo stale
+    msgbus_memo_t* built = (msgbus_memo_t*) calloc(1, sizeof(msgbus_memo_t));
+    if (built == NULL) {
+        pthread_mutex_unlock(&cfgmgr->iface_mtx);
+        LOG_ERROR_0("Calloc failed for the msgbus config memo");
+        return NULL;
+    }
+    built->interface = interface;
+    built->type = type;
+    built->iface_revision = cfgmgr->iface_revision;
+    built->kv_revision = cache->kv_revision;
+    built->env_revision = cfgmgr->env_overrides->revision;
+    pthread_mutex_unlock(&cfgmgr->iface_mtx);
+
+    config = msgbus_config_build(ctx, type);
+    if (config == NULL) {
+        msgbus_memo_free(built);
+        return NULL;
+    }
+    // Sharing the built json, freeing config_t without its inner cfg
+    built->shared = msgbus_shared_new((cJSON*) config->cfg);
+    if (built->shared == NULL) {
+        msgbus_memo_free(built);
+        return config;
+    }
+    free(config);
+    config = msgbus_shared_config(built->shared);
+
+    pthread_mutex_lock(&cfgmgr->iface_mtx);
+    memo = msgbus_memo_find(cache, interface, type);
+    if (memo != NULL) {
+        msgbus_memo_t** link = &cache->memos;
+        while (*link != memo) {
+            link = &(*link)->next;
+        }
+        *link = memo->next;
+    }
+    built->next = cache->memos;
+    cache->memos = built;
+    pthread_mutex_unlock(&cfgmgr->iface_mtx);
+    if (memo != NULL) {
+        msgbus_memo_free(memo);
+    }
+    return config;
+}
+
+// Watches of the keys read by the msgbus config builders
+#define KEY_WATCH_PUBLIC_KEYS 0x1
+#define KEY_WATCH_PRIVATE_KEY 0x2
+#define NUM_KEY_WATCHES 2
+
+// User data of a watch of the keys, identifying the watch
+struct cfgmgr_key_watch {
+    cfgmgr_ctx_t* cfgmgr;
+    unsigned int watch;
+};
+
+// Marks a watch of the keys as lost or live again, the resolved keys only
+// being kept while both watches are live. Must be called with iface_mtx held
+static void key_watch_set_live(cfgmgr_ctx_t* cfgmgr, unsigned int watch, bool live) {
+    if (live) {
+        cfgmgr->key_watches_lost &= ~watch;
+    } else {
+        cfgmgr->key_watches_lost |= watch;
+    }
+    if (cfgmgr->key_resolver != NULL) {
+        // Changes may have been missed while a watch was lost, the keys
+        // resolved before are dropped either way
+        cfgmgr_key_resolver_set_enabled(cfgmgr->key_resolver, cfgmgr->key_watches_lost == 0);
+    }
+}
+
+// Drops the resolved keys and tracks the revision of the keys read by
+// the msgbus config builders when they change in the kv store
+static void msgbus_keys_watch_callback(const kv_store_watch_event_t* event, void* user_data) {
+    struct cfgmgr_key_watch* key_watch = (struct cfgmgr_key_watch*) user_data;
+    cfgmgr_ctx_t* cfgmgr = key_watch->cfgmgr;
+    pthread_mutex_lock(&cfgmgr->iface_mtx);
+    if (event->type == KV_STORE_EVENT_CREATED || event->type == KV_STORE_EVENT_CANCELED) {
+        if (event->type == KV_STORE_EVENT_CANCELED) {
+            LOG_WARN("Watch on %s lost, reading the keys from the kv store", event->key);
+        }
+        key_watch_set_live(cfgmgr, key_watch->watch, event->type == KV_STORE_EVENT_CREATED);
+    } else if (cfgmgr->key_resolver != NULL) {
+        cfgmgr_key_resolver_invalidate(cfgmgr->key_resolver);
+    }
+    struct cfgmgr_msgbus_cache* cache = cfgmgr->msgbus_cache;
+    if (cache != NULL) {
+        cache->kv_revision = (event->mod_revision > cache->kv_revision) ?
+                event->mod_revision : cache->kv_revision + 1;
+    }
+    pthread_mutex_unlock(&cfgmgr->iface_mtx);
+    if (event->value != NULL) {
+        config_destroy(event->value);
+    }
+    if (event->prev_value != NULL) {
+        config_destroy(event->prev_value);
+    }
+}
+
+// Returns the msgbus config of the interface as an interface of type,
+// memoized when CONFIGMGR_MSGBUS_CACHE is set to true
+static config_t* msgbus_config_get(cfgmgr_interface_t* ctx, cfgmgr_iface_type_t type) {
+    if (ctx->cfg_mgr->msgbus_cache != NULL) {
+        return msgbus_cache_get(ctx, type);
+    }
+    return msgbus_config_build(ctx, type);
+}
+
+config_t* cfgmgr_get_msgbus_config(cfgmgr_interface_t* ctx) {
+    LOG_DEBUG("In %s function", __func__);
+    if (ctx->type < CFGMGR_PUBLISHER || ctx->type > CFGMGR_CLIENT) {
+        LOG_ERROR_0("Interface type not supported");
+        return NULL;
+    }
+    return msgbus_config_get(ctx, ctx->type);
+}
+
+config_t* cfgmgr_get_msgbus_config_pub(cfgmgr_interface_t* ctx) {
+    LOG_DEBUG("In %s function", __func__);
+    return msgbus_config_get(ctx, CFGMGR_PUBLISHER);
+}
+
+config_t* cfgmgr_get_msgbus_config_sub(cfgmgr_interface_t* ctx) {
+    LOG_DEBUG("In %s function", __func__);
+    return msgbus_config_get(ctx, CFGMGR_SUBSCRIBER);
+}
+
+config_t* cfgmgr_get_msgbus_config_server(cfgmgr_interface_t* ctx) {
+    LOG_DEBUG("In %s function", __func__);
+    return msgbus_config_get(ctx, CFGMGR_SERVER);
+}
+
+config_t* cfgmgr_get_msgbus_config_client(cfgmgr_interface_t* ctx) {
+    LOG_DEBUG("In %s function", __func__);
+    return msgbus_config_get(ctx, CFGMGR_CLIENT);
+}
+
+// Upper bound of the threads building the msgbus configs of
+// cfgmgr_get_all_msgbus_configs(), the calling thread included
+#define MSGBUS_BUILD_MAX_WORKERS 8
+
+// Msgbus configs built by the workers of cfgmgr_get_all_msgbus_configs()
+typedef struct {
+    cfgmgr_interface_t** interfaces;
+    cfgmgr_msgbus_config_t* configs;
+    int num_configs;
+
+    // Guards next and failed
+    pthread_mutex_t mtx;
+
+    // Next config to be built
+    int next;
+
+    // Set once a config failed to be built, the remaining ones being skipped
+    bool failed;
+} msgbus_build_t;
+
+static void* msgbus_build_worker(void* arg) {
+    msgbus_build_t* build = (msgbus_build_t*) arg;
+    while (true) {
+        pthread_mutex_lock(&build->mtx);
+        if (build->failed || build->next == build->num_configs) {
+            pthread_mutex_unlock(&build->mtx);
+            break;
+        }
+        int i = build->next++;
+        pthread_mutex_unlock(&build->mtx);
+
+        build->configs[i].msgbus_config = cfgmgr_get_msgbus_config(build->interfaces[i]);
+        if (build->configs[i].msgbus_config == NULL) {
+            LOG_ERROR("Failed to build the msgbus config of %s %d",
+                      iface_type_keys[build->configs[i].type], build->configs[i].index);
+            pthread_mutex_lock(&build->mtx);
+            build->failed = true;
+            pthread_mutex_unlock(&build->mtx);
+        }
+    }
+    return NULL;
+}
+
+cfgmgr_msgbus_config_t* cfgmgr_get_all_msgbus_configs(cfgmgr_ctx_t* cfgmgr, int* num_configs) {
+    LOG_DEBUG("In %s function", __func__);
+    msgbus_build_t build;
+    pthread_t workers[MSGBUS_BUILD_MAX_WORKERS - 1];
+    int num_workers = 0;
+    int count = 0;
+    char* pri_key = NULL;
+    char* pub_key = NULL;
+    cfgmgr_key_t* resolved[2] = {NULL, NULL};
+    cfgmgr_key_stats_t stats_before;
+    cfgmgr_key_stats_t stats_after;
+    cfgmgr_msgbus_config_t* result = NULL;
+    struct cfgmgr_iface_index* iface_index = NULL;
+
+    memset(&build, 0, sizeof(build));
+    pthread_mutex_init(&build.mtx, NULL);
+
+    // Resolving every interface in one pass, the reference held on the
+    // index keeps its document alive until the configs are built
+    cJSON* iface_arrays[NUM_IFACE_TYPES];
+    iface_index = iface_index_acquire(cfgmgr);
+    const cJSON* json = (const cJSON*) kv_store_lazy_config_json(iface_index->app_interface);
+    if (json == NULL) {
+        LOG_ERROR_0("Interfaces are not a JSON object");
+        goto err;
+    }
+    for (size_t t = 0; t < NUM_IFACE_TYPES; t++) {
+        iface_arrays[t] = cJSON_GetObjectItem(json, iface_type_keys[t]);
+        if (cJSON_IsArray(iface_arrays[t])) {
+            count += cJSON_GetArraySize(iface_arrays[t]);
+        }
+    }
+    if (count == 0) {
+        LOG_ERROR_0("No interfaces found in the application interface");
+        goto err;
+    }
+
+    build.configs = (cfgmgr_msgbus_config_t*) calloc(count, sizeof(cfgmgr_msgbus_config_t));
+    build.interfaces = (cfgmgr_interface_t**) calloc(count, sizeof(cfgmgr_interface_t*));
+    if (build.configs == NULL || build.interfaces == NULL) {
+        LOG_ERROR_0("Calloc failed for the msgbus configs");
+        goto err;
+    }
+    for (size_t t = 0; t < NUM_IFACE_TYPES; t++) {
+        if (!cJSON_IsArray(iface_arrays[t])) {
+            continue;
+        }
+        int index = 0;
+        cJSON* interface = NULL;
+        cJSON_ArrayForEach(interface, iface_arrays[t]) {
+            cfgmgr_interface_t* ctx = cfgmgr_interface_initialize();
+            if (ctx == NULL) {
+                LOG_ERROR_0("cfgmgr initialization failed");
+                goto err;
+            }
+            build.interfaces[build.num_configs] = ctx;
+            ctx->iface_index = iface_index_ref(iface_index);
+            ctx->interface = config_value_new_object((void*) interface, get_config_value, NULL);
+            if (ctx->interface == NULL) {
+                LOG_ERROR_0("config initialization failed");
+                goto err;
+            }
+            ctx->cfg_mgr = cfgmgr;
+            ctx->type = (cfgmgr_iface_type_t) t;
+            build.configs[build.num_configs].type = ctx->type;
+            build.configs[build.num_configs].index = index++;
+            build.num_configs++;
+        }
+    }
+
+    // The application's own keys are read by most interfaces in prod
+    // mode, resolving them before the builders run concurrently
+    memset(&stats_before, 0, sizeof(stats_before));
+    if (cfgmgr->key_resolver != NULL) {
+        cfgmgr_key_resolver_get_stats(cfgmgr->key_resolver, &stats_before);
+    }
+    if (cfgmgr->dev_mode != 0 && cfgmgr->key_resolver != NULL) {
+        size_t init_len = strlen("/") + strlen(cfgmgr->app_name) + strlen(PRIVATE_KEY) + 2;
+        pri_key = concat_s(init_len, 3, "/", cfgmgr->app_name, PRIVATE_KEY);
+        init_len = strlen(PUBLIC_KEYS) + strlen(cfgmgr->app_name) + 2;
+        pub_key = concat_s(init_len, 2, PUBLIC_KEYS, cfgmgr->app_name);
+        if (pri_key == NULL || pub_key == NULL) {
+            LOG_ERROR_0("Concatenation failed for the application keys");
+            goto err;
+        }
+        char* keys[] = {pri_key, pub_key};
+        if (!cfgmgr_key_resolve_many(cfgmgr->key_resolver, keys, 2, resolved)) {
+            LOG_WARN_0("Failed to resolve the application keys up front");
+        }
+    }
+
+    // The calling thread builds configs along with the workers
+    num_workers = (build.num_configs < MSGBUS_BUILD_MAX_WORKERS) ?
+            build.num_configs - 1 : MSGBUS_BUILD_MAX_WORKERS - 1;
+    for (int i = 0; i < num_workers; i++) {
+        if (pthread_create(&workers[i], NULL, msgbus_build_worker, &build) != 0) {
+            LOG_WARN("Failed to start msgbus config worker %d, continuing with %d workers", i, i);
+            num_workers = i;
+            break;
+        }
+    }
+    msgbus_build_worker(&build);
+    for (int i = 0; i < num_workers; i++) {
+        pthread_join(workers[i], NULL);
+    }
+    if (build.failed) {
+        goto err;
+    }
+    if (cfgmgr->key_resolver != NULL) {
+        cfgmgr_key_resolver_get_stats(cfgmgr->key_resolver, &stats_after);
+        LOG_DEBUG("Built %d msgbus configs, %llu key fetches saved between them",
+                  build.num_configs,
+                  (unsigned long long) (stats_after.fetches_saved - stats_before.fetches_saved));
+    }
+
+    result = build.configs;
+    build.configs = NULL;
+    *num_configs = build.num_configs;
+
+err:
+    if (build.configs != NULL) {
+        cfgmgr_msgbus_configs_destroy(build.configs, build.num_configs);
+    }
+    if (build.interfaces != NULL) {
+        for (int i = 0; i < count; i++) {
+            if (build.interfaces[i] != NULL) {
+                cfgmgr_interface_destroy(build.interfaces[i]);
+            }
+        }
+        free(build.interfaces);
+    }
+    for (int i = 0; i < 2; i++) {
+        cfgmgr_key_release(resolved[i]);
+    }
+    if (pri_key != NULL) {
+        free(pri_key);
+    }
+    if (pub_key != NULL) {
+        free(pub_key);
+    }
+    iface_index_release(iface_index);
+    pthread_mutex_destroy(&build.mtx);
+    return result;
+}
+
+void cfgmgr_msgbus_configs_destroy(cfgmgr_msgbus_config_t* configs, int num_configs) {
+    LOG_DEBUG("In %s function", __func__);
+    if (configs != NULL) {
+        for (int i = 0; i < num_configs; i++) {
+            if (configs[i].msgbus_config != NULL) {
+                config_destroy(configs[i].msgbus_config);
+            }
+        }
+        free(configs);
+    }
+}
+
 bool cfgmgr_is_dev_mode(cfgmgr_ctx_t* cfgmgr) {
     LOG_DEBUG("In %s function", __func__);
     // Fetching dev mode from cfgmgr
@@ -2651,46 +3281,65 @@ int cfgmgr_get_num_elements(config_t* config, const char* key) {
 
 int cfgmgr_get_num_publishers(cfgmgr_ctx_t* cfgmgr) {
     LOG_DEBUG("In %s function", __func__);
-    int result = cfgmgr_get_num_elements(cfgmgr->app_interface, PUBLISHERS);
+    struct cfgmgr_iface_index* index = iface_index_acquire(cfgmgr);
+    int result = cfgmgr_get_num_elements(index->app_interface, PUBLISHERS);
+    iface_index_release(index);
     return result;
 }
 
 int cfgmgr_get_num_subscribers(cfgmgr_ctx_t* cfgmgr) {
     LOG_DEBUG("In %s function", __func__);
-    int result = cfgmgr_get_num_elements(cfgmgr->app_interface, SUBSCRIBERS);
+    struct cfgmgr_iface_index* index = iface_index_acquire(cfgmgr);
+    int result = cfgmgr_get_num_elements(index->app_interface, SUBSCRIBERS);
+    iface_index_release(index);
     return result;
 }
 
 int cfgmgr_get_num_servers(cfgmgr_ctx_t* cfgmgr) {
     LOG_DEBUG("In %s function", __func__);
-    int result = cfgmgr_get_num_elements(cfgmgr->app_interface, SERVERS);
+    struct cfgmgr_iface_index* index = iface_index_acquire(cfgmgr);
+    int result = cfgmgr_get_num_elements(index->app_interface, SERVERS);
+    iface_index_release(index);
     return result;
 }
 
 int cfgmgr_get_num_clients(cfgmgr_ctx_t* cfgmgr) {
     LOG_DEBUG("In %s function", __func__);
-    int result = cfgmgr_get_num_elements(cfgmgr->app_interface, CLIENTS);
+    struct cfgmgr_iface_index* index = iface_index_acquire(cfgmgr);
+    int result = cfgmgr_get_num_elements(index->app_interface, CLIENTS);
+    iface_index_release(index);
     return result;
 }
 
 config_t* cfgmgr_get_app_config(cfgmgr_ctx_t* cfgmgr) {
     LOG_DEBUG("In %s function", __func__);
-    return cfgmgr->app_config;
+    pthread_mutex_lock(&cfgmgr->iface_mtx);
+    config_t* app_config = cfgmgr->app_config;
+    pthread_mutex_unlock(&cfgmgr->iface_mtx);
+    return app_config;
 }
 
 config_t* cfgmgr_get_app_interface(cfgmgr_ctx_t* cfgmgr) {
     LOG_DEBUG("In %s function", __func__);
-    return cfgmgr->app_interface;
+    pthread_mutex_lock(&cfgmgr->iface_mtx);
+    config_t* app_interface = cfgmgr->app_interface;
+    pthread_mutex_unlock(&cfgmgr->iface_mtx);
+    return app_interface;
 }
 
 config_value_t* cfgmgr_get_app_config_value(cfgmgr_ctx_t* cfgmgr, const char* key) {
     LOG_DEBUG("In %s function", __func__);
-    return cfgmgr->app_config->get_config_value(cfgmgr->app_config->cfg, key);
+    config_t* app_config = cfgmgr_get_app_config(cfgmgr);
+    return app_config->get_config_value(app_config->cfg, key);
 }
 
 config_value_t* cfgmgr_get_app_interface_value(cfgmgr_ctx_t* cfgmgr, const char* key) {
     LOG_DEBUG("In %s function", __func__);
-    return cfgmgr->app_interface->get_config_value(cfgmgr->app_interface->cfg, key);
+    struct cfgmgr_iface_index* index = iface_index_acquire(cfgmgr);
+    config_t* app_interface = index->app_interface;
+    config_value_t* value = app_interface->get_config_value(app_interface->cfg, key);
+    iface_index_release(index);
+    return value;
 }
 
 config_value_t* cfgmgr_get_interface_value(cfgmgr_interface_t* cfgmgr_interface, const char* key) {
@@ -2713,21 +3362,161 @@ void cfgmgr_watch_prefix(cfgmgr_ctx_t* cfgmgr, char* prefix, cfgmgr_watch_callba
     return;
 }
 
+// State of a watch registered with cfgmgr_watch_diff()
+struct cfgmgr_diff_watch {
+    // value last notified, NULL if the key does not exist. Only accessed
+    // from the watch callback, which is never run concurrently for a key
+    config_t* previous;
+    cfgmgr_watch_diff_callback_t watch_callback;
+    void* user_data;
+    struct cfgmgr_diff_watch* next;
+};
+
+// Copies a JSON config_t
+static config_t* diff_copy_config(const config_t* config) {
+    const cJSON* json = (const cJSON*) kv_store_lazy_config_json(config);
+    if (json == NULL) {
+        LOG_ERROR_0("Failed to parse the configuration");
+        return NULL;
+    }
+    cJSON* copy = cJSON_Duplicate(json, true);
+    if (copy == NULL) {
+        LOG_ERROR_0("Failed to copy the configuration");
+        return NULL;
+    }
+    config_t* config_copy = config_new(
+            (void*) copy, free_json, get_config_value, set_config_value);
+    if (config_copy == NULL) {
+        LOG_ERROR_0("Failed to initialize configuration object");
+        cJSON_Delete(copy);
+    }
+    return config_copy;
+}
+
+static void diff_watch_callback(const kv_store_watch_event_t* event, void* user_data) {
+    struct cfgmgr_diff_watch* watch = (struct cfgmgr_diff_watch*) user_data;
+    cfgmgr_config_diff_t diff;
+    config_t* copy = NULL;
+
+    // Missed changes are notified once the watch resumes
+    if (event->type == KV_STORE_EVENT_CREATED || event->type == KV_STORE_EVENT_CANCELED) {
+        return;
+    }
+
+    if (event->prev_value != NULL) {
+        config_destroy(event->prev_value);
+    }
+    if (!cfgmgr_config_diff(watch->previous, event->value, &diff)) {
+        LOG_ERROR("Failed to compute the diff of key %s", event->key);
+        goto err;
+    }
+    if (diff.num_added == 0 && diff.num_removed == 0 && diff.num_changed == 0) {
+        LOG_DEBUG("Value of key %s is unchanged", event->key);
+        cfgmgr_config_diff_free(&diff);
+        goto err;
+    }
+    // The callee owns the value, a copy is kept to diff the next change
+    if (event->value != NULL) {
+        copy = diff_copy_config(event->value);
+        if (copy == NULL) {
+            cfgmgr_config_diff_free(&diff);
+            goto err;
+        }
+    }
+    if (watch->previous != NULL) {
+        config_destroy(watch->previous);
+    }
+    watch->previous = copy;
+    LOG_DEBUG("Key %s changed: %d added, %d removed, %d changed", event->key,
+              (int) diff.num_added, (int) diff.num_removed, (int) diff.num_changed);
+    watch->watch_callback(event->key, event->value, &diff, watch->user_data);
+    cfgmgr_config_diff_free(&diff);
+    return;
+err:
+    if (event->value != NULL) {
+        config_destroy(event->value);
+    }
+}
+
+bool cfgmgr_watch_diff(cfgmgr_ctx_t* cfgmgr, const char* key, cfgmgr_watch_diff_callback_t watch_callback, void* user_data) {
+    LOG_DEBUG("In %s function", __func__);
+    kv_store_value_view_t view;
+    kv_store_watch_options_t opts;
+    char* keys[1] = { (char*) key };
+
+    struct cfgmgr_diff_watch* watch = (struct cfgmgr_diff_watch*) malloc(sizeof(struct cfgmgr_diff_watch));
+    if (watch == NULL) {
+        LOG_ERROR_0("Malloc failed for diff watch");
+        return false;
+    }
+    watch->previous = NULL;
+    watch->watch_callback = watch_callback;
+    watch->user_data = user_data;
+
+    // The current value is the base the first change is compared to, the
+    // watch starts right after the revision it was read at so that no
+    // change made in between is missed
+    memset(&view, 0, sizeof(view));
+    if (cfgmgr->kv_store_client->get_view(cfgmgr->kv_store_handle, keys, 1, &view) != 0) {
+        LOG_ERROR("Failed to read the value of %s", key);
+        free(watch);
+        return false;
+    }
+    if (view.data != NULL) {
+        watch->previous = kv_store_lazy_config_new(key, view.data, view.len);
+        if (watch->previous == NULL) {
+            LOG_ERROR_0("Failed to initialize configuration object");
+            cfgmgr->kv_store_client->release_view(cfgmgr->kv_store_handle, &view);
+            free(watch);
+            return false;
+        }
+    }
+    memset(&opts, 0, sizeof(opts));
+    if (view.revision > 0) {
+        opts.start_revision = view.revision + 1;
+    }
+    cfgmgr->kv_store_client->release_view(cfgmgr->kv_store_handle, &view);
+
+    // The callback is never called if the watch is not registered
+    if (cfgmgr->kv_store_client->watch_events(cfgmgr->kv_store_handle, (char*) key, &opts,
+                                              diff_watch_callback, watch) != 0) {
+        LOG_ERROR("Failed to watch %s", key);
+        if (watch->previous != NULL) {
+            config_destroy(watch->previous);
+        }
+        free(watch);
+        return false;
+    }
+
+    // Freed on destroy, once the kv store client stops calling it
+    pthread_mutex_lock(&cfgmgr->iface_mtx);
+    watch->next = cfgmgr->diff_watches;
+    cfgmgr->diff_watches = watch;
+    pthread_mutex_unlock(&cfgmgr->iface_mtx);
+    return true;
+}
+
 cfgmgr_ctx_t* cfgmgr_initialize() {
     LOG_DEBUG("In %s function", __func__);
     int result = 0;
     config_t* app_config = NULL;
-    char* interface = NULL;
+    const char* interface = NULL;
     config_t* app_interface = NULL;
-    char* value = NULL;
+    struct cfgmgr_iface_index* iface_index = NULL;
+    struct cfgmgr_env_overrides* env_overrides = NULL;
+    const char* value = NULL;
     char* c_app_name = NULL;
     char* interface_char = NULL;
     char* config_char = NULL;
+    char* app_prefix = NULL;
     char* env_var = NULL;
+    kv_store_value_view_t init_views[3];
+    memset(init_views, 0, sizeof(init_views));
     kv_store_client_t* kv_store_client = NULL;
     config_t* kv_store_config = NULL;
     char dev_mode_var[MAX_MODE_LENGTH] = "";
     char* app_name_var = NULL;
+    bool prefetched = false;
 
     cfgmgr_ctx_t *cfg_mgr = (cfgmgr_ctx_t *)malloc(sizeof(cfgmgr_ctx_t));
     if (cfg_mgr == NULL) {
@@ -2736,6 +3525,16 @@ cfgmgr_ctx_t* cfgmgr_initialize() {
     }
     // Setting app_cfg->env_var to NULL initially
     cfg_mgr->env_var = NULL;
+    cfg_mgr->diff_watches = NULL;
+    cfg_mgr->iface_index = NULL;
+    cfg_mgr->replaced_iface_indexes = NULL;
+    cfg_mgr->iface_revision = 0;
+    cfg_mgr->msgbus_cache = NULL;
+    cfg_mgr->env_overrides = NULL;
+    cfg_mgr->key_resolver = NULL;
+    cfg_mgr->key_watches_lost = 0;
+    cfg_mgr->key_watches = NULL;
+    cfg_mgr->snapshot_app_config = NULL;
 
     // Fetching & intializing dev mode variable
     char* dev_mode_env = getenv("DEV_MODE");
@@ -2755,6 +3554,34 @@ cfgmgr_ctx_t* cfgmgr_initialize() {
         goto err;
     }
 
+    // Fetching AppName
+    app_name_var = getenv("AppName");
+    if (app_name_var == NULL) {
+        LOG_ERROR_0("AppName env not set");
+        goto err;
+    }
+    size_t str_len = strlen(app_name_var) + 1;
+    c_app_name = (char*)malloc(sizeof(char) * str_len);
+    if (c_app_name == NULL) {
+        LOG_ERROR_0("c_app_name is NULL");
+        goto err;
+    }
+    int ret = snprintf(c_app_name, str_len, "%s", app_name_var);
+    if (ret < 0) {
+        LOG_ERROR_0("snprintf failed to c_app_name");
+        goto err;
+    }
+    LOG_DEBUG("AppName: %s", c_app_name);
+    trim(c_app_name);
+
+    // Keys of the app
+    size_t init_len = strlen("/") + strlen(c_app_name) + strlen("/") + 1;
+    app_prefix = concat_s(init_len, 3, "/", c_app_name, "/");
+    if (app_prefix == NULL) {
+        LOG_ERROR_0("Concatenation of /appname and / failed");
+        goto err;
+    }
+
     kv_store_config = create_kv_store_config();
     if (kv_store_config == NULL) {
         LOG_ERROR_0("kv_store_config initialization failed");
@@ -2767,6 +3594,18 @@ cfgmgr_ctx_t* cfgmgr_initialize() {
         goto err;
     }
 
+    // Caching the values of the keys read by the app when CONFIGMGR_CACHE
+    // is set to true, the cache is kept coherent by a watch on each prefix
+    if (is_env_true("CONFIGMGR_CACHE")) {
+        char* cache_prefixes[] = {"/GlobalEnv/", app_prefix, PUBLIC_KEYS};
+        kv_store_client_t* kv_store_cache = kv_store_cache_new(kv_store_client, cache_prefixes, 3);
+        if (kv_store_cache == NULL) {
+            LOG_ERROR_0("kv_store_cache initialization failed");
+            goto err;
+        }
+        kv_store_client = kv_store_cache;
+    }
+
     // Initializing etcd client handle
     void *handle = kv_store_client->init(kv_store_client);
     if (handle == NULL) {
@@ -2774,8 +3613,63 @@ cfgmgr_ctx_t* cfgmgr_initialize() {
         goto err;
     }
 
-    // Fetching GlobalEnv
-    env_var = kv_store_client->get(handle, "/GlobalEnv/");
+    // Fetching App interfaces
+    init_len = strlen("/") + strlen(c_app_name) + strlen("/interfaces") + 1;
+    interface_char = concat_s(init_len, 3, "/", c_app_name, "/interfaces");
+    if (interface_char == NULL){
+        LOG_ERROR_0("Concatenation of /appname and /interfaces failed");
+        goto err;
+    }
+
+    // Fetching App config
+    init_len = strlen("/") + strlen(c_app_name) + strlen("/config") + 1;
+    config_char = concat_s(init_len, 3, "/", c_app_name, "/config");
+    if (config_char == NULL) {
+        LOG_ERROR_0("Concatenation of /appname and /config failed");
+        goto err;
+    }
+
+    LOG_DEBUG("interface_char: %s", interface_char);
+    LOG_DEBUG("config_char: %s", config_char);
+
+    // Prefetching every key needed by the app in one request when
+    // CONFIGMGR_PREFETCH is set to true or a snapshot is kept, the reads
+    // made until cfg_mgr is initialized are served locally. With a valid
+    // snapshot the keys are served from it without waiting for the kv store
+    char* snapshot_env = getenv("CONFIGMGR_SNAPSHOT");
+    if (is_env_true("CONFIGMGR_PREFETCH") ||
+            (snapshot_env != NULL && strlen(snapshot_env) != 0)) {
+        char* prefetch_prefixes[] = {"/GlobalEnv/", app_prefix, "/Publickeys/"};
+        prefetched = true;
+        if (kv_store_client->prefetch(handle, prefetch_prefixes, 3) != 0) {
+            LOG_WARN_0("Failed to prefetch the app keys,"
+                       " continuing with reads from the kv store");
+        }
+    }
+
+    // Fetching GlobalEnv, App interfaces and App config in one request,
+    // interfaces and config are parsed straight from the fetched values
+    char* init_keys[] = {"/GlobalEnv/", interface_char, config_char};
+    if (kv_store_client->get_view(handle, init_keys, 3, init_views) != 0) {
+        LOG_ERROR_0("Failed to fetch GlobalEnv, interfaces and config");
+        goto err;
+    }
+    if (init_views[0].data != NULL) {
+        // GlobalEnv is kept for the lifetime of cfg_mgr
+        env_var = (char*)malloc(init_views[0].len + 1);
+        if (env_var == NULL) {
+            LOG_ERROR_0("Malloc failed for env_var");
+            goto err;
+        }
+        ret = strcpy_s(env_var, init_views[0].len + 1, init_views[0].data);
+        if (ret != 0) {
+            LOG_ERROR_0("Failed to copy GlobalEnv");
+            goto err;
+        }
+    }
+    interface = init_views[1].data;
+    value = init_views[2].data;
+
     if (env_var == NULL) {
         LOG_WARN_0("Value is not found for the key /GlobalEnv/,"
                    " continuing without setting GlobalEnv vars");
@@ -2823,52 +3717,11 @@ cfgmgr_ctx_t* cfgmgr_initialize() {
 
     set_log_level(log_level);
 
-    // Fetching AppName
-    app_name_var = getenv("AppName");
-    if (app_name_var == NULL) {
-        LOG_ERROR_0("AppName env not set");
-        goto err;
-    }
-    size_t str_len = strlen(app_name_var) + 1;
-    c_app_name = (char*)malloc(sizeof(char) * str_len);
-    if (c_app_name == NULL) {
-        LOG_ERROR_0("c_app_name is NULL");
-        goto err;
-    }
-    int ret = snprintf(c_app_name, str_len, "%s", app_name_var);
-    if (ret < 0) {
-        LOG_ERROR_0("snprintf failed to c_app_name");
-        goto err;
-    }
-    LOG_DEBUG("AppName: %s", c_app_name);
-    trim(c_app_name);
-
-    // Fetching App interfaces
-    size_t init_len = strlen("/") + strlen(c_app_name) + strlen("/interfaces") + 1;
-    interface_char = concat_s(init_len, 3, "/", c_app_name, "/interfaces");
-    if (interface_char == NULL){
-        LOG_ERROR_0("Concatenation of /appname and /interfaces failed");
-        goto err;
-    }
-
-    // Fetching App config
-    init_len = strlen("/") + strlen(c_app_name) + strlen("/config") + 1;
-    config_char = concat_s(init_len, 3, "/", c_app_name, "/config");
-    if (config_char == NULL) {
-        LOG_ERROR_0("Concatenation of /appname and /config failed");
-        goto err;
-    }
-
-    LOG_DEBUG("interface_char: %s", interface_char);
-    LOG_DEBUG("config_char: %s", config_char);
-
-    interface = kv_store_client->get(handle, interface_char);
     if (interface == NULL) {
         LOG_ERROR("Failed to fetch value for the key: %s", interface_char);
         goto err;
     }
 
-    value = kv_store_client->get(handle, config_char);
     if (value == NULL) {
         LOG_ERROR("Failed to fetch value for the key: %s", config_char);
         goto err;
@@ -2886,6 +3739,41 @@ cfgmgr_ctx_t* cfgmgr_initialize() {
         goto err;
     }
 
+    // Indexing the interfaces by name once, the index owns app_interface
+    iface_index = iface_index_new(app_interface);
+    if (iface_index == NULL) {
+        LOG_ERROR_0("Failed to index the app interfaces");
+        config_destroy(app_interface);
+        goto err;
+    }
+
+    // Snapshotting the env overrides now that GlobalEnv is applied
+    env_overrides = env_overrides_new(0);
+    if (env_overrides == NULL) {
+        LOG_ERROR_0("Failed to snapshot the env overrides");
+        iface_index_free(iface_index);
+        goto err;
+    }
+
+    // Resolving the key material of the msgbus configs once per key
+    // revision in prod mode
+    if (result != 0) {
+        cfg_mgr->key_resolver = cfgmgr_key_resolver_new(kv_store_client, handle);
+        if (cfg_mgr->key_resolver == NULL) {
+            LOG_ERROR_0("Failed to initialize the key resolver");
+            iface_index_free(iface_index);
+            env_overrides_free(env_overrides);
+            goto err;
+        }
+    }
+    if (pthread_mutex_init(&cfg_mgr->iface_mtx, NULL) != 0) {
+        LOG_ERROR_0("Failed to initialize the interfaces mutex");
+        iface_index_free(iface_index);
+        env_overrides_free(env_overrides);
+        cfgmgr_key_resolver_destroy(cfg_mgr->key_resolver);
+        goto err;
+    }
+
     if (c_app_name != NULL) {
         cfg_mgr->app_name = c_app_name;
     }
@@ -2895,9 +3783,9 @@ cfgmgr_ctx_t* cfgmgr_initialize() {
     if (app_config != NULL) {
         cfg_mgr->app_config = app_config;
     }
-    if (app_interface != NULL) {
-        cfg_mgr->app_interface = app_interface;
-    }
+    cfg_mgr->iface_index = iface_index;
+    cfg_mgr->app_interface = app_interface;
+    cfg_mgr->env_overrides = env_overrides;
     if (handle != NULL) {
         cfg_mgr->kv_store_handle = handle;
     }
@@ -2908,20 +3796,95 @@ cfgmgr_ctx_t* cfgmgr_initialize() {
     // Assigining this to NULL as its currently not being used
     cfg_mgr->data_store = NULL;
 
+    // Keeping the interfaces index up to date with the kv store
+    kv_store_client->watch(handle, interface_char, iface_watch_callback, cfg_mgr);
+
+    // The app config read from a snapshot is read again once the snapshot
+    // keys are fetched again, the interfaces follow their watch which
+    // replays the changes made since the snapshot
+    if (snapshot_env != NULL && strlen(snapshot_env) != 0) {
+        kv_store_watch_options_t app_opts = {0};
+        app_opts.lazy_value = true;
+        kv_store_client->watch_events(handle, config_char, &app_opts,
+                                      app_config_reconcile_callback, cfg_mgr);
+    }
+
+    // Memoizing the msgbus configs when CONFIGMGR_MSGBUS_CACHE is set to
+    // true, they are rebuilt once the public keys or the app keys change
+    if (is_env_true("CONFIGMGR_MSGBUS_CACHE")) {
+        cfg_mgr->msgbus_cache = (struct cfgmgr_msgbus_cache*) calloc(1, sizeof(struct cfgmgr_msgbus_cache));
+        if (cfg_mgr->msgbus_cache == NULL) {
+            LOG_WARN_0("Failed to initialize the msgbus config cache,"
+                       " continuing without memoizing msgbus configs");
+        }
+    }
+
+    // Watching the public keys and the private key of the app for the
+    // resolved keys and the memoized msgbus configs to follow their
+    // updates, the keys being read from the kv store if a watch fails
+    if (cfg_mgr->key_resolver != NULL || cfg_mgr->msgbus_cache != NULL) {
+        cfg_mgr->key_watches = (struct cfgmgr_key_watch*) calloc(NUM_KEY_WATCHES, sizeof(struct cfgmgr_key_watch));
+        if (cfg_mgr->key_watches == NULL) {
+            LOG_WARN_0("Calloc failed for the watches of the keys, reading the keys from the kv store");
+            pthread_mutex_lock(&cfg_mgr->iface_mtx);
+            key_watch_set_live(cfg_mgr, KEY_WATCH_PUBLIC_KEYS | KEY_WATCH_PRIVATE_KEY, false);
+            pthread_mutex_unlock(&cfg_mgr->iface_mtx);
+        } else {
+            struct cfgmgr_key_watch* public_keys_watch = &cfg_mgr->key_watches[0];
+            public_keys_watch->cfgmgr = cfg_mgr;
+            public_keys_watch->watch = KEY_WATCH_PUBLIC_KEYS;
+            struct cfgmgr_key_watch* private_key_watch = &cfg_mgr->key_watches[1];
+            private_key_watch->cfgmgr = cfg_mgr;
+            private_key_watch->watch = KEY_WATCH_PRIVATE_KEY;
+
+            kv_store_watch_options_t opts = {0};
+            opts.prefix = true;
+            opts.lazy_value = true;
+            if (kv_store_client->watch_events(handle, PUBLIC_KEYS, &opts,
+                                              msgbus_keys_watch_callback, public_keys_watch) != 0) {
+                LOG_WARN("Failed to watch %s, reading the keys from the kv store", PUBLIC_KEYS);
+                pthread_mutex_lock(&cfg_mgr->iface_mtx);
+                key_watch_set_live(cfg_mgr, KEY_WATCH_PUBLIC_KEYS, false);
+                pthread_mutex_unlock(&cfg_mgr->iface_mtx);
+            }
+            opts.prefix = false;
+            init_len = strlen("/") + strlen(c_app_name) + strlen(PRIVATE_KEY) + 1;
+            char* private_key = concat_s(init_len, 3, "/", c_app_name, PRIVATE_KEY);
+            if (private_key == NULL ||
+                    kv_store_client->watch_events(handle, private_key, &opts,
+                                                  msgbus_keys_watch_callback, private_key_watch) != 0) {
+                LOG_WARN("Failed to watch the private key of %s, reading it from the kv store", c_app_name);
+                pthread_mutex_lock(&cfg_mgr->iface_mtx);
+                key_watch_set_live(cfg_mgr, KEY_WATCH_PRIVATE_KEY, false);
+                pthread_mutex_unlock(&cfg_mgr->iface_mtx);
+            }
+            if (private_key != NULL) {
+                free(private_key);
+            }
+        }
+    }
+
     if (config_char != NULL) {
         free(config_char);
     }
     if (interface_char != NULL) {
         free(interface_char);
     }
-    if (interface != NULL) {
-        free(interface);
+    if (app_prefix != NULL) {
+        free(app_prefix);
     }
     if (kv_store_config != NULL) {
         config_destroy(kv_store_config);
     }
-    if (value != NULL) {
-        free(value);
+    for (int i = 0; i < 3; i++) {
+        if (init_views[i].ref != NULL) {
+            kv_store_client->release_view(handle, &init_views[i]);
+        }
+    }
+    // Dropping the prefetched keys, later reads see the changes made to
+    // the kv store since they were fetched
+    if (prefetched) {
+        kv_store_client->prefetch(handle, NULL, 0);
     }
 
     return cfg_mgr;
@@ -2930,17 +3893,19 @@ err:
     if (c_app_name != NULL) {
         free(c_app_name);
     }
-    if (interface != NULL) {
-        free(interface);
-    }
     if (interface_char != NULL) {
         free(interface_char);
     }
+    if (app_prefix != NULL) {
+        free(app_prefix);
+    }
     if (config_char != NULL) {
         free(config_char);
     }
-    if (value != NULL) {
-        free(value);
+    for (int i = 0; i < 3; i++) {
+        if (init_views[i].ref != NULL) {
+            kv_store_client->release_view(handle, &init_views[i]);
+        }
     }
     if (env_var != NULL) {
         free(env_var);
@@ -2960,26 +3925,55 @@ err:
 void cfgmgr_destroy(cfgmgr_ctx_t *cfg_mgr) {
     LOG_DEBUG("In %s function", __func__);
     if (cfg_mgr != NULL) {
+        // kv_store_handle is owned by the kv_store_client, freeing the
+        // client also cancels every watch registered through it
+        if (cfg_mgr->kv_store_client) {
+            kv_client_free(cfg_mgr->kv_store_client);
+        }
+        // No watch callback runs once the client is freed, everything
+        // they read can be freed from now on
         if (cfg_mgr->app_config) {
             config_destroy(cfg_mgr->app_config);
         }
-        if (cfg_mgr->app_interface) {
-            config_destroy(cfg_mgr->app_interface);
+        if (cfg_mgr->snapshot_app_config) {
+            config_destroy(cfg_mgr->snapshot_app_config);
         }
         if (cfg_mgr->data_store) {
             config_destroy(cfg_mgr->data_store);
         }
-        if (cfg_mgr->kv_store_handle) {
-            free(cfg_mgr->kv_store_handle);
-        }
         if (cfg_mgr->app_name) {
             free(cfg_mgr->app_name);
         }
         if (cfg_mgr->env_var) {
             free(cfg_mgr->env_var);
         }
-        if (cfg_mgr->kv_store_client) {
-            kv_client_free(cfg_mgr->kv_store_client);
+        if (cfg_mgr->msgbus_cache) {
+            msgbus_memos_free(cfg_mgr->msgbus_cache->memos);
+            free(cfg_mgr->msgbus_cache);
+        }
+        if (cfg_mgr->key_resolver) {
+            cfgmgr_key_resolver_destroy(cfg_mgr->key_resolver);
+        }
+        while (cfg_mgr->replaced_iface_indexes != NULL) {
+            struct cfgmgr_iface_index* replaced = cfg_mgr->replaced_iface_indexes;
+            cfg_mgr->replaced_iface_indexes = replaced->replaced_next;
+            iface_index_release(replaced);
+        }
+        if (cfg_mgr->iface_index) {
+            iface_index_release(cfg_mgr->iface_index);
+            env_overrides_release(cfg_mgr->env_overrides);
+            pthread_mutex_destroy(&cfg_mgr->iface_mtx);
+        }
+        if (cfg_mgr->key_watches) {
+            free(cfg_mgr->key_watches);
+        }
+        while (cfg_mgr->diff_watches != NULL) {
+            struct cfgmgr_diff_watch* watch = cfg_mgr->diff_watches;
+            cfg_mgr->diff_watches = watch->next;
+            if (watch->previous != NULL) {
+                config_destroy(watch->previous);
+            }
+            free(watch);
         }
         free(cfg_mgr);
     }
@@ -2997,6 +3991,7 @@ void cfgmgr_interface_destroy(cfgmgr_interface_t *cfg_mgr_interface) {
         if (cfg_mgr_interface->interface) {
             config_value_destroy(cfg_mgr_interface->interface);
         }
+        iface_index_release(cfg_mgr_interface->iface_index);
         free(cfg_mgr_interface);
     }
     LOG_DEBUG_0("cfgmgr_interface_t destroy: Done");
@@ -0,0 +1,415 @@
+// Copyright (c) 2021 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @file
+ * @brief Key material resolver implementation
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <eii/utils/logger.h>
+#include <eii/utils/config.h>
+#include "eii/config_manager/cfgmgr_key_resolver.h"
+
+#include <safe_lib.h>
+
+struct cfgmgr_key {
+    // Key, or key prefix, the values were read from
+    char* name;
+    bool prefix;
+
+    char** values;
+    size_t num_values;
+
+    // References held by the resolver and the callers, guarded by
+    // key_refs_mtx as keys may outlive their resolver
+    int refs;
+
+    struct cfgmgr_key* next;
+};
+
+struct cfgmgr_key_resolver {
+    // Client and handle the keys are read with
+    kv_store_client_t* kv_store_client;
+    void* handle;
+
+    // Guards every member below
+    pthread_mutex_t mtx;
+    cfgmgr_key_t* keys;
+
+    // Bumped on every invalidation, a key read from the kv store is only
+    // kept if the keys were not invalidated while it was being read
+    uint64_t generation;
+
+    // Cleared while the changes of the keys may be missed, every key then
+    // being read from the kv store
+    bool enabled;
+
+    cfgmgr_key_stats_t stats;
+};
+
+static pthread_mutex_t key_refs_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+static char* key_strdup(const char* src) {
+    size_t len = strlen(src) + 1;
+    char* dest = (char*) malloc(len);
+    if (dest == NULL) {
+        LOG_ERROR_0("Failed to allocate memory");
+        return NULL;
+    }
+    if (strcpy_s(dest, len, src) != 0) {
+        LOG_ERROR_0("Failed to copy the key");
+        free(dest);
+        return NULL;
+    }
+    return dest;
+}
+
+static void key_free(cfgmgr_key_t* key) {
+    for (size_t i = 0; i < key->num_values; i++) {
+        free(key->values[i]);
+    }
+    free(key->values);
+    free(key->name);
+    free(key);
+}
+
+// Creates a key holding one reference, taking ownership of values
+static cfgmgr_key_t* key_new(const char* name, bool prefix, char** values, size_t num_values) {
+    cfgmgr_key_t* key = (cfgmgr_key_t*) calloc(1, sizeof(cfgmgr_key_t));
+    if (key == NULL) {
+        LOG_ERROR_0("Calloc failed for the resolved key");
+        goto err;
+    }
+    key->name = key_strdup(name);
+    if (key->name == NULL) {
+        goto err;
+    }
+    key->prefix = prefix;
+    key->values = values;
+    key->num_values = num_values;
+    key->refs = 1;
+    return key;
+
+err:
+    for (size_t i = 0; i < num_values; i++) {
+        free(values[i]);
+    }
+    free(values);
+    if (key != NULL) {
+        free(key);
+    }
+    return NULL;
+}
+
+static void key_acquire(cfgmgr_key_t* key) {
+    pthread_mutex_lock(&key_refs_mtx);
+    key->refs++;
+    pthread_mutex_unlock(&key_refs_mtx);
+}
+
+// Looks up a resolved key, returning a reference to it. Sets generation
+// to the generation a key missing must be read in
+static cfgmgr_key_t* key_lookup(cfgmgr_key_resolver_t* resolver, const char* name, bool prefix,
+                                uint64_t* generation) {
+    pthread_mutex_lock(&resolver->mtx);
+    cfgmgr_key_t* key = resolver->enabled ? resolver->keys : NULL;
+    for (; key != NULL; key = key->next) {
+        if (key->prefix == prefix && strcmp(key->name, name) == 0) {
+            key_acquire(key);
+            resolver->stats.fetches_saved++;
+            break;
+        }
+    }
+    *generation = resolver->generation;
+    pthread_mutex_unlock(&resolver->mtx);
+    return key;
+}
+
+// Keeps a key read from the kv store in the given generation, unless the
+// keys were invalidated or it was resolved concurrently meanwhile
+static void key_insert(cfgmgr_key_resolver_t* resolver, cfgmgr_key_t* key, uint64_t generation) {
+    pthread_mutex_lock(&resolver->mtx);
+    if (resolver->enabled && generation == resolver->generation) {
+        cfgmgr_key_t* existing = resolver->keys;
+        while (existing != NULL &&
+                (existing->prefix != key->prefix || strcmp(existing->name, key->name) != 0)) {
+            existing = existing->next;
+        }
+        if (existing == NULL) {
+            key_acquire(key);
+            key->next = resolver->keys;
+            resolver->keys = key;
+        }
+    }
+    pthread_mutex_unlock(&resolver->mtx);
+}
+
+// Counts the reads forwarded to the kv store
+static void key_count_fetches(cfgmgr_key_resolver_t* resolver, size_t fetches) {
+    pthread_mutex_lock(&resolver->mtx);
+    resolver->stats.fetches += fetches;
+    pthread_mutex_unlock(&resolver->mtx);
+}
+
+// Creates a key of a single value read from the kv store, taking
+// ownership of value
+static cfgmgr_key_t* key_new_value(const char* name, char* value) {
+    char** values = (char**) malloc(sizeof(char*));
+    if (values == NULL) {
+        LOG_ERROR_0("Malloc failed for the resolved key");
+        free(value);
+        return NULL;
+    }
+    values[0] = value;
+    return key_new(name, false, values, 1);
+}
+
+cfgmgr_key_resolver_t* cfgmgr_key_resolver_new(kv_store_client_t* kv_store_client, void* handle) {
+    cfgmgr_key_resolver_t* resolver = (cfgmgr_key_resolver_t*) calloc(1, sizeof(cfgmgr_key_resolver_t));
+    if (resolver == NULL) {
+        LOG_ERROR_0("Calloc failed for the key resolver");
+        return NULL;
+    }
+    if (pthread_mutex_init(&resolver->mtx, NULL) != 0) {
+        LOG_ERROR_0("Failed to initialize the key resolver mutex");
+        free(resolver);
+        return NULL;
+    }
+    resolver->kv_store_client = kv_store_client;
+    resolver->handle = handle;
+    resolver->enabled = true;
+    return resolver;
+}
+
+cfgmgr_key_t* cfgmgr_key_resolve(cfgmgr_key_resolver_t* resolver, const char* key) {
+    uint64_t generation;
+    cfgmgr_key_t* resolved = key_lookup(resolver, key, false, &generation);
+    if (resolved != NULL) {
+        return resolved;
+    }
+    key_count_fetches(resolver, 1);
+    char* value = resolver->kv_store_client->get(resolver->handle, (char*) key);
+    if (value == NULL) {
+        return NULL;
+    }
+    resolved = key_new_value(key, value);
+    if (resolved != NULL) {
+        key_insert(resolver, resolved, generation);
+    }
+    return resolved;
+}
+
+bool cfgmgr_key_resolve_many(cfgmgr_key_resolver_t* resolver, char** keys, size_t num_keys,
+                             cfgmgr_key_t** resolved) {
+    uint64_t generation = 0;
+    size_t num_missing = 0;
+    char** values = NULL;
+    char** missing = (char**) calloc(num_keys, sizeof(char*));
+    size_t* missing_idx = (size_t*) calloc(num_keys, sizeof(size_t));
+    if (missing == NULL || missing_idx == NULL) {
+        LOG_ERROR_0("Calloc failed for the keys to be resolved");
+        goto err;
+    }
+    for (size_t i = 0; i < num_keys; i++) {
+        // The generation of the last lookup is the one every key missing
+        // is read in, a key invalidated in between is not kept
+        resolved[i] = key_lookup(resolver, keys[i], false, &generation);
+        if (resolved[i] == NULL) {
+            missing[num_missing] = keys[i];
+            missing_idx[num_missing] = i;
+            num_missing++;
+        }
+    }
+    if (num_missing > 0) {
+        key_count_fetches(resolver, num_missing);
+        values = resolver->kv_store_client->get_many(resolver->handle, missing, num_missing);
+        if (values == NULL) {
+            LOG_ERROR_0("Failed to read the keys to be resolved");
+            goto err;
+        }
+        for (size_t i = 0; i < num_missing; i++) {
+            if (values[i] == NULL) {
+                continue;
+            }
+            cfgmgr_key_t* key = key_new_value(missing[i], values[i]);
+            if (key == NULL) {
+                // The values left are freed below
+                values[i] = NULL;
+                goto err;
+            }
+            key_insert(resolver, key, generation);
+            resolved[missing_idx[i]] = key;
+            values[i] = NULL;
+        }
+        free(values);
+    }
+    free(missing);
+    free(missing_idx);
+    return true;
+
+err:
+    if (values != NULL) {
+        for (size_t i = 0; i < num_missing; i++) {
+            free(values[i]);
+        }
+        free(values);
+    }
+    if (missing_idx != NULL) {
+        for (size_t i = 0; i < num_keys; i++) {
+            cfgmgr_key_release(resolved[i]);
+            resolved[i] = NULL;
+        }
+    }
+    free(missing);
+    free(missing_idx);
+    return false;
+}
+
+cfgmgr_key_t* cfgmgr_key_resolve_prefix(cfgmgr_key_resolver_t* resolver, const char* prefix) {
+    uint64_t generation;
+    char** values = NULL;
+    size_t num_values = 0;
+    cfgmgr_key_t* resolved = key_lookup(resolver, prefix, true, &generation);
+    if (resolved != NULL) {
+        return resolved;
+    }
+    key_count_fetches(resolver, 1);
+    config_value_t* cvt = (config_value_t*) resolver->kv_store_client->get_prefix(resolver->handle,
+                                                                                  (char*) prefix);
+    if (cvt == NULL) {
+        LOG_ERROR("Failed to read the keys under %s", prefix);
+        return NULL;
+    }
+    size_t len = config_value_array_len(cvt);
+    if (len > 0) {
+        values = (char**) calloc(len, sizeof(char*));
+        if (values == NULL) {
+            LOG_ERROR_0("Calloc failed for the resolved keys");
+            goto err;
+        }
+    }
+    for (size_t i = 0; i < len; i++) {
+        config_value_t* value = config_value_array_get(cvt, i);
+        if (value == NULL) {
+            LOG_ERROR("Failed to read the value %zu under %s", i, prefix);
+            goto err;
+        }
+        if (value->type == CVT_STRING && value->body.string != NULL) {
+            values[num_values] = key_strdup(value->body.string);
+            if (values[num_values] == NULL) {
+                config_value_destroy(value);
+                goto err;
+            }
+            num_values++;
+        }
+        config_value_destroy(value);
+    }
+    config_value_destroy(cvt);
+
+    resolved = key_new(prefix, true, values, num_values);
+    if (resolved != NULL) {
+        key_insert(resolver, resolved, generation);
+    }
+    return resolved;
+
+err:
+    for (size_t i = 0; i < num_values; i++) {
+        free(values[i]);
+    }
+    free(values);
+    config_value_destroy(cvt);
+    return NULL;
+}
+
+const char* cfgmgr_key_value(const cfgmgr_key_t* key) {
+    return (key->num_values > 0) ? key->values[0] : NULL;
+}
+
+const char* const* cfgmgr_key_values(const cfgmgr_key_t* key, size_t* num_values) {
+    *num_values = key->num_values;
+    return (const char* const*) key->values;
+}
+
+void cfgmgr_key_release(cfgmgr_key_t* key) {
+    if (key == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&key_refs_mtx);
+    bool released = (--key->refs == 0);
+    pthread_mutex_unlock(&key_refs_mtx);
+    if (released) {
+        key_free(key);
+    }
+}
+
+// Detaches the resolved keys, the caller releasing them
+static cfgmgr_key_t* key_detach_all(cfgmgr_key_resolver_t* resolver) {
+    pthread_mutex_lock(&resolver->mtx);
+    cfgmgr_key_t* keys = resolver->keys;
+    resolver->keys = NULL;
+    resolver->generation++;
+    pthread_mutex_unlock(&resolver->mtx);
+    return keys;
+}
+
+static void key_release_all(cfgmgr_key_t* keys) {
+    while (keys != NULL) {
+        cfgmgr_key_t* next = keys->next;
+        cfgmgr_key_release(keys);
+        keys = next;
+    }
+}
+
+void cfgmgr_key_resolver_invalidate(cfgmgr_key_resolver_t* resolver) {
+    cfgmgr_key_t* keys = key_detach_all(resolver);
+    pthread_mutex_lock(&resolver->mtx);
+    resolver->stats.invalidations++;
+    pthread_mutex_unlock(&resolver->mtx);
+    key_release_all(keys);
+}
+
+void cfgmgr_key_resolver_set_enabled(cfgmgr_key_resolver_t* resolver, bool enabled) {
+    // Keys read before the change are not kept either way
+    pthread_mutex_lock(&resolver->mtx);
+    cfgmgr_key_t* keys = resolver->keys;
+    resolver->keys = NULL;
+    resolver->generation++;
+    resolver->enabled = enabled;
+    pthread_mutex_unlock(&resolver->mtx);
+    key_release_all(keys);
+}
+
+void cfgmgr_key_resolver_get_stats(cfgmgr_key_resolver_t* resolver, cfgmgr_key_stats_t* stats) {
+    pthread_mutex_lock(&resolver->mtx);
+    *stats = resolver->stats;
+    pthread_mutex_unlock(&resolver->mtx);
+}
+
+void cfgmgr_key_resolver_destroy(cfgmgr_key_resolver_t* resolver) {
+    if (resolver == NULL) {
+        return;
+    }
+    key_release_all(key_detach_all(resolver));
+    pthread_mutex_destroy(&resolver->mtx);
+    free(resolver);
+}
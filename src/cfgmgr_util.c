@@ -26,12 +26,13 @@
 #include <stdarg.h>
 #include <cjson/cJSON.h>
 #include "eii/config_manager/cfgmgr_util.h"
+#include "eii/config_manager/kv_store_plugin/kv_store_lazy_config.h"
 
 #define MAX_CONFIG_KEY_LENGTH 250
 
 // Helper function to convert config_t object to char*
 char* configt_to_char(config_t* config) {
-    cJSON* temp = (cJSON*)config->cfg;
+    cJSON* temp = (cJSON*)kv_store_lazy_config_json(config);
     if(temp == NULL) {
         LOG_ERROR_0("cJSON temp object is NULL");
         return NULL;
@@ -458,119 +459,157 @@ char* cvt_obj_str_to_char(config_value_t* cvt){
     return value;
 }
 
-bool construct_tcp_publisher_prod(char* app_name, config_t* c_json, config_t* inner_json, void* handle, config_value_t* config, kv_store_client_t* kv_store_client){
+bool add_allowed_clients_keys(config_t* c_json, config_value_t* allowed_clients, cfgmgr_key_resolver_t* key_resolver) {
     bool ret_val = false;
-    config_value_t* value = NULL;
-    config_value_t* publish_json_clients = NULL;
-    config_value_t* pub_key_values = NULL;
-    config_value_t* array_value = NULL;
-    char* grab_public_key = NULL;
-    char* sub_public_key = NULL;
     config_value_t* temp_array_value = NULL;
-    char* publisher_secret_key = NULL;
-    char* pub_pri_key = NULL;
+    config_value_t* array_value = NULL;
+    cfgmgr_key_t* all_keys = NULL;
+    cfgmgr_key_t** client_keys = NULL;
+    char** key_names = NULL;
+    const char** all_clients = NULL;
     config_t* all_clients_arr_config = NULL;
-    config_value_t* publisher_secret_key_cvt = NULL;
     config_value_t* all_clients_arr = NULL;
-    char **all_clients = NULL;
-
-    publish_json_clients = config_value_object_get(config, ALLOWED_CLIENTS);
-    if (publish_json_clients == NULL) {
-        LOG_ERROR_0("publish_json_clients initialization failed");
-        goto err;
-    }
+    size_t num_clients = 0;
 
     // Checking if Allowed clients is empty string
-    if (config_value_array_len(publish_json_clients) == 0) {
+    size_t arr_len = config_value_array_len(allowed_clients);
+    if (arr_len == 0) {
         LOG_ERROR_0("Empty String is not supported in AllowedClients. Atleast one allowed clients is required");
         goto err;
     }
 
     // Fetch the first item in allowed_clients
-    temp_array_value = config_value_array_get(publish_json_clients, 0);
-    if (temp_array_value == NULL) {
+    temp_array_value = config_value_array_get(allowed_clients, 0);
+    if (temp_array_value == NULL || temp_array_value->body.string == NULL) {
         LOG_ERROR_0("temp_array_value initialization failed");
         goto err;
     }
     int result;
     strcmp_s(temp_array_value->body.string, strlen(temp_array_value->body.string), "*", &result);
 
-    size_t arr_len = config_value_array_len(publish_json_clients);
-    if (arr_len == 0) {
-        LOG_ERROR_0("Empty array is not supported, atleast one value should be given.");
-        goto err;
-    }
-
     // If only one item in allowed_clients and it is *
     // Add all available Publickeys
     if ((arr_len == 1) && (result == 0)) {
-        pub_key_values = kv_store_client->get_prefix(handle, "/Publickeys/");
-        if (pub_key_values == NULL) {
+        all_keys = cfgmgr_key_resolve_prefix(key_resolver, PUBLIC_KEYS);
+        if (all_keys == NULL) {
             LOG_ERROR_0("pub_key_values initialization failed");
             goto err;
         }
-        bool config_set_result = config_set(c_json, "allowed_clients", pub_key_values);
-        if (!config_set_result) {
-            LOG_ERROR("Unable to set config value");
-        }
+        all_clients_arr_config = json_config_new_array(cfgmgr_key_values(all_keys, &num_clients), num_clients);
     } else {
-        arr_len = config_value_array_len(publish_json_clients);
-        if (arr_len == 0) {
-            LOG_ERROR_0("Empty array is not supported, atleast one value should be given.");
-        }
-        all_clients = (char**)calloc(arr_len, sizeof(char*));
-        if (all_clients == NULL) {
+        all_clients = (const char**)calloc(arr_len, sizeof(char*));
+        key_names = (char**)calloc(arr_len, sizeof(char*));
+        client_keys = (cfgmgr_key_t**)calloc(arr_len, sizeof(cfgmgr_key_t*));
+        if (all_clients == NULL || key_names == NULL || client_keys == NULL) {
             LOG_ERROR_0("all_clients initialization failed");
             goto err;
         }
-        for (int i =0; i < arr_len; i++) {
-            // Fetching individual public keys of all AllowedClients
-            array_value = config_value_array_get(publish_json_clients, i);
-            if (array_value == NULL) {
+        for (size_t i = 0; i < arr_len; i++) {
+            array_value = config_value_array_get(allowed_clients, i);
+            if (array_value == NULL || array_value->body.string == NULL) {
                 LOG_ERROR_0("array_value initialization failed");
                 goto err;
             }
             size_t init_len = strlen(PUBLIC_KEYS) + strlen(array_value->body.string) + 2;
-            grab_public_key = concat_s(init_len, 2, PUBLIC_KEYS, array_value->body.string);
-            if (grab_public_key == NULL) {
+            key_names[i] = concat_s(init_len, 2, PUBLIC_KEYS, array_value->body.string);
+            if (key_names[i] == NULL) {
                 LOG_ERROR_0("Concatenation failed for getting public keys");
                 goto err;
             }
-            sub_public_key = kv_store_client->get(handle, grab_public_key);
-            if (sub_public_key == NULL) {
+            config_value_destroy(array_value);
+            array_value = NULL;
+        }
+        // Fetching the public keys of all AllowedClients not resolved yet
+        // in one request
+        if (!cfgmgr_key_resolve_many(key_resolver, key_names, arr_len, client_keys)) {
+            LOG_ERROR_0("Failed to fetch the public keys of AllowedClients");
+            goto err;
+        }
+        size_t num_found = 0;
+        for (size_t i = 0; i < arr_len; i++) {
+            if (client_keys[i] == NULL) {
                 // If any service isn't provisioned, ignore if key not found
-                LOG_DEBUG("Value is not found for the key: %s", grab_public_key);
-                all_clients[i] = NULL;
+                LOG_DEBUG("Value is not found for the key: %s", key_names[i]);
             } else {
-                all_clients[i] = sub_public_key;
-            }
-            // Before Loop iterates, release all allocated mems.
-            if (grab_public_key != NULL) {
-                free(grab_public_key);
-            }
-            if (array_value != NULL) {
-                config_value_destroy(array_value);
+                all_clients[num_found++] = cfgmgr_key_value(client_keys[i]);
             }
         }
+        num_clients = arr_len;
+        all_clients_arr_config = json_config_new_array(all_clients, num_found);
+    }
+    if (all_clients_arr_config == NULL) {
+        LOG_ERROR_0("Failed to create all_clients_arr_config config_t object");
+        goto err;
+    }
 
-        all_clients_arr_config = json_config_new_array(all_clients, arr_len);
-        if (all_clients_arr_config == NULL) {
-            LOG_ERROR_0("Failed to create all_clients_arr_config config_t object");
-            goto err;
-        }
+    all_clients_arr = config_value_new_object(all_clients_arr_config->cfg, get_config_value, NULL);
+    if (all_clients_arr == NULL) {
+        LOG_ERROR_0("Unable to create config_value_t all_clients_arr object");
+        goto err;
+    }
+    // Adding all public keys of clients to allowed_clients of config
+    bool config_set_result = config_set(c_json, "allowed_clients", all_clients_arr);
+    if (!config_set_result) {
+        LOG_ERROR_0("Unable to set config value");
+        goto err;
+    }
+    // The array is held by c_json now, only freeing the config wrapper,
+    // all_clients_arr does not free the array it points to
+    free(all_clients_arr_config);
+    all_clients_arr_config = NULL;
 
-        all_clients_arr = config_value_new_object(all_clients_arr_config->cfg, get_config_value, NULL);
-        if (all_clients_arr == NULL) {
-            LOG_ERROR_0("Unable to create config_value_t all_clients_arr object");
-            goto err;
+    // We should add all success-path code above this line.
+    ret_val = true;
+
+    err:
+        if (temp_array_value != NULL) {
+            config_value_destroy(temp_array_value);
         }
-        // Adding all public keys of clients to allowed_clients of config
-        bool config_set_result = config_set(c_json, "allowed_clients", all_clients_arr);
-        if (!config_set_result) {
-            LOG_ERROR("Unable to set config value");
-            goto err;
+        if (array_value != NULL) {
+            config_value_destroy(array_value);
+        }
+        if (all_clients_arr != NULL) {
+            config_value_destroy(all_clients_arr);
         }
+        if (all_clients_arr_config != NULL) {
+            config_destroy(all_clients_arr_config);
+        }
+        cfgmgr_key_release(all_keys);
+        if (client_keys != NULL) {
+            for (size_t i = 0; i < num_clients; i++) {
+                cfgmgr_key_release(client_keys[i]);
+            }
+            free(client_keys);
+        }
+        if (key_names != NULL) {
+            for (size_t i = 0; i < arr_len; i++) {
+                free(key_names[i]);
+            }
+            free(key_names);
+        }
+        if (all_clients != NULL) {
+            free(all_clients);
+        }
+        return ret_val;
+}
+
+bool construct_tcp_publisher_prod(char* app_name, config_t* c_json, config_t* inner_json, cfgmgr_key_resolver_t* key_resolver, config_value_t* config) {
+    bool ret_val = false;
+    config_value_t* publish_json_clients = NULL;
+    cfgmgr_key_t* publisher_secret_key = NULL;
+    char* pub_pri_key = NULL;
+    config_value_t* publisher_secret_key_cvt = NULL;
+
+    publish_json_clients = config_value_object_get(config, ALLOWED_CLIENTS);
+    if (publish_json_clients == NULL) {
+        LOG_ERROR_0("publish_json_clients initialization failed");
+        goto err;
+    }
+    if (!add_allowed_clients_keys(c_json, publish_json_clients, key_resolver)) {
+        LOG_ERROR_0("Failed to add the public keys of AllowedClients");
+        goto err;
     }
+
     // Fetching Publisher private key & adding it to zmq_tcp_publish object
     size_t init_len = strlen("/") + strlen(app_name) + strlen(PRIVATE_KEY) + 2;
     pub_pri_key = concat_s(init_len, 3, "/", app_name, PRIVATE_KEY);
@@ -578,13 +617,13 @@ bool construct_tcp_publisher_prod(char* app_name, config_t* c_json, config_t* in
         LOG_ERROR_0("Concatenation failed for getting private keys");
         goto err;
     }
-    publisher_secret_key = kv_store_client->get(handle, pub_pri_key);
+    publisher_secret_key = cfgmgr_key_resolve(key_resolver, pub_pri_key);
     if (publisher_secret_key == NULL) {
         LOG_ERROR("Value is not found for the key: %s", pub_pri_key);
         goto err;
     }
 
-    publisher_secret_key_cvt = config_value_new_string(publisher_secret_key);
+    publisher_secret_key_cvt = config_value_new_string(cfgmgr_key_value(publisher_secret_key));
     if (publisher_secret_key_cvt == NULL) {
         LOG_ERROR_0("Get publisher_secret_key_cvt failed");
         goto err;
@@ -599,49 +638,24 @@ bool construct_tcp_publisher_prod(char* app_name, config_t* c_json, config_t* in
     ret_val = true;
 
     err:
-        if (temp_array_value != NULL) {
-            config_value_destroy(temp_array_value);
-        }
-        if (value != NULL) {
-            config_value_destroy(value);
-        }
-        if (publisher_secret_key != NULL) {
-            free(publisher_secret_key);
-        }
-        // Only freeing the calloc for all_clients
-        // since overall freeing of all_clients
-        // will be handled by destroying c_json
-        if (all_clients != NULL) {
-            free(all_clients);
-        }
+        cfgmgr_key_release(publisher_secret_key);
         if (pub_pri_key != NULL) {
             free(pub_pri_key);
         }
-        if (sub_public_key != NULL) {
-            free(sub_public_key);
-        }
         if (publish_json_clients != NULL) {
             config_value_destroy(publish_json_clients);
         }
-        if (pub_key_values != NULL) {
-            config_value_destroy(pub_key_values);
-        }
-        if (array_value != NULL) {
-            config_value_destroy(array_value);
-        }
         if (publisher_secret_key_cvt != NULL) {
             config_value_destroy(publisher_secret_key_cvt);
         }
         return ret_val;
 }
 
-bool add_keys_to_config(config_t* sub_topic, char* app_name, kv_store_client_t* kv_store_client, void* handle, config_value_t* publisher_appname, config_value_t* sub_config) {
+bool add_keys_to_config(config_t* sub_topic, char* app_name, cfgmgr_key_resolver_t* key_resolver, config_value_t* publisher_appname, config_value_t* sub_config) {
     bool ret_val = false;
     char* s_sub_pri_key = NULL;
     char* s_sub_public_key = NULL;
-    char* sub_public_key = NULL;
-    char* sub_pri_key = NULL;
-    char* pub_public_key = NULL;
+    cfgmgr_key_t* resolved[3] = {NULL, NULL, NULL};
     bool config_set_result = false;
     config_value_t* sub_pri_key_cvt = NULL;
     config_value_t* pub_public_key_cvt = NULL;
@@ -654,14 +668,37 @@ bool add_keys_to_config(config_t* sub_topic, char* app_name, kv_store_client_t*
         goto err;
     }
 
-    pub_public_key = kv_store_client->get(handle, grab_public_key);
+    init_len = strlen(PUBLIC_KEYS) + strlen(app_name) + 2;
+    s_sub_public_key = concat_s(init_len, 2, PUBLIC_KEYS, app_name);
+    if (s_sub_public_key == NULL){
+        LOG_ERROR_0("Failed to conact PUBLIC_KEYS and AppName");
+        goto err;
+    }
+
+    init_len = strlen("/") + strlen(app_name) + strlen(PRIVATE_KEY) + 2;
+    s_sub_pri_key = concat_s(init_len, 3, "/", app_name, PRIVATE_KEY);
+    if (s_sub_pri_key == NULL){
+        LOG_ERROR_0("Failed to conact /AppName and PRIVATE_KEY");
+        goto err;
+    }
+
+    // Fetching the keys not resolved yet in one request
+    char* keys[] = {grab_public_key, s_sub_public_key, s_sub_pri_key};
+    if (!cfgmgr_key_resolve_many(key_resolver, keys, 3, resolved)) {
+        LOG_ERROR_0("Failed to fetch public and private keys");
+        goto err;
+    }
+    cfgmgr_key_t* pub_public_key = resolved[0];
+    cfgmgr_key_t* sub_public_key = resolved[1];
+    cfgmgr_key_t* sub_pri_key = resolved[2];
+
     if(pub_public_key == NULL){
         LOG_DEBUG("Value is not found for the key: %s", grab_public_key);
     }
 
     if (pub_public_key != NULL) {
         // Adding Publisher public key to config
-        pub_public_key_cvt = config_value_new_string(pub_public_key);
+        pub_public_key_cvt = config_value_new_string(cfgmgr_key_value(pub_public_key));
         if (pub_public_key_cvt == NULL) {
             LOG_ERROR_0("Get pub_public_key_cvt failed");
             goto err;
@@ -674,20 +711,13 @@ bool add_keys_to_config(config_t* sub_topic, char* app_name, kv_store_client_t*
     }
 
     // Adding Subscriber public key to config
-    init_len = strlen(PUBLIC_KEYS) + strlen(app_name) + 2;
-    s_sub_public_key = concat_s(init_len, 2, PUBLIC_KEYS, app_name);
-    if (s_sub_public_key == NULL){
-        LOG_ERROR_0("Failed to conact PUBLIC_KEYS and AppName");
-        goto err;
-    }
-    sub_public_key = kv_store_client->get(handle, s_sub_public_key);
     if(sub_public_key == NULL){
         LOG_ERROR("Value is not found for applications own public key: %s", s_sub_public_key);
         ret_val=false;
         goto err;
     }
 
-    sub_public_key_cvt = config_value_new_string(sub_public_key);
+    sub_public_key_cvt = config_value_new_string(cfgmgr_key_value(sub_public_key));
     if (sub_public_key_cvt == NULL) {
         LOG_ERROR_0("Get sub_public_key_cvt failed");
         goto err;
@@ -699,20 +729,12 @@ bool add_keys_to_config(config_t* sub_topic, char* app_name, kv_store_client_t*
     }
 
     // Adding Subscriber private key to config
-    init_len = strlen("/") + strlen(app_name) + strlen(PRIVATE_KEY) + 2;
-    s_sub_pri_key = concat_s(init_len, 3, "/", app_name, PRIVATE_KEY);
-    if (s_sub_pri_key == NULL){
-        LOG_ERROR_0("Failed to conact /AppName and PRIVATE_KEY");
-        goto err;
-    }
-
-    sub_pri_key = kv_store_client->get(handle, s_sub_pri_key);
     if(sub_pri_key == NULL){
         LOG_ERROR("Value is not found for applications own private key: %s", s_sub_pri_key);
         goto err;
     }
 
-    sub_pri_key_cvt = config_value_new_string(sub_pri_key);
+    sub_pri_key_cvt = config_value_new_string(cfgmgr_key_value(sub_pri_key));
     if (sub_pri_key_cvt == NULL) {
         LOG_ERROR_0("Get sub_pri_key_cvt failed");
         goto err;
@@ -735,14 +757,8 @@ bool add_keys_to_config(config_t* sub_topic, char* app_name, kv_store_client_t*
         if(s_sub_pri_key != NULL) {
             free(s_sub_pri_key);
         }
-        if(pub_public_key != NULL) {
-            free(pub_public_key);
-        }
-        if(sub_public_key != NULL) {
-            free(sub_public_key);
-        }
-        if(sub_pri_key != NULL) {
-            free(sub_pri_key);
+        for (int i = 0; i < 3; i++) {
+            cfgmgr_key_release(resolved[i]);
         }
         if (pub_public_key_cvt != NULL){
             config_value_destroy(pub_public_key_cvt);
@@ -756,3 +772,189 @@ bool add_keys_to_config(config_t* sub_topic, char* app_name, kv_store_client_t*
 
     return ret_val;
 }
+
+// Appends path to the list of paths, which takes ownership of it
+static bool diff_append(char*** paths, size_t* num_paths, char* path) {
+    char** resized = (char**)realloc(*paths, (*num_paths + 1) * sizeof(char*));
+    if (resized == NULL) {
+        LOG_ERROR_0("Failed to grow the list of changed paths");
+        free(path);
+        return false;
+    }
+    resized[*num_paths] = path;
+    *paths = resized;
+    (*num_paths)++;
+    return true;
+}
+
+// Returns the JSON pointer of the member name of path, '~' and '/' escaped
+static char* diff_member_path(const char* path, const char* name) {
+    size_t path_len = strlen(path);
+    size_t len = path_len + 2;
+    for (const char* c = name; *c != '\0'; c++) {
+        len += (*c == '~' || *c == '/') ? 2 : 1;
+    }
+    char* member_path = (char*)malloc(len);
+    if (member_path == NULL) {
+        LOG_ERROR_0("Malloc failed for member path");
+        return NULL;
+    }
+    strcpy_s(member_path, len, path);
+    char* out = member_path + path_len;
+    *out++ = '/';
+    for (const char* c = name; *c != '\0'; c++) {
+        if (*c == '~') {
+            *out++ = '~';
+            *out++ = '0';
+        } else if (*c == '/') {
+            *out++ = '~';
+            *out++ = '1';
+        } else {
+            *out++ = *c;
+        }
+    }
+    *out = '\0';
+    return member_path;
+}
+
+// Returns the JSON pointer of the element index of path
+static char* diff_element_path(const char* path, int index) {
+    char name[16];
+    snprintf(name, sizeof(name), "%d", index);
+    return diff_member_path(path, name);
+}
+
+// Records path in paths, path is freed on failure
+static bool diff_record(char*** paths, size_t* num_paths, char* path) {
+    if (path == NULL) {
+        return false;
+    }
+    return diff_append(paths, num_paths, path);
+}
+
+// Compares previous and current found at path, recursing into the members
+// of objects and the elements of arrays
+static bool diff_json(const cJSON* previous, const cJSON* current, const char* path,
+                      cfgmgr_config_diff_t* diff) {
+    bool ret = true;
+    char* child_path = NULL;
+
+    if (cJSON_IsObject(previous) && cJSON_IsObject(current)) {
+        const cJSON* prev_item = NULL;
+        const cJSON* cur_item = NULL;
+        cJSON_ArrayForEach(prev_item, previous) {
+            cur_item = cJSON_GetObjectItemCaseSensitive(current, prev_item->string);
+            child_path = diff_member_path(path, prev_item->string);
+            if (child_path == NULL) {
+                return false;
+            }
+            if (cur_item == NULL) {
+                ret = diff_append(&diff->removed, &diff->num_removed, child_path);
+            } else {
+                ret = diff_json(prev_item, cur_item, child_path, diff);
+                free(child_path);
+            }
+            if (!ret) {
+                return false;
+            }
+        }
+        cJSON_ArrayForEach(cur_item, current) {
+            if (cJSON_GetObjectItemCaseSensitive(previous, cur_item->string) == NULL) {
+                if (!diff_record(&diff->added, &diff->num_added,
+                                 diff_member_path(path, cur_item->string))) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    if (cJSON_IsArray(previous) && cJSON_IsArray(current)) {
+        const cJSON* prev_item = previous->child;
+        const cJSON* cur_item = current->child;
+        int index = 0;
+        for (; prev_item != NULL && cur_item != NULL; index++) {
+            child_path = diff_element_path(path, index);
+            if (child_path == NULL) {
+                return false;
+            }
+            ret = diff_json(prev_item, cur_item, child_path, diff);
+            free(child_path);
+            if (!ret) {
+                return false;
+            }
+            prev_item = prev_item->next;
+            cur_item = cur_item->next;
+        }
+        for (; prev_item != NULL; prev_item = prev_item->next, index++) {
+            if (!diff_record(&diff->removed, &diff->num_removed, diff_element_path(path, index))) {
+                return false;
+            }
+        }
+        for (; cur_item != NULL; cur_item = cur_item->next, index++) {
+            if (!diff_record(&diff->added, &diff->num_added, diff_element_path(path, index))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    if (!cJSON_Compare(previous, current, true)) {
+        size_t len = strlen(path) + 1;
+        char* changed_path = (char*)malloc(len);
+        if (changed_path == NULL) {
+            LOG_ERROR_0("Malloc failed for changed path");
+            return false;
+        }
+        strcpy_s(changed_path, len, path);
+        return diff_append(&diff->changed, &diff->num_changed, changed_path);
+    }
+    return true;
+}
+
+bool cfgmgr_config_diff(const config_t* previous, const config_t* current, cfgmgr_config_diff_t* diff) {
+    cJSON* empty = NULL;
+    const cJSON* prev_json = NULL;
+    const cJSON* cur_json = NULL;
+    bool ret = false;
+
+    memset(diff, 0, sizeof(cfgmgr_config_diff_t));
+    // A missing configuration compares as an empty object
+    empty = cJSON_CreateObject();
+    if (empty == NULL) {
+        LOG_ERROR_0("Failed to create empty json object");
+        return false;
+    }
+    prev_json = (previous != NULL) ? (const cJSON*)kv_store_lazy_config_json(previous) : empty;
+    cur_json = (current != NULL) ? (const cJSON*)kv_store_lazy_config_json(current) : empty;
+    if (prev_json == NULL || cur_json == NULL) {
+        LOG_ERROR_0("Failed to parse the configuration to diff");
+        cJSON_Delete(empty);
+        return false;
+    }
+    ret = diff_json(prev_json, cur_json, "", diff);
+    if (!ret) {
+        LOG_ERROR_0("Failed to compute the configuration diff");
+        cfgmgr_config_diff_free(diff);
+    }
+    cJSON_Delete(empty);
+    return ret;
+}
+
+// Frees a list of paths
+static void diff_free_paths(char** paths, size_t num_paths) {
+    for (size_t i = 0; i < num_paths; i++) {
+        free(paths[i]);
+    }
+    free(paths);
+}
+
+void cfgmgr_config_diff_free(cfgmgr_config_diff_t* diff) {
+    if (diff == NULL) {
+        return;
+    }
+    diff_free_paths(diff->added, diff->num_added);
+    diff_free_paths(diff->removed, diff->num_removed);
+    diff_free_paths(diff->changed, diff->num_changed);
+    memset(diff, 0, sizeof(cfgmgr_config_diff_t));
+}
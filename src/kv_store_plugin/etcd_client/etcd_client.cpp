@@ -18,6 +18,8 @@
 // FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
 // IN THE SOFTWARE.
 
+#include <algorithm>
+#include <chrono>
 #include <exception>
 #include <thread>
 #include <stdlib.h>
@@ -29,31 +31,83 @@
 
 #define NO_VALUE_ERROR    "CHECK failed: (index) < (current_size_): "
 
+// Deadline of a background fetch of the snapshot keys and the interval
+// between two attempts
+#define SNAPSHOT_FETCH_TIMEOUT_MS   5000
+#define SNAPSHOT_RETRY_INTERVAL_MS  1000
+
+// Interval of the keepalive pings detecting an etcd member gone silent, and
+// how long to wait for their ack before failing over to another member
+#define KEEPALIVE_TIME_MS           10000
+#define KEEPALIVE_TIMEOUT_MS        3000
+
+// Spreads the requests to a member round robin over the addresses its
+// host resolves to, skipping the addresses failing the gRPC health check
+#define CHANNEL_SERVICE_CONFIG \
+    "{\"loadBalancingConfig\": [{\"round_robin\": {}}]," \
+    " \"healthCheckConfig\": {\"serviceName\": \"\"}}"
+
+// Share of a retry refilled in the retry budget by a successful request
+#define RETRY_TOKEN_RATIO           0.1
+
+// Number of keys of a scan_prefix() page when not given
+#define SCAN_DEFAULT_PAGE_SIZE      100
+
+// Memory held by the reused RangeResponse of a thread beyond which it is
+// released after the request instead of being kept for the next one
+#define RANGE_REPLY_KEEP_BYTES      (64 * 1024)
+
 static std::string get_file_contents(const char *fpath) {
   std::ifstream finstream(fpath);
   std::string contents((std::istreambuf_iterator<char>(finstream)), std::istreambuf_iterator<char>());
   return contents;
 }
 
-// Forward declaration of internally used locally defined functions
-void register_watch_loop(char* address, grpc::SslCredentialsOptions ssl_opts,
-                         WatchRequest watch_req, kv_store_watch_callback_t user_callback,
-                         void *user_data);
+/**
+* Returns the RangeResponse reused by the Range requests of the calling
+* thread. Parsing a reply into it reuses the KeyValue entries and string
+* buffers left by the previous request instead of allocating them again
+*/
+static RangeResponse& range_reply() {
+    static thread_local RangeResponse reply;
+    return reply;
+}
+
+/**
+* Lends the reply of range_reply() for the duration of a request. A reply
+* grown past RANGE_REPLY_KEEP_BYTES is released when the request is done,
+* so that a thread does not keep the memory of its largest reply
+*/
+class RangeReplyLease {
+    public:
+        RangeReplyLease() : reply(range_reply()) {}
 
-bool register_watch(char* address, grpc::SslCredentialsOptions ssl_opts,
-                    WatchRequest watch_req, kv_store_watch_callback_t user_callback,
-                    void *user_data);
+        ~RangeReplyLease() {
+            if (reply.SpaceUsedLong() > RANGE_REPLY_KEEP_BYTES) {
+                RangeResponse().Swap(&reply);
+            }
+        }
 
-EtcdClient::EtcdClient(const std::string& host, const std::string& port) {
-    LOG_INFO("Initialize EtcdClient in Dev mode");
-    kv_stub = NULL;
+        RangeResponse& reply;
+};
+
+EtcdClient::EtcdClient(const std::string& host, const std::string& port)
+    : EtcdClient(std::vector<std::string>(1, host + ":" + port)) {
+}
 
-    LOG_DEBUG("host:%s and port:%s", host.c_str(), port.c_str());
-    // TODO: Add port check availability function
-    snprintf(address, ADDRESS_LEN, "%s:%s", host.c_str(), port.c_str());
+EtcdClient::EtcdClient(const std::vector<std::string>& endpoints) {
+    LOG_INFO("Initialize EtcdClient in Dev mode");
+    next_member = 0;
+    prefetched_revision = 0;
+    serializable = false;
+    etcd_retry_policy_default(&retry_policy);
+    retry_tokens = retry_policy.retry_budget;
+    snapshot_loaded = false;
+    watch_start_revision = 0;
+    reconcile_stopping = false;
 
     try {
-        kv_stub = KV::NewStub(grpc::CreateChannel(address, grpc::InsecureChannelCredentials()));
+        create_channel(endpoints, grpc::InsecureChannelCredentials());
     }catch(...) {
         LOG_ERROR("Exception Occurred while creating grpc channel for KV Store");
         throw "KV Channel Creation Failed";
@@ -61,10 +115,21 @@ EtcdClient::EtcdClient(const std::string& host, const std::string& port) {
 }
 
 EtcdClient::EtcdClient(const std::string& host, const std::string& port, const std::string& cert_file,
+                       const std::string& key_file, const std::string ca_file)
+    : EtcdClient(std::vector<std::string>(1, host + ":" + port), cert_file, key_file, ca_file) {
+}
+
+EtcdClient::EtcdClient(const std::vector<std::string>& endpoints, const std::string& cert_file,
                        const std::string& key_file, const std::string ca_file) {
     LOG_INFO("Initialize EtcdClient in Prod mode");
-    LOG_DEBUG("host:%s and port:%s", host.c_str(), port.c_str());
-    snprintf(address, ADDRESS_LEN, "%s:%s", host.c_str(), port.c_str());
+    next_member = 0;
+    prefetched_revision = 0;
+    serializable = false;
+    etcd_retry_policy_default(&retry_policy);
+    retry_tokens = retry_policy.retry_budget;
+    snapshot_loaded = false;
+    watch_start_revision = 0;
+    reconcile_stopping = false;
     const char* croot = ca_file.c_str();
     const char* ckey = key_file.c_str();
     const char* ccert = cert_file.c_str();
@@ -78,13 +143,61 @@ EtcdClient::EtcdClient(const std::string& host, const std::string& port, const s
     ssl_opts.pem_cert_chain = cert_pem;
 
     try {
-        kv_stub = KV::NewStub(grpc::CreateChannel(address, grpc::SslCredentials(ssl_opts)));
+        create_channel(endpoints, grpc::SslCredentials(ssl_opts));
     }catch(...) {
         LOG_ERROR("Exception Occurred while creating grpc channel for KV Store");
         throw "KV Channel Creation Failed";
     }
 }
 
+void EtcdClient::create_channel(const std::vector<std::string>& endpoints,
+                                std::shared_ptr<grpc::ChannelCredentials> creds) {
+    grpc::ChannelArguments args;
+
+    args.SetServiceConfigJSON(CHANNEL_SERVICE_CONFIG);
+    args.SetInt(GRPC_ARG_KEEPALIVE_TIME_MS, KEEPALIVE_TIME_MS);
+    args.SetInt(GRPC_ARG_KEEPALIVE_TIMEOUT_MS, KEEPALIVE_TIMEOUT_MS);
+    // Reconnects to a failed member as often as requests are retried by
+    // default, so that a retry is not failed by a member still backing off
+    args.SetInt(GRPC_ARG_INITIAL_RECONNECT_BACKOFF_MS, ETCD_DEFAULT_INITIAL_BACKOFF_MS);
+    args.SetInt(GRPC_ARG_MAX_RECONNECT_BACKOFF_MS, ETCD_DEFAULT_MAX_BACKOFF_MS);
+
+    // One channel per member, resolved again by gRPC when its addresses
+    // change, and whose server certificate is verified against its host
+    for (size_t i = 0; i < endpoints.size(); i++) {
+        LOG_DEBUG("Connecting to etcd at %s", endpoints[i].c_str());
+        std::shared_ptr<Channel> channel = grpc::CreateCustomChannel(endpoints[i], creds, args);
+        channels.push_back(channel);
+        kv_stubs.push_back(KV::NewStub(channel));
+    }
+    if (channels.empty()) {
+        throw "No etcd endpoint given";
+    }
+    watch_manager.reset(new WatchManager(channels));
+}
+
+KV::Stub* EtcdClient::next_kv_stub() {
+    size_t first = next_member++;
+    size_t fallback = first % channels.size();
+    bool has_fallback = false;
+    for (size_t i = 0; i < channels.size(); i++) {
+        size_t member = (first + i) % channels.size();
+        grpc_connectivity_state state = channels[member]->GetState(true);
+        if (state == GRPC_CHANNEL_READY) {
+            return kv_stubs[member].get();
+        }
+        // A member still connecting may be down, a request sent to it
+        // would wait for its deadline, it is only picked if none is ready
+        if (!has_fallback && state != GRPC_CHANNEL_TRANSIENT_FAILURE) {
+            fallback = member;
+            has_fallback = true;
+        }
+    }
+    // No member is ready, the request reports the failure if every
+    // member is failing
+    return kv_stubs[fallback].get();
+}
+
 /**
 * Sends a get request to the etcd server
 * @param key is the key to be read
@@ -94,9 +207,9 @@ std::string EtcdClient::get(std::string& key) {
     LOG_DEBUG("get value for the key %s", key.c_str());
     mvccpb::KeyValue kvs;
     RangeRequest get_request;
-    RangeResponse reply;
+    RangeReplyLease lease;
+    RangeResponse& reply = lease.reply;
     Status status;
-    ClientContext context;
 
     try {
         char* etcd_prefix = getenv("ETCD_PREFIX");
@@ -108,13 +221,27 @@ std::string EtcdClient::get(std::string& key) {
                 key = prefix + key;
             }
         }
+        {
+            std::lock_guard<std::mutex> lock(prefetch_mtx);
+            if (is_prefetched(key)) {
+                LOG_DEBUG("Serving the key %s from the prefetched keys", key.c_str());
+                std::map<std::string, etcd_value_ref_t>::iterator it = prefetched.find(key);
+                if (it != prefetched.end()) {
+                    kvs.set_value(*it->second);
+                }
+                return kvs.value();
+            }
+        }
         get_request.set_key(key);
-        status = kv_stub->Range(&context,get_request,&reply);
+        get_request.set_serializable(serializable);
+        status = call("get", [&](KV::Stub* kv_stub, ClientContext* context) {
+            return kv_stub->Range(context, get_request, &reply);
+        });
         if (status.ok()) {
             // Check for kvs_size() which is 0
             // in error conditions
             if (reply.kvs_size() != 0) {
-                kvs.CopyFrom(reply.kvs(0));
+                kvs.mutable_value()->swap(*reply.mutable_kvs(0)->mutable_value());
             }
         } else {
             LOG_ERROR("get() API Failed with Error:%s and Error Code: %d",
@@ -135,50 +262,90 @@ std::string EtcdClient::get(std::string& key) {
 }
 
 std::vector<std::string> EtcdClient::get_prefix(std::string& key_prefix) {
+    kv_store_read_options_t opts = {};
+    std::vector<std::string> values;
+
+    get_prefix(key_prefix, opts, values);
+    return values;
+}
+
+int64_t EtcdClient::get_prefix(std::string& key_prefix, const kv_store_read_options_t& opts,
+                               std::vector<std::string>& result) {
     LOG_DEBUG_0("In get_prefix() API");
     LOG_DEBUG("get all values for keys starting from %s", key_prefix.c_str());
-    mvccpb::KeyValue kvs;
     RangeRequest get_request;
-    RangeResponse reply;
+    RangeReplyLease lease;
+    RangeResponse& reply = lease.reply;
     Status status;
-    ClientContext context;
-    std::vector<std::string> values;
-    std::vector<std::string>::iterator it;
-
-    std::string& range_end = key_prefix;
+    size_t prefix_len = 0;
+    int64_t count = 0;
 
+    result.clear();
     try {
         char* etcd_prefix = getenv("ETCD_PREFIX");
         if (etcd_prefix == NULL) {
             LOG_DEBUG_0("ETCD_PREFIX env not set, fetching key without ETCD_PREFIX");
         } else {
-            if (strlen(etcd_prefix) != 0) {
+            prefix_len = strlen(etcd_prefix);
+            if (prefix_len != 0) {
                 std::string prefix(etcd_prefix);
                 key_prefix = prefix + key_prefix;
-                range_end = key_prefix;
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(prefetch_mtx);
+            if (is_prefetched(key_prefix)) {
+                LOG_DEBUG("Serving the prefix %s from the prefetched keys", key_prefix.c_str());
+                std::map<std::string, etcd_value_ref_t>::iterator pit;
+                for (pit = prefetched.lower_bound(key_prefix); pit != prefetched.end(); ++pit) {
+                    if (pit->first.compare(0, key_prefix.length(), key_prefix) != 0) {
+                        break;
+                    }
+                    count++;
+                    if (opts.count_only || (opts.limit > 0 && (int64_t) result.size() >= opts.limit)) {
+                        continue;
+                    }
+                    if (opts.keys_only) {
+                        result.push_back(pit->first.substr(prefix_len));
+                    } else {
+                        result.push_back(*pit->second);
+                    }
+                }
+                return count;
             }
         }
         get_request.set_key(key_prefix);
 
+        std::string range_end = key_prefix;
         int ascii = (int)range_end[range_end.length()-1];
         range_end.back() = ascii+1;
 
         get_request.set_range_end(range_end);
+        get_request.set_keys_only(opts.keys_only);
+        get_request.set_count_only(opts.count_only);
+        get_request.set_limit(opts.limit);
+        get_request.set_serializable(is_serializable(opts.consistency));
 
-        status = kv_stub->Range(&context,get_request,&reply);
+        status = call("get_prefix", [&](KV::Stub* kv_stub, ClientContext* context) {
+            return kv_stub->Range(context, get_request, &reply);
+        });
 
         if (status.ok()) {
-            // Check for kvs_size() which is 0
-            // in error conditions
-            if (reply.kvs_size() != 0) {
-                for(int i=0; i<reply.kvs_size(); i++) {
-                    kvs.CopyFrom(reply.kvs(i));
-                    values.push_back( kvs.value());
+            count = reply.count();
+            // Keys and values are moved out of the reply rather than copied
+            result.resize(reply.kvs_size());
+            for(int i=0; i<reply.kvs_size(); i++) {
+                if (opts.keys_only) {
+                    result[i].swap(*reply.mutable_kvs(i)->mutable_key());
+                    result[i].erase(0, prefix_len);
+                } else {
+                    result[i].swap(*reply.mutable_kvs(i)->mutable_value());
                 }
             }
         } else {
             LOG_ERROR("get() API Failed with Error:%s and Error Code: %d",
                 status.error_message().c_str(), status.error_code());
+            return -1;
         }
     } catch(std::exception const & ex) {
         int no_val_error;
@@ -188,105 +355,482 @@ std::vector<std::string> EtcdClient::get_prefix(std::string& key_prefix) {
         if(no_val_error == 0) {
             LOG_ERROR("Value for the key %s is not found %s", key_prefix.c_str(), ex.what());
         }
+        result.clear();
+        return -1;
     }
 
-    return values;
+    return count;
 }
 
-void register_watch_loop(char* address, grpc::SslCredentialsOptions ssl_opts,
-                         WatchRequest watch_req, kv_store_watch_callback_t user_callback,
-                         void *user_data) {
-    bool watch_registered = true;
-    // Register watch once and check for watch expired conditions
-    // If watch is expired, register it again
-    do {
-        // TODO: We are relying on register_watch returning on error
-        // conditions here, should be replaced with a means to catch
-        // specific error conditions like timeout, socket closed etc.
-        watch_registered = register_watch(address, ssl_opts, watch_req,
-                                          user_callback, user_data);
-        if (!watch_registered) {
-            LOG_DEBUG_0("Watch expired, re-registering...");
+int EtcdClient::scan_prefix(std::string& key_prefix, size_t page_size,
+                            std::function<int(const std::vector<std::string>& keys,
+                                              const std::vector<std::string>& values)> cb) {
+    LOG_DEBUG_0("In scan_prefix() API");
+    LOG_DEBUG("scan all values for keys starting from %s", key_prefix.c_str());
+    // Not the reply of range_reply(), cb may issue reads of its own
+    RangeResponse reply;
+    Status status;
+    std::vector<std::string> keys;
+    std::vector<std::string> values;
+    size_t prefix_len = 0;
+    int64_t revision = 0;
+
+    if (page_size == 0) {
+        page_size = SCAN_DEFAULT_PAGE_SIZE;
+    }
+
+    try {
+        char* etcd_prefix = getenv("ETCD_PREFIX");
+        if (etcd_prefix == NULL) {
+            LOG_DEBUG_0("ETCD_PREFIX env not set, fetching key without ETCD_PREFIX");
+        } else {
+            prefix_len = strlen(etcd_prefix);
+            if (prefix_len != 0) {
+                std::string prefix(etcd_prefix);
+                key_prefix = prefix + key_prefix;
+            }
         }
-    } while (!watch_registered);
-}
 
-bool register_watch(char* address, grpc::SslCredentialsOptions ssl_opts,
-                    WatchRequest watch_req, kv_store_watch_callback_t user_callback, void *user_data) {
-    WatchResponse reply;
-    mvccpb::KeyValue kvs;
-    ClientContext context;
-
-    std::unique_ptr<Watch::Stub> watch_stub;
-
-    if((ssl_opts.pem_root_certs.empty()) && (ssl_opts.pem_private_key.empty()) \
-            && (ssl_opts.pem_cert_chain.empty())) {
-        watch_stub = Watch::NewStub(grpc::CreateChannel(address, grpc::InsecureChannelCredentials()));
-    }else {
-        watch_stub = Watch::NewStub(grpc::CreateChannel(address, grpc::SslCredentials(ssl_opts)));
-    }
-
-    // TODO: make use of AsyncWatch instead of Watch
-    std::unique_ptr<ClientReaderWriter<WatchRequest, WatchResponse> > stream = watch_stub->Watch(&context);
-
-    stream->Write(watch_req);
-
-    // Checking for any changes in key
-    while (stream->Read(&reply)) {
-        if (reply.events_size()) {
-            for (int cnt = 0; cnt < reply.events_size(); cnt++) {
-                auto event = reply.events(cnt);
-                if(mvccpb::Event::EventType::Event_EventType_PUT == event.type())
-                {
-                    kvs = event.kv();
-                    char *kvs_key = const_cast<char*>(kvs.key().c_str());
-                    char *kvs_value = const_cast<char*>(kvs.value().c_str());
-                    LOG_DEBUG("key:%s is updated with the value %s", kvs_key, kvs_value);
-
-                    cJSON* val_json;
-                    // Checking if the value updated is not in Json format
-                    if (kvs_value[0] != '{') {
-                        if(strlen(kvs_value) == 0) {
-                            LOG_ERROR_0("Value shouldn't be empty. Empty string is not supported");
-                            return false;
-                        }
-                        // Creating the cJSON object with Key as kvs_key and value as kvs_value
-                        val_json = cJSON_CreateObject();
-                        if(val_json == NULL){
-                            LOG_ERROR_0("Create json object failed");
-                            return false;
-                        }
-                        cJSON_AddStringToObject(val_json, kvs_key, kvs_value);
-                    } else{
-                        // char* to cJSON conversion
-                        val_json = cJSON_Parse(kvs_value);
-                        if(val_json == NULL){
-                            LOG_ERROR_0("cJSON Parse failed");
-                            return false;
+        std::string range_end = key_prefix;
+        int ascii = (int)range_end[range_end.length()-1];
+        range_end.back() = ascii+1;
+
+        // Each page starts right after the last key of the previous one
+        std::string cursor = key_prefix;
+        bool more = true;
+        while (more) {
+            keys.clear();
+            values.clear();
+            {
+                std::lock_guard<std::mutex> lock(prefetch_mtx);
+                if (is_prefetched(key_prefix)) {
+                    std::map<std::string, etcd_value_ref_t>::iterator pit = prefetched.lower_bound(cursor);
+                    for (; pit != prefetched.end() && pit->first < range_end; ++pit) {
+                        if (keys.size() == page_size) {
+                            break;
                         }
+                        keys.push_back(pit->first.substr(prefix_len));
+                        values.push_back(*pit->second);
                     }
+                    more = (pit != prefetched.end() && pit->first < range_end);
+                    if (more) {
+                        cursor = pit->first;
+                    }
+                }
+            }
+
+            if (keys.empty() && more) {
+                RangeRequest get_request;
+
+                get_request.set_key(cursor);
+                get_request.set_range_end(range_end);
+                get_request.set_limit(page_size);
+                get_request.set_revision(revision);
+                get_request.set_serializable(serializable);
+                status = call("scan_prefix", [&](KV::Stub* kv_stub, ClientContext* context) {
+                    return kv_stub->Range(context, get_request, &reply);
+                });
+                if (!status.ok()) {
+                    LOG_ERROR("scan_prefix() API Failed with Error:%s and Error Code: %d",
+                        status.error_message().c_str(), status.error_code());
+                    return -1;
+                }
+                if (revision == 0) {
+                    revision = reply.header().revision();
+                }
+
+                keys.resize(reply.kvs_size());
+                values.resize(reply.kvs_size());
+                for (int i = 0; i < reply.kvs_size(); i++) {
+                    keys[i].swap(*reply.mutable_kvs(i)->mutable_key());
+                    values[i].swap(*reply.mutable_kvs(i)->mutable_value());
+                }
+                more = reply.more() && !keys.empty();
+                if (more) {
+                    cursor = keys.back();
+                    cursor.push_back('\0');
+                }
+                for (size_t i = 0; i < keys.size(); i++) {
+                    keys[i].erase(0, prefix_len);
+                }
+            }
+
+            if (!keys.empty() && cb(keys, values) != 0) {
+                LOG_DEBUG("scan of the prefix %s stopped by the callback", key_prefix.c_str());
+                break;
+            }
+        }
+    } catch(std::exception const & ex) {
+        LOG_ERROR("Exception Occurred in scan_prefix() API with the Error: %s", ex.what());
+        return -1;
+    }
+
+    return 0;
+}
 
-                    // cJSON to config_t conversion
-                    config_t* config = config_new(
-                        (void*) val_json, free_json, get_config_value, set_config_value);
-                    if (config == NULL) {
-                        cJSON_Delete(val_json);
-                        config_destroy(config);
-                        LOG_ERROR_0("Failed to initialize configuration object");
-                        return false;
+/**
+* Sends a single Txn request with one RangeRequest per key to the etcd server
+* @param keys are the keys to be read
+*/
+std::vector<std::string> EtcdClient::get_many(std::vector<std::string>& keys) {
+    LOG_DEBUG_0("In get_many() API");
+    std::vector<etcd_value_ref_t> refs = get_view(keys);
+    std::vector<std::string> values;
+    for (size_t i = 0; i < refs.size(); i++) {
+        if (refs[i] != NULL) {
+            values.push_back(*refs[i]);
+        } else {
+            values.push_back("(NULL)");
+        }
+    }
+    return values;
+}
+
+/**
+* Reads the keys like get_many() without copying their values
+* @param keys are the keys to be read
+* @param revision if not NULL, filled with the revision the keys were read at
+*/
+std::vector<etcd_value_ref_t> EtcdClient::get_view(std::vector<std::string>& keys, int64_t* revision) {
+    LOG_DEBUG_0("In get_view() API");
+    LOG_DEBUG("get values for %d keys", (int) keys.size());
+    TxnRequest txn_request;
+    // Shared with the returned values, which point into it
+    std::shared_ptr<TxnResponse> reply(new TxnResponse());
+    Status status;
+    std::vector<etcd_value_ref_t> values;
+
+    try {
+        char* etcd_prefix = getenv("ETCD_PREFIX");
+        if (etcd_prefix == NULL) {
+            LOG_DEBUG_0("ETCD_PREFIX env not set, fetching keys without ETCD_PREFIX");
+        }
+        // Keys not served from the prefetched keys, by index into keys
+        std::vector<size_t> remote;
+        values.resize(keys.size());
+        int64_t local_revision = 0;
+        {
+            std::lock_guard<std::mutex> lock(prefetch_mtx);
+            local_revision = prefetched_revision;
+            for (size_t i = 0; i < keys.size(); i++) {
+                if (etcd_prefix != NULL && strlen(etcd_prefix) != 0) {
+                    std::string prefix(etcd_prefix);
+                    keys[i] = prefix + keys[i];
+                }
+                if (is_prefetched(keys[i])) {
+                    std::map<std::string, etcd_value_ref_t>::iterator it = prefetched.find(keys[i]);
+                    if (it != prefetched.end()) {
+                        values[i] = it->second;
                     }
-                    user_callback(kvs_key, config, user_data);
+                } else {
+                    remote.push_back(i);
                 }
             }
         }
+        if (remote.empty()) {
+            LOG_DEBUG_0("All keys served from the prefetched keys");
+            if (revision != NULL) {
+                *revision = local_revision;
+            }
+            return values;
+        }
+
+        // A Txn without compares always runs its success ops, all the
+        // keys are read at the same revision in one round trip
+        for (size_t i = 0; i < remote.size(); i++) {
+            RequestOp* op = txn_request.add_success();
+            op->mutable_request_range()->set_key(keys[remote[i]]);
+            op->mutable_request_range()->set_serializable(serializable);
+        }
+        status = call("get_view", [&](KV::Stub* kv_stub, ClientContext* context) {
+            return kv_stub->Txn(context, txn_request, reply.get());
+        });
+        if (!status.ok()) {
+            LOG_ERROR("get_view() API Failed with Error:%s and Error Code: %d",
+                status.error_message().c_str(), status.error_code());
+            values.clear();
+            return values;
+        }
+        if (reply->responses_size() != (int) remote.size()) {
+            LOG_ERROR("get_view() API got %d responses for %d keys",
+                reply->responses_size(), (int) remote.size());
+            values.clear();
+            return values;
+        }
+        for (int i = 0; i < reply->responses_size(); i++) {
+            const RangeResponse& range = reply->responses(i).response_range();
+            if (range.kvs_size() != 0) {
+                values[remote[i]] = etcd_value_ref_t(reply, &range.kvs(0).value());
+            } else {
+                LOG_DEBUG("Value for the key %s is not found", keys[remote[i]].c_str());
+            }
+        }
+        // Prefetched values may be older than the ones read now
+        if (revision != NULL) {
+            *revision = remote.size() < keys.size() ? local_revision : reply->header().revision();
+        }
+    } catch(std::exception const & ex) {
+        LOG_ERROR("Exception Occurred in get_view() API with the Error: %s", ex.what());
+        values.clear();
+    }
+    return values;
+}
+
+bool EtcdClient::is_prefetched(const std::string& key) {
+    for (size_t i = 0; i < prefetched_prefixes.size(); i++) {
+        const std::string& prefix = prefetched_prefixes[i];
+        if (key.compare(0, prefix.length(), prefix) == 0) {
+            return true;
+        }
     }
-    // Returns false to indicate stream->Read() returned 0
-    // and that the watch has expired
-    // User can choose to re-register the watch based
-    // on this return value
     return false;
 }
 
+/**
+* Fetches every key under the given prefixes into the local table
+* @param prefixes are the key prefixes to be fetched
+*/
+int EtcdClient::prefetch(std::vector<std::string>& prefixes) {
+    LOG_DEBUG_0("In prefetch() API");
+
+    if (prefixes.empty()) {
+        LOG_DEBUG_0("Dropping the prefetched keys");
+        std::lock_guard<std::mutex> lock(prefetch_mtx);
+        prefetched_prefixes.clear();
+        prefetched.clear();
+        snapshot_loaded = false;
+        return 0;
+    }
+
+    char* etcd_prefix = getenv("ETCD_PREFIX");
+    if (etcd_prefix == NULL) {
+        LOG_DEBUG_0("ETCD_PREFIX env not set, fetching keys without ETCD_PREFIX");
+    }
+    for (size_t i = 0; i < prefixes.size(); i++) {
+        if (etcd_prefix != NULL && strlen(etcd_prefix) != 0) {
+            std::string prefix(etcd_prefix);
+            prefixes[i] = prefix + prefixes[i];
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(prefetch_mtx);
+        if (snapshot_loaded && prefixes == prefetched_prefixes) {
+            LOG_INFO("Serving the keys from the snapshot %s", snapshot_file.c_str());
+            return 0;
+        }
+    }
+    std::map<std::string, etcd_value_ref_t> table;
+    int64_t revision = 0;
+    if (fetch_prefixes(prefixes, 0, table, revision) != 0) {
+        return -1;
+    }
+    save_snapshot(prefixes, table, revision);
+
+    std::lock_guard<std::mutex> lock(prefetch_mtx);
+    prefetched_prefixes = prefixes;
+    prefetched.swap(table);
+    prefetched_revision = revision;
+    return 0;
+}
+
+int EtcdClient::fetch_prefixes(const std::vector<std::string>& prefixes, int timeout_ms,
+                               std::map<std::string, etcd_value_ref_t>& table, int64_t& revision) {
+    TxnRequest txn_request;
+    // Shared with the prefetched values, which point into it
+    std::shared_ptr<TxnResponse> reply(new TxnResponse());
+    Status status;
+
+    try {
+        for (size_t i = 0; i < prefixes.size(); i++) {
+            std::string range_end = prefixes[i];
+            int ascii = (int)range_end[range_end.length()-1];
+            range_end.back() = ascii+1;
+
+            RequestOp* op = txn_request.add_success();
+            op->mutable_request_range()->set_key(prefixes[i]);
+            op->mutable_request_range()->set_range_end(range_end);
+            op->mutable_request_range()->set_serializable(serializable);
+        }
+        status = call("prefetch", [&](KV::Stub* kv_stub, ClientContext* context) {
+            return kv_stub->Txn(context, txn_request, reply.get());
+        }, timeout_ms);
+        if (!status.ok()) {
+            LOG_ERROR("prefetch() API Failed with Error:%s and Error Code: %d",
+                status.error_message().c_str(), status.error_code());
+            return -1;
+        }
+        for (int i = 0; i < reply->responses_size(); i++) {
+            const RangeResponse& range = reply->responses(i).response_range();
+            for (int j = 0; j < range.kvs_size(); j++) {
+                table[range.kvs(j).key()] = etcd_value_ref_t(reply, &range.kvs(j).value());
+            }
+        }
+    } catch(std::exception const & ex) {
+        LOG_ERROR("Exception Occurred in prefetch() API with the Error: %s", ex.what());
+        return -1;
+    }
+
+    LOG_DEBUG("Prefetched %d keys under %d prefixes", (int) table.size(), (int) prefixes.size());
+    revision = reply->header().revision();
+    return 0;
+}
+
+void EtcdClient::set_retry_policy(const etcd_retry_policy_t& policy) {
+    LOG_DEBUG("Requests time out after %d ms and are attempted up to %d times",
+              policy.timeout_ms, policy.max_attempts);
+    {
+        std::lock_guard<std::mutex> lock(retry_mtx);
+        retry_policy = policy;
+        retry_tokens = policy.retry_budget;
+    }
+    watch_manager->set_retry_policy(policy);
+}
+
+void EtcdClient::set_watch_dispatcher(size_t num_threads, size_t queue_size) {
+    LOG_DEBUG("Watch callbacks run on %d threads", (int) num_threads);
+    watch_manager->set_dispatcher(num_threads, queue_size);
+}
+
+uint64_t EtcdClient::get_dropped_watch_events() {
+    return watch_manager->get_dropped_events();
+}
+
+Status EtcdClient::call(const char* name, std::function<Status(KV::Stub*, ClientContext*)> rpc,
+                        int timeout_ms) {
+    etcd_retry_policy_t policy;
+    Status status;
+
+    {
+        std::lock_guard<std::mutex> lock(retry_mtx);
+        policy = retry_policy;
+    }
+    if (timeout_ms == 0) {
+        timeout_ms = policy.timeout_ms;
+    }
+
+    for (int attempt = 1; ; attempt++) {
+        ClientContext context;
+        if (timeout_ms > 0) {
+            context.set_deadline(std::chrono::system_clock::now() +
+                                 std::chrono::milliseconds(timeout_ms));
+        }
+        // A retry goes to the next member
+        status = rpc(next_kv_stub(), &context);
+
+        std::unique_lock<std::mutex> lock(retry_mtx);
+        if (status.ok()) {
+            retry_tokens = std::min(retry_tokens + RETRY_TOKEN_RATIO,
+                                    (double) retry_policy.retry_budget);
+            return status;
+        }
+        // Only failures of the transport or the server availability are
+        // retried, other errors would fail the same way again
+        if ((status.error_code() != grpc::StatusCode::UNAVAILABLE &&
+             status.error_code() != grpc::StatusCode::DEADLINE_EXCEEDED) ||
+                attempt >= policy.max_attempts) {
+            return status;
+        }
+        if (retry_tokens < 1) {
+            LOG_DEBUG("%s() not retried, the retry budget is exhausted", name);
+            return status;
+        }
+        retry_tokens -= 1;
+        lock.unlock();
+
+        int backoff_ms = etcd_retry_backoff_ms(&policy, attempt - 1);
+        LOG_DEBUG("%s() failed with Error:%s, retrying in %d ms", name,
+                  status.error_message().c_str(), backoff_ms);
+        std::this_thread::sleep_for(std::chrono::milliseconds(backoff_ms));
+    }
+}
+
+void EtcdClient::set_serializable(bool serializable) {
+    LOG_DEBUG("Reads are %s by default", serializable ? "serializable" : "linearizable");
+    this->serializable = serializable;
+}
+
+bool EtcdClient::is_serializable(kv_store_consistency_t consistency) {
+    if (consistency == KV_STORE_CONSISTENCY_DEFAULT) {
+        return serializable;
+    }
+    return consistency == KV_STORE_CONSISTENCY_SERIALIZABLE;
+}
+
+void EtcdClient::set_snapshot_file(const std::string& path) {
+    etcd_snapshot_t snapshot;
+
+    snapshot_file = path;
+    if (!etcd_snapshot_load(path, snapshot)) {
+        LOG_INFO("Starting without the snapshot %s", path.c_str());
+        return;
+    }
+    LOG_INFO("Starting from the snapshot %s at revision %ld",
+             path.c_str(), (long) snapshot.revision);
+    {
+        std::lock_guard<std::mutex> lock(prefetch_mtx);
+        prefetched_prefixes = snapshot.prefixes;
+        prefetched.clear();
+        std::map<std::string, std::string>::iterator it;
+        for (it = snapshot.kvs.begin(); it != snapshot.kvs.end(); ++it) {
+            std::shared_ptr<std::string> value(new std::string());
+            value->swap(it->second);
+            prefetched[it->first] = value;
+        }
+        prefetched_revision = snapshot.revision;
+        snapshot_loaded = true;
+    }
+    // Watches are registered once the keys are fetched again, so that a
+    // change is never notified before the key can be read
+    watch_start_revision = snapshot.revision + 1;
+    watch_manager->hold();
+    reconcile_thread = std::thread(&EtcdClient::reconcile, this, snapshot.prefixes);
+}
+
+void EtcdClient::reconcile(std::vector<std::string> prefixes) {
+    std::map<std::string, etcd_value_ref_t> table;
+    int64_t revision = 0;
+    while (true) {
+        if (fetch_prefixes(prefixes, SNAPSHOT_FETCH_TIMEOUT_MS, table, revision) == 0) {
+            break;
+        }
+        std::unique_lock<std::mutex> lock(reconcile_mtx);
+        if (reconcile_cv.wait_for(lock, std::chrono::milliseconds(SNAPSHOT_RETRY_INTERVAL_MS),
+                                  [this] { return reconcile_stopping; })) {
+            return;
+        }
+    }
+    LOG_INFO_0("Keys of the snapshot fetched again from etcd server");
+    save_snapshot(prefixes, table, revision);
+    {
+        // Keys dropped by prefetch() meanwhile are read from etcd server
+        std::lock_guard<std::mutex> lock(prefetch_mtx);
+        if (prefetched_prefixes == prefixes) {
+            prefetched.swap(table);
+            prefetched_revision = revision;
+        }
+    }
+    // Watches registered from now on only notify the changes following
+    // the keys read from etcd server
+    watch_start_revision = 0;
+    watch_manager->release();
+}
+
+void EtcdClient::save_snapshot(const std::vector<std::string>& prefixes,
+                               const std::map<std::string, etcd_value_ref_t>& table, int64_t revision) {
+    if (snapshot_file.empty()) {
+        return;
+    }
+    etcd_snapshot_t snapshot;
+    snapshot.revision = revision;
+    snapshot.prefixes = prefixes;
+    std::map<std::string, etcd_value_ref_t>::const_iterator it;
+    for (it = table.begin(); it != table.end(); ++it) {
+        snapshot.kvs[it->first] = *it->second;
+    }
+    etcd_snapshot_save(snapshot_file, snapshot);
+}
+
 /**
 * Watches for changes of a prefix of a key and register user_callback and notify
 * the user if any change on directory(prefix of key) occured
@@ -298,13 +842,9 @@ void EtcdClient::watch_prefix(std::string& key, kv_store_watch_callback_t user_c
     LOG_DEBUG_0("In watch_prefix() API");
     LOG_DEBUG("Register the prefix of the the key %s to watch on", key.c_str());
 
-    WatchResponse reply;
-    ClientContext context;
-    mvccpb::KeyValue kvs;
-    WatchRequest watch_req;
     WatchCreateRequest watch_create_req;
 
-    int revision = 0;
+    int64_t revision = watch_start_revision;
     std::string& range_end = key;
 
     try{
@@ -325,16 +865,111 @@ void EtcdClient::watch_prefix(std::string& key, kv_store_watch_callback_t user_c
 
         watch_create_req.set_range_end(range_end);
         watch_create_req.set_start_revision(revision);
-        watch_req.mutable_create_request()->CopyFrom(watch_create_req);
 
-        std::thread register_watch_prefix_thread(register_watch_loop, address, ssl_opts, watch_req, user_callback, user_data);
-        register_watch_prefix_thread.detach();
+        watch_manager->add_watch(watch_create_req, user_callback, user_data);
     } catch(std::exception const & ex) {
         LOG_ERROR("Exception Occurred in watch_prefix() API with the Error: %s", ex.what());
         return;
     }
 }
 
+/**
+* Watches for changes of a prefix of a key and notifies the user of the
+* changes in batches
+* @param key is the value or directory to be watched
+* @param window_ms time a change waits for further ones
+* @param batch_callback user_call back to register for a key
+* @param user_data user_data to be passed, it can be NULL also
+*/
+void EtcdClient::watch_prefix_batched(std::string& key, int window_ms,
+                                      kv_store_watch_batch_callback_t batch_callback, void *user_data) {
+    LOG_DEBUG_0("In watch_prefix_batched() API");
+    LOG_DEBUG("Register the prefix of the the key %s to watch on in batches of %d ms",
+              key.c_str(), window_ms);
+
+    if (window_ms < 0) {
+        LOG_ERROR("Invalid batching window %d ms", window_ms);
+        return;
+    }
+
+    WatchCreateRequest watch_create_req;
+
+    int64_t revision = watch_start_revision;
+    std::string& range_end = key;
+
+    try{
+        char* etcd_prefix = getenv("ETCD_PREFIX");
+        if (etcd_prefix == NULL) {
+            LOG_DEBUG_0("ETCD_PREFIX env not set, fetching key without ETCD_PREFIX");
+        } else {
+            if (strlen(etcd_prefix) != 0) {
+                std::string prefix(etcd_prefix);
+                key = prefix + key;
+            }
+        }
+        watch_create_req.set_key(key);
+        watch_create_req.set_prev_kv(false);
+
+        int ascii = (int)range_end[range_end.length()-1];
+        range_end.back() = ascii+1;
+
+        watch_create_req.set_range_end(range_end);
+        watch_create_req.set_start_revision(revision);
+
+        watch_manager->add_batched_watch(watch_create_req, window_ms, batch_callback, user_data);
+    } catch(std::exception const & ex) {
+        LOG_ERROR("Exception Occurred in watch_prefix_batched() API with the Error: %s", ex.what());
+        return;
+    }
+}
+
+/**
+* Watches for every change of a key or of a prefix of a key and notifies
+* the user of the events
+* @param key is the value or directory to be watched
+* @param opts whether key is a prefix, previous values are needed, the
+*             revision to start from and whether values are parsed lazily
+* @param event_callback user_call back to register for a key
+* @param user_data user_data to be passed, it can be NULL also
+* @return 0 if the watch is registered, -1 on failure
+*/
+int EtcdClient::watch_events(std::string& key, const kv_store_watch_options_t& opts,
+                             kv_store_watch_event_callback_t event_callback, void *user_data) {
+    LOG_DEBUG_0("In watch_events() API");
+    LOG_DEBUG("Register the %s %s to watch events on", opts.prefix ? "prefix" : "key", key.c_str());
+
+    WatchCreateRequest watch_create_req;
+
+    int64_t revision = opts.start_revision > 0 ? opts.start_revision : watch_start_revision.load();
+
+    try{
+        char* etcd_prefix = getenv("ETCD_PREFIX");
+        if (etcd_prefix == NULL) {
+            LOG_DEBUG_0("ETCD_PREFIX env not set, fetching key without ETCD_PREFIX");
+        } else {
+            if (strlen(etcd_prefix) != 0) {
+                std::string prefix(etcd_prefix);
+                key = prefix + key;
+            }
+        }
+        watch_create_req.set_key(key);
+        watch_create_req.set_prev_kv(opts.prev_value);
+        if (opts.prefix) {
+            std::string range_end = key;
+            int ascii = (int)range_end[range_end.length()-1];
+            range_end.back() = ascii+1;
+            watch_create_req.set_range_end(range_end);
+        }
+        watch_create_req.set_start_revision(revision);
+
+        watch_manager->add_event_watch(watch_create_req, event_callback, user_data, opts.lazy_value);
+    } catch(std::exception const & ex) {
+        LOG_ERROR("Exception Occurred in watch_events() API with the Error: %s", ex.what());
+        return -1;
+    }
+    return 0;
+}
+
 /**
 * Watches for changes of a key, registers user_callback and notify
 * user if any change on key occured
@@ -346,13 +981,9 @@ void EtcdClient::watch(std::string& key, kv_store_watch_callback_t user_callback
     LOG_DEBUG_0("In watch() API");
     LOG_DEBUG("Register the key %s to watch on", key.c_str());
 
-    WatchResponse reply;
-    ClientContext context;
-    mvccpb::KeyValue kvs;
-    WatchRequest watch_req;
     WatchCreateRequest watch_create_req;
 
-    int revision = 0;
+    int64_t revision = watch_start_revision;
 
     try{
         char* etcd_prefix = getenv("ETCD_PREFIX");
@@ -367,11 +998,9 @@ void EtcdClient::watch(std::string& key, kv_store_watch_callback_t user_callback
         watch_create_req.set_key(key);
         watch_create_req.set_prev_kv(false);
         watch_create_req.set_start_revision(revision);
-        watch_req.mutable_create_request()->CopyFrom(watch_create_req);
 
-        std::thread register_watch_thread(register_watch_loop, address, ssl_opts, watch_req, user_callback, user_data);
-        LOG_DEBUG("Thread created to wait on any change on the key %s", key.c_str());
-        register_watch_thread.detach();
+        watch_manager->add_watch(watch_create_req, user_callback, user_data);
+        LOG_DEBUG("Watch registered for any change on the key %s", key.c_str());
     } catch(std::exception const & ex) {
         LOG_ERROR("Exception Occurred in watch() API with the Error: %s", ex.what());
         return;
@@ -392,7 +1021,6 @@ int EtcdClient::put(std::string& key, std::string& value) {
     PutRequest put_request;
     PutResponse reply;
     Status status;
-    ClientContext context;
 
     LOG_DEBUG("Store the value %s for the key %s", value.c_str(), key.c_str());
 
@@ -410,13 +1038,20 @@ int EtcdClient::put(std::string& key, std::string& value) {
         put_request.set_value(value);
         put_request.set_prev_kv(false);
         put_request.set_lease(leaseid);
-        status = kv_stub->Put(&context,put_request,&reply);
+        status = call("put", [&](KV::Stub* kv_stub, ClientContext* context) {
+            return kv_stub->Put(context, put_request, &reply);
+        });
 
         if (!status.ok()) {
             LOG_ERROR("Failed to put value %s for key %s", value.c_str(), key.c_str());
             LOG_ERROR("put() API Failed with Error:%s", status.error_message().c_str());
             return -1;
         }
+        // Later reads of this client see the value it put
+        std::lock_guard<std::mutex> lock(prefetch_mtx);
+        if (is_prefetched(key)) {
+            prefetched[key] = etcd_value_ref_t(new std::string(value));
+        }
     } catch(std::exception const & ex) {
         LOG_ERROR("Exception Occurred in put() API with the Error: %s", ex.what());
         return -1;
@@ -428,7 +1063,16 @@ int EtcdClient::put(std::string& key, std::string& value) {
 
 EtcdClient::~EtcdClient() {
     LOG_DEBUG_0("EtcdClient Destructor is called");
-    if (kv_stub != NULL) {
-        kv_stub.reset();
+    {
+        std::lock_guard<std::mutex> lock(reconcile_mtx);
+        reconcile_stopping = true;
+    }
+    reconcile_cv.notify_all();
+    if (reconcile_thread.joinable()) {
+        reconcile_thread.join();
     }
+    // Stop the watch stream before the channels it runs on are released
+    watch_manager.reset();
+    kv_stubs.clear();
+    channels.clear();
 }
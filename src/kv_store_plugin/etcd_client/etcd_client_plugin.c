@@ -31,6 +31,16 @@
 #define CERT_FILE       "cert_file"
 #define KEY_FILE        "key_file"
 #define CA_FILE         "ca_file"
+#define SNAPSHOT_FILE   "snapshot_file"
+#define CONSISTENCY     "consistency"
+#define TIMEOUT_MS      "timeout_ms"
+#define MAX_ATTEMPTS    "max_attempts"
+#define INITIAL_BACKOFF_MS  "initial_backoff_ms"
+#define MAX_BACKOFF_MS  "max_backoff_ms"
+#define RETRY_BUDGET    "retry_budget"
+#define DISPATCHER_THREADS  "dispatcher_threads"
+#define DISPATCHER_QUEUE_SIZE   "dispatcher_queue_size"
+#define DEFAULT_DISPATCHER_QUEUE_SIZE   1024
 #define ETCD_HOST_IP    "127.0.0.1"
 #define ETCD_PORT       "2379"
 
@@ -38,9 +48,20 @@
 void* etcd_init(void* etcd_client);
 char* etcd_get(void * handle, char *key);
 config_value_t* etcd_get_prefix(void * handle, char *key);
+config_value_t* etcd_get_prefix_with_options(void* handle, char *key, const kv_store_read_options_t *opts);
+int etcd_scan_prefix(void* handle, char *key, size_t page_size, kv_store_scan_callback_t cb, void* user_data);
+char** etcd_get_many(void* handle, char **keys, size_t num_keys);
+int etcd_prefetch(void* handle, char **prefixes, size_t num_prefixes);
+int etcd_get_view(void* handle, char **keys, size_t num_keys, kv_store_value_view_t *views);
+void etcd_release_view(void* handle, kv_store_value_view_t *view);
 int etcd_put(void* handle, char *key, char *value);
 void etcd_watch(void* handle, char *key_test, kv_store_watch_callback_t cb, void* user_data);
 void etcd_watch_prefix(void* handle, char *key_test, kv_store_watch_callback_t cb, void* user_data);
+void etcd_watch_prefix_batched(void* handle, char *key_test, int window_ms,
+                               kv_store_watch_batch_callback_t cb, void* user_data);
+int etcd_watch_events(void* handle, char *key_test, const kv_store_watch_options_t *opts,
+                      kv_store_watch_event_callback_t cb, void* user_data);
+uint64_t etcd_get_dropped_watch_events(void* handle);
 void etcd_client_free(void* handle);
 bool create_cert_copy(char **dest_cert, char *src_cert, unsigned int src_len);
 int strncpy_s(char *dest, unsigned int dmax, char *src, unsigned int slen);
@@ -60,26 +81,51 @@ bool create_cert_copy(char **dest_cert, char *src_cert, unsigned int src_len) {
     int ret = strncpy_s(*dest_cert, src_len + 1, src_cert, src_len);
     if (ret != 0) {
         LOG_ERROR_0("Failed to copy certificate");
+        free(*dest_cert);
+        *dest_cert = NULL;
         return false;
     }
     return true;
 }
+// Reads the optional integer key of conf_obj into value, left untouched if
+// the key is not set. Returns false if the key is not a non negative integer
+static bool get_optional_int(config_t* config, config_value_t* conf_obj, const char* key, int* value) {
+    config_value_t* cv = config->get_config_value(conf_obj->body.object->object, key);
+    if (cv == NULL) {
+        return true;
+    }
+    if (cv->type != CVT_INTEGER || cv->body.integer < 0) {
+        LOG_ERROR("%s must be a non negative integer", key);
+        config_value_destroy(cv);
+        return false;
+    }
+    *value = (int) cv->body.integer;
+    config_value_destroy(cv);
+    return true;
+}
+
 kv_store_client_t* create_etcd_client(config_t *config) {
     kv_store_client_t *kv_store_client = NULL, *ret = NULL;
     etcd_config_t *etcd_config = NULL;
-    config_value_t *cert_file, *key_file, *ca_file;
+    config_value_t *cert_file, *key_file, *ca_file, *snapshot_file, *consistency;
     char *host = NULL, *port = NULL;
     char *etcd_host = NULL, *etcd_port = NULL, *src_etcd_host = NULL, *src_etcd_port = NULL;
     config_value_t* conf_obj = NULL;
     char* c_etcd_endpoint = NULL;
+    char* endpoints = NULL;
+    int cmp_consistency;
 
-    cert_file = key_file = ca_file = NULL;
+    cert_file = key_file = ca_file = snapshot_file = consistency = NULL;
 
     etcd_config = (etcd_config_t*)malloc(sizeof(etcd_config_t));
     if (etcd_config == NULL) {
         LOG_ERROR_0("Etcd config: Failed to allocate Memory");
         goto err;
     }
+    etcd_config->cert_file = NULL;
+    etcd_config->key_file = NULL;
+    etcd_config->ca_file = NULL;
+    etcd_config->snapshot_file = NULL;
 
     kv_store_client = (kv_store_client_t*)malloc(sizeof(kv_store_client_t));
     if (kv_store_client == NULL) {
@@ -189,6 +235,17 @@ kv_store_client_t* create_etcd_client(config_t *config) {
                 }
                 LOG_DEBUG("ETCD endpoint: %s", c_etcd_endpoint);
 
+                // A comma separated list of endpoints connects to every
+                // member, host and port are the ones of the first member
+                char* next_endpoint = strchr(c_etcd_endpoint, ',');
+                if (next_endpoint != NULL) {
+                    if (!create_cert_copy(&endpoints, c_etcd_endpoint, strlen(c_etcd_endpoint))) {
+                        LOG_ERROR_0("create_etcd_client: Failed to allocated and copy endpoints");
+                        goto err;
+                    }
+                    *next_endpoint = '\0';
+                }
+
                 char** host_port = get_host_port(c_etcd_endpoint);
                 if (host_port == NULL){
                     LOG_ERROR_0("get_host_port failed to get host and port");
@@ -201,6 +258,7 @@ kv_store_client_t* create_etcd_client(config_t *config) {
                 etcd_host = host;
                 etcd_port = port;
                 free(c_etcd_endpoint);
+                c_etcd_endpoint = NULL;
             }
         }
         LOG_DEBUG("Obtained ETCD IP %s & port %s", etcd_host, etcd_port);
@@ -235,8 +293,68 @@ kv_store_client_t* create_etcd_client(config_t *config) {
             goto err;
         }
 
+        // snapshot_file is optional, no snapshot is kept if not set
+        snapshot_file = config->get_config_value(conf_obj->body.object->object, SNAPSHOT_FILE);
+        if (snapshot_file != NULL && snapshot_file->type != CVT_STRING) {
+            LOG_ERROR_0("SNAPSHOT_FILE must be string");
+            goto err;
+        }
+
+        // consistency is optional, reads are linearizable if not set
+        etcd_config->serializable = false;
+        consistency = config->get_config_value(conf_obj->body.object->object, CONSISTENCY);
+        if (consistency != NULL) {
+            if (consistency->type != CVT_STRING) {
+                LOG_ERROR_0("CONSISTENCY must be string");
+                goto err;
+            }
+            // strcmp_s() fails without comparing an empty string
+            if (strlen(consistency->body.string) == 0) {
+                LOG_ERROR_0("CONSISTENCY must be serializable or linearizable, not empty");
+                goto err;
+            }
+            strcmp_s(consistency->body.string, strlen(consistency->body.string),
+                     "serializable", &cmp_consistency);
+            if (cmp_consistency == 0) {
+                etcd_config->serializable = true;
+            } else {
+                strcmp_s(consistency->body.string, strlen(consistency->body.string),
+                         "linearizable", &cmp_consistency);
+                if (cmp_consistency != 0) {
+                    LOG_ERROR("CONSISTENCY must be serializable or linearizable, not %s",
+                              consistency->body.string);
+                    goto err;
+                }
+            }
+            config_value_destroy(consistency);
+            consistency = NULL;
+        }
+
+        // Deadline and retry policy are optional, defaults are used if not set
+        etcd_retry_policy_default(&etcd_config->retry_policy);
+        if (!get_optional_int(config, conf_obj, TIMEOUT_MS, &etcd_config->retry_policy.timeout_ms) ||
+                !get_optional_int(config, conf_obj, MAX_ATTEMPTS, &etcd_config->retry_policy.max_attempts) ||
+                !get_optional_int(config, conf_obj, INITIAL_BACKOFF_MS, &etcd_config->retry_policy.initial_backoff_ms) ||
+                !get_optional_int(config, conf_obj, MAX_BACKOFF_MS, &etcd_config->retry_policy.max_backoff_ms) ||
+                !get_optional_int(config, conf_obj, RETRY_BUDGET, &etcd_config->retry_policy.retry_budget)) {
+            goto err;
+        }
+
+        // Watch callbacks run on the watch stream thread unless threads are set
+        etcd_config->dispatcher_threads = 0;
+        etcd_config->dispatcher_queue_size = DEFAULT_DISPATCHER_QUEUE_SIZE;
+        if (!get_optional_int(config, conf_obj, DISPATCHER_THREADS, &etcd_config->dispatcher_threads) ||
+                !get_optional_int(config, conf_obj, DISPATCHER_QUEUE_SIZE, &etcd_config->dispatcher_queue_size)) {
+            goto err;
+        }
+        if (etcd_config->dispatcher_queue_size == 0) {
+            LOG_ERROR("%s must be greater than 0", DISPATCHER_QUEUE_SIZE);
+            goto err;
+        }
+
         if (conf_obj != NULL) {
             config_value_destroy(conf_obj);
+            conf_obj = NULL;
         }
 
         unsigned int cert_file_len = strlen(cert_file->body.string);
@@ -252,6 +370,7 @@ kv_store_client_t* create_etcd_client(config_t *config) {
             goto err;
         }
         config_value_destroy(cert_file);
+        cert_file = NULL;
 
         unsigned int key_file_len = strlen(key_file->body.string);
         ret_cert_copy = create_cert_copy(&etcd_config->key_file, key_file->body.string, key_file_len);
@@ -260,6 +379,7 @@ kv_store_client_t* create_etcd_client(config_t *config) {
             goto err;
         }
         config_value_destroy(key_file);
+        key_file = NULL;
 
         unsigned int ca_file_len = strlen(ca_file->body.string);
         ret_cert_copy = create_cert_copy(&etcd_config->ca_file, ca_file->body.string, ca_file_len);
@@ -268,15 +388,39 @@ kv_store_client_t* create_etcd_client(config_t *config) {
             goto err;
         }
         config_value_destroy(ca_file);
+        ca_file = NULL;
+
+        if (snapshot_file != NULL) {
+            unsigned int snapshot_file_len = strlen(snapshot_file->body.string);
+            ret_cert_copy = create_cert_copy(&etcd_config->snapshot_file, snapshot_file->body.string, snapshot_file_len);
+            if (!ret_cert_copy) {
+                LOG_ERROR_0("create_etcd_client: Failed to allocated and copy snapshot-file");
+                goto err;
+            }
+            config_value_destroy(snapshot_file);
+            snapshot_file = NULL;
+        } else {
+            etcd_config->snapshot_file = "";
+        }
 
         etcd_config->hostname = etcd_host;
         etcd_config->port = etcd_port;
+        etcd_config->endpoints = (endpoints != NULL) ? endpoints : "";
         kv_store_client->kv_store_config = etcd_config;
         kv_store_client->get = etcd_get;
         kv_store_client->get_prefix = etcd_get_prefix;
+        kv_store_client->get_prefix_with_options = etcd_get_prefix_with_options;
+        kv_store_client->scan_prefix = etcd_scan_prefix;
+        kv_store_client->get_many = etcd_get_many;
+        kv_store_client->prefetch = etcd_prefetch;
+        kv_store_client->get_view = etcd_get_view;
+        kv_store_client->release_view = etcd_release_view;
         kv_store_client->put = etcd_put;
         kv_store_client->watch = etcd_watch;
         kv_store_client->watch_prefix = etcd_watch_prefix;
+        kv_store_client->watch_prefix_batched = etcd_watch_prefix_batched;
+        kv_store_client->watch_events = etcd_watch_events;
+        kv_store_client->get_dropped_watch_events = etcd_get_dropped_watch_events;
         kv_store_client->init = etcd_init;
         kv_store_client->deinit = etcd_values_destroy;
         ret = kv_store_client;
@@ -303,7 +447,21 @@ err:
     if (ca_file != NULL) {
         config_value_destroy(ca_file);
     }
+    if (snapshot_file != NULL) {
+        config_value_destroy(snapshot_file);
+    }
+    if (consistency != NULL) {
+        config_value_destroy(consistency);
+    }
     if (etcd_config != NULL) {
+        // The files copied so far, an empty one being a literal
+        char* copies[] = {etcd_config->cert_file, etcd_config->key_file,
+                          etcd_config->ca_file, etcd_config->snapshot_file};
+        for (size_t i = 0; i < sizeof(copies) / sizeof(copies[0]); i++) {
+            if (copies[i] != NULL && copies[i][0] != '\0') {
+                free(copies[i]);
+            }
+        }
         free(etcd_config);
     }
     if (kv_store_client != NULL) {
@@ -312,6 +470,9 @@ err:
     if (c_etcd_endpoint != NULL) {
         free(c_etcd_endpoint);
     }
+    if (endpoints != NULL) {
+        free(endpoints);
+    }
     return ret;
 }
 
@@ -343,6 +504,18 @@ void etcd_values_destroy(kv_store_client_t* kv_store_client) {
             free(etcd_config->ca_file);
         }
     }
+    if (etcd_config->snapshot_file != NULL) {
+        strcmp_s(etcd_config->snapshot_file, strlen(etcd_config->snapshot_file), "", &ret);
+        if(ret != 0){
+            free(etcd_config->snapshot_file);
+        }
+    }
+    if (etcd_config->endpoints != NULL) {
+        strcmp_s(etcd_config->endpoints, strlen(etcd_config->endpoints), "", &ret);
+        if(ret != 0){
+            free(etcd_config->endpoints);
+        }
+    }
     if (kv_store_client->handler != NULL) {
         etcd_client_free(kv_store_client->handler);
     }
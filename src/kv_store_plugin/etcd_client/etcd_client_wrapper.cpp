@@ -45,12 +45,31 @@ void* etcd_init(void* etcd_client) {
     strcmp_s(etcd_config->key_file, strlen(etcd_config->key_file), "", &cmp_key_file);
     strcmp_s(etcd_config->ca_file, strlen(etcd_config->ca_file), "", &cmp_ca_file);
 
+    // Every member listed in endpoints, or the single host and port
+    std::vector<std::string> endpoints;
+    std::stringstream endpoints_stream(etcd_config->endpoints);
+    std::string endpoint;
+    while (std::getline(endpoints_stream, endpoint, ',')) {
+        endpoint.erase(0, endpoint.find_first_not_of(" \t"));
+        endpoint.erase(endpoint.find_last_not_of(" \t") + 1);
+        if (!endpoint.empty())
+            endpoints.push_back(endpoint);
+    }
+    if (endpoints.empty())
+        endpoints.push_back(host + ":" + port);
+
     try {
         if(cmp_cert_file != 0 && cmp_key_file != 0 && cmp_ca_file != 0)
-            etcd_cli = new EtcdClient(host, port,  etcd_config->cert_file, etcd_config->key_file, etcd_config->ca_file);
+            etcd_cli = new EtcdClient(endpoints, etcd_config->cert_file, etcd_config->key_file, etcd_config->ca_file);
         else
-            etcd_cli = new EtcdClient(host, port);
+            etcd_cli = new EtcdClient(endpoints);
         kv_store_client->handler = etcd_cli;
+        etcd_cli->set_serializable(etcd_config->serializable);
+        etcd_cli->set_retry_policy(etcd_config->retry_policy);
+        etcd_cli->set_watch_dispatcher(etcd_config->dispatcher_threads,
+                                       etcd_config->dispatcher_queue_size);
+        if (strlen(etcd_config->snapshot_file) != 0)
+            etcd_cli->set_snapshot_file(etcd_config->snapshot_file);
     }catch(std::exception const & ex) {
             LOG_ERROR("Exception Occurred in etcd_init with error:%s", ex.what());
             return NULL;
@@ -84,16 +103,9 @@ char* etcd_get(void* handle, char *key) {
     return val;
 }
 
-config_value_t* etcd_get_prefix(void* handle, char *key) {
-    std::string str_key = key;
+// Wraps the strings of vec into a config_value_t array
+static config_value_t* strings_to_array(const std::vector<std::string>& vec) {
     config_value_t* values;
-    EtcdClient *cli = static_cast<EtcdClient *>(handle);
-    std::vector<std::string> vec = cli->get_prefix(str_key);
-
-    if(!vec.size()){
-        LOG_ERROR("Key not found %s",key);
-        return NULL;
-    }
 
     cJSON* all_values = cJSON_CreateArray();
     if(all_values == NULL){
@@ -116,6 +128,157 @@ config_value_t* etcd_get_prefix(void* handle, char *key) {
     return values;
 }
 
+config_value_t* etcd_get_prefix(void* handle, char *key) {
+    std::string str_key = key;
+    EtcdClient *cli = static_cast<EtcdClient *>(handle);
+    std::vector<std::string> vec = cli->get_prefix(str_key);
+
+    if(!vec.size()){
+        LOG_ERROR("Key not found %s",key);
+        return NULL;
+    }
+
+    return strings_to_array(vec);
+}
+
+config_value_t* etcd_get_prefix_with_options(void* handle, char *key,
+                                             const kv_store_read_options_t *opts) {
+    std::string str_key = key;
+    EtcdClient *cli = static_cast<EtcdClient *>(handle);
+    std::vector<std::string> vec;
+
+    int64_t count = cli->get_prefix(str_key, *opts, vec);
+    if (count < 0) {
+        LOG_ERROR("Failed to get prefix %s", key);
+        return NULL;
+    }
+
+    if (opts->count_only)
+        return config_value_new_integer(count);
+
+    if(!vec.size()){
+        LOG_ERROR("Key not found %s",key);
+        return NULL;
+    }
+
+    return strings_to_array(vec);
+}
+
+int etcd_scan_prefix(void* handle, char *key, size_t page_size,
+                     kv_store_scan_callback_t cb, void* user_data) {
+    std::string str_key = key;
+    EtcdClient *cli = static_cast<EtcdClient *>(handle);
+    std::vector<const char*> keys;
+    std::vector<const char*> values;
+
+    return cli->scan_prefix(str_key, page_size,
+            [&](const std::vector<std::string>& page_keys,
+                const std::vector<std::string>& page_values) {
+        keys.resize(page_keys.size());
+        values.resize(page_values.size());
+        for (size_t i = 0; i < page_keys.size(); i++) {
+            keys[i] = page_keys[i].c_str();
+            values[i] = page_values[i].c_str();
+        }
+        return cb(keys.data(), values.data(), keys.size(), user_data);
+    });
+}
+
+char** etcd_get_many(void* handle, char **keys, size_t num_keys) {
+    EtcdClient *cli = static_cast<EtcdClient *>(handle);
+    std::vector<std::string> str_keys(keys, keys + num_keys);
+    std::vector<std::string> vec = cli->get_many(str_keys);
+    int cmp_value;
+
+    if (vec.size() != num_keys) {
+        LOG_ERROR("Failed to get values for %d keys", (int) num_keys);
+        return NULL;
+    }
+
+    char** values = (char**) calloc(num_keys, sizeof(char*));
+    if (values == NULL) {
+        LOG_ERROR_0("Failed to allocate memory");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < num_keys; i++) {
+        const char* value = vec[i].c_str();
+        strcmp_s(value, strlen(value), "(NULL)", &cmp_value);
+        if (cmp_value == 0)
+            continue;
+
+        size_t len = strlen(value) + 1;
+        values[i] = (char *)malloc(len);
+        if (values[i] == NULL) {
+            LOG_ERROR_0("Failed to allocate memory");
+            for (size_t j = 0; j < i; j++) {
+                free(values[j]);
+            }
+            free(values);
+            return NULL;
+        }
+        memset(values[i], '\0', len);
+        strcpy_s(values[i], len, value);
+    }
+
+    return values;
+}
+
+void etcd_release_view(void* handle, kv_store_value_view_t *view) {
+    if (view->ref != NULL) {
+        delete static_cast<etcd_value_ref_t *>(view->ref);
+    }
+    view->data = NULL;
+    view->len = 0;
+    view->ref = NULL;
+}
+
+int etcd_get_view(void* handle, char **keys, size_t num_keys, kv_store_value_view_t *views) {
+    EtcdClient *cli = static_cast<EtcdClient *>(handle);
+    std::vector<std::string> str_keys;
+    for (size_t i = 0; i < num_keys; i++) {
+        str_keys.push_back(keys[i]);
+    }
+    int64_t revision = 0;
+    std::vector<etcd_value_ref_t> refs = cli->get_view(str_keys, &revision);
+    if (refs.size() != num_keys) {
+        return -1;
+    }
+
+    for (size_t i = 0; i < num_keys; i++) {
+        views[i].data = NULL;
+        views[i].len = 0;
+        views[i].ref = NULL;
+        views[i].revision = revision;
+    }
+    try {
+        for (size_t i = 0; i < num_keys; i++) {
+            if (refs[i] == NULL) {
+                continue;
+            }
+            views[i].ref = new etcd_value_ref_t(refs[i]);
+            views[i].data = refs[i]->c_str();
+            views[i].len = refs[i]->size();
+        }
+    } catch(std::exception const & ex) {
+        LOG_ERROR("Exception Occurred in etcd_get_view with error:%s", ex.what());
+        for (size_t i = 0; i < num_keys; i++) {
+            etcd_release_view(handle, &views[i]);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+int etcd_prefetch(void* handle, char **prefixes, size_t num_prefixes) {
+    EtcdClient *cli = static_cast<EtcdClient *>(handle);
+    std::vector<std::string> str_prefixes;
+    for (size_t i = 0; i < num_prefixes; i++) {
+        str_prefixes.push_back(prefixes[i]);
+    }
+    return cli->prefetch(str_prefixes);
+}
+
 int etcd_put(void* handle, char *key, char *value){
     std::string str_key = key;
     std::string str_value = value;
@@ -136,10 +299,33 @@ void etcd_watch_prefix(void* handle, char *key, kv_store_watch_callback_t user_c
     cli->watch_prefix(str_key, user_cb, user_data);
 }
 
+void etcd_watch_prefix_batched(void* handle, char *key, int window_ms,
+                               kv_store_watch_batch_callback_t user_cb, void* user_data) {
+    std::string str_key = key;
+    EtcdClient *cli = static_cast<EtcdClient *>(handle);
+    cli->watch_prefix_batched(str_key, window_ms, user_cb, user_data);
+}
+
+int etcd_watch_events(void* handle, char *key, const kv_store_watch_options_t *opts,
+                      kv_store_watch_event_callback_t user_cb, void* user_data) {
+    std::string str_key = key;
+    kv_store_watch_options_t watch_opts = {};
+    if (opts != NULL)
+        watch_opts = *opts;
+    EtcdClient *cli = static_cast<EtcdClient *>(handle);
+    return cli->watch_events(str_key, watch_opts, user_cb, user_data);
+}
+
+uint64_t etcd_get_dropped_watch_events(void* handle) {
+    EtcdClient *cli = static_cast<EtcdClient *>(handle);
+    return cli->get_dropped_watch_events();
+}
+
 void etcd_client_free(void* handle){
     if (handle != NULL) {
         EtcdClient *cli = static_cast<EtcdClient *>(handle);
-        cli->~EtcdClient();
+        // Stops the watches of the client and releases it
+        delete cli;
     }
 }
 
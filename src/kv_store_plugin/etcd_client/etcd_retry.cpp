@@ -0,0 +1,54 @@
+// Copyright (c) 2020 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @file
+ * @brief Retry policy implementation
+ */
+
+#include <random>
+
+#include <eii/config_manager/kv_store_plugin/etcd_client/etcd_retry.h>
+
+void etcd_retry_policy_default(etcd_retry_policy_t* policy) {
+    policy->timeout_ms = ETCD_DEFAULT_TIMEOUT_MS;
+    policy->max_attempts = ETCD_DEFAULT_MAX_ATTEMPTS;
+    policy->initial_backoff_ms = ETCD_DEFAULT_INITIAL_BACKOFF_MS;
+    policy->max_backoff_ms = ETCD_DEFAULT_MAX_BACKOFF_MS;
+    policy->retry_budget = ETCD_DEFAULT_RETRY_BUDGET;
+}
+
+int etcd_retry_backoff_ms(const etcd_retry_policy_t* policy, int retry) {
+    static thread_local std::minstd_rand rng(std::random_device{}());
+    long backoff_ms = policy->initial_backoff_ms;
+
+    for (int i = 0; i < retry && backoff_ms < policy->max_backoff_ms; i++) {
+        backoff_ms *= 2;
+    }
+    if (backoff_ms > policy->max_backoff_ms) {
+        backoff_ms = policy->max_backoff_ms;
+    }
+    if (backoff_ms <= 1) {
+        return (int) backoff_ms;
+    }
+
+    std::uniform_int_distribution<long> jitter(backoff_ms / 2, backoff_ms);
+    return (int) jitter(rng);
+}
@@ -0,0 +1,244 @@
+// Copyright (c) 2020 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @file
+ * @brief On-disk snapshot implementation
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <eii/utils/logger.h>
+#include <eii/config_manager/kv_store_plugin/etcd_client/etcd_snapshot.h>
+
+// CRC-32 (IEEE 802.3) of buf
+static uint32_t crc32(const uint8_t* buf, size_t len) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= buf[i];
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+static void append(std::string& buf, const void* data, size_t len) {
+    buf.append(static_cast<const char*>(data), len);
+}
+
+static void append_string(std::string& buf, const std::string& str) {
+    uint32_t len = str.size();
+    append(buf, &len, sizeof(len));
+    buf.append(str);
+}
+
+// Reads len bytes at *pos of the payload, false if they overrun it
+static bool consume(const uint8_t* payload, uint64_t payload_len, uint64_t* pos,
+                    void* dest, size_t len) {
+    if (payload_len - *pos < len) {
+        return false;
+    }
+    memcpy(dest, payload + *pos, len);
+    *pos += len;
+    return true;
+}
+
+static bool consume_string(const uint8_t* payload, uint64_t payload_len, uint64_t* pos,
+                           uint32_t len, std::string& dest) {
+    if (payload_len - *pos < len) {
+        return false;
+    }
+    dest.assign(reinterpret_cast<const char*>(payload + *pos), len);
+    *pos += len;
+    return true;
+}
+
+static bool write_all(int fd, const std::string& buf) {
+    size_t written = 0;
+    while (written < buf.size()) {
+        ssize_t ret = write(fd, buf.data() + written, buf.size() - written);
+        if (ret < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        written += ret;
+    }
+    return true;
+}
+
+bool etcd_snapshot_save(const std::string& path, const etcd_snapshot_t& snapshot) {
+    std::string payload;
+    for (size_t i = 0; i < snapshot.prefixes.size(); i++) {
+        append_string(payload, snapshot.prefixes[i]);
+    }
+    std::map<std::string, std::string>::const_iterator it;
+    for (it = snapshot.kvs.begin(); it != snapshot.kvs.end(); ++it) {
+        uint32_t key_len = it->first.size();
+        uint32_t value_len = it->second.size();
+        append(payload, &key_len, sizeof(key_len));
+        append(payload, &value_len, sizeof(value_len));
+        payload.append(it->first);
+        payload.append(it->second);
+    }
+
+    std::string buf;
+    uint32_t version = ETCD_SNAPSHOT_VERSION;
+    uint32_t crc = crc32(reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+    uint64_t payload_len = payload.size();
+    uint32_t num_prefixes = snapshot.prefixes.size();
+    uint32_t num_kvs = snapshot.kvs.size();
+    append(buf, ETCD_SNAPSHOT_MAGIC, ETCD_SNAPSHOT_MAGIC_LEN);
+    append(buf, &version, sizeof(version));
+    append(buf, &crc, sizeof(crc));
+    append(buf, &payload_len, sizeof(payload_len));
+    append(buf, &snapshot.revision, sizeof(snapshot.revision));
+    append(buf, &num_prefixes, sizeof(num_prefixes));
+    append(buf, &num_kvs, sizeof(num_kvs));
+    buf.append(payload);
+
+    std::string tmp_path = path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd < 0) {
+        LOG_ERROR("Failed to create the snapshot %s: %s", tmp_path.c_str(), strerror(errno));
+        return false;
+    }
+    if (!write_all(fd, buf) || fsync(fd) != 0) {
+        LOG_ERROR("Failed to write the snapshot %s: %s", tmp_path.c_str(), strerror(errno));
+        close(fd);
+        unlink(tmp_path.c_str());
+        return false;
+    }
+    close(fd);
+    if (rename(tmp_path.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("Failed to rename the snapshot to %s: %s", path.c_str(), strerror(errno));
+        unlink(tmp_path.c_str());
+        return false;
+    }
+
+    // Syncing the directory so that the rename survives a power loss
+    std::string dir_path(path);
+    int dir_fd = open(dirname(&dir_path[0]), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    LOG_DEBUG("Saved %d keys at revision %ld to the snapshot %s",
+              (int) num_kvs, (long) snapshot.revision, path.c_str());
+    return true;
+}
+
+bool etcd_snapshot_load(const std::string& path, etcd_snapshot_t& snapshot) {
+    bool ret = false;
+    void* map = MAP_FAILED;
+    size_t map_len = 0;
+    const uint8_t* base = NULL;
+    const uint8_t* payload = NULL;
+    uint32_t version = 0;
+    uint32_t crc = 0;
+    uint64_t payload_len = 0;
+    uint32_t num_prefixes = 0;
+    uint32_t num_kvs = 0;
+    uint64_t pos = 0;
+    struct stat st;
+
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        LOG_DEBUG("No snapshot at %s: %s", path.c_str(), strerror(errno));
+        return false;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size < ETCD_SNAPSHOT_HEADER_LEN) {
+        LOG_ERROR("Snapshot %s is truncated", path.c_str());
+        goto out;
+    }
+    map_len = st.st_size;
+    map = mmap(NULL, map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        LOG_ERROR("Failed to map the snapshot %s: %s", path.c_str(), strerror(errno));
+        goto out;
+    }
+    base = static_cast<const uint8_t*>(map);
+
+    if (memcmp(base, ETCD_SNAPSHOT_MAGIC, ETCD_SNAPSHOT_MAGIC_LEN) != 0) {
+        LOG_ERROR("%s is not a snapshot", path.c_str());
+        goto out;
+    }
+    memcpy(&version, base + 8, sizeof(version));
+    memcpy(&crc, base + 12, sizeof(crc));
+    memcpy(&payload_len, base + 16, sizeof(payload_len));
+    memcpy(&snapshot.revision, base + 24, sizeof(snapshot.revision));
+    memcpy(&num_prefixes, base + 32, sizeof(num_prefixes));
+    memcpy(&num_kvs, base + 36, sizeof(num_kvs));
+    if (version != ETCD_SNAPSHOT_VERSION) {
+        LOG_ERROR("Snapshot %s has unsupported version %u", path.c_str(), version);
+        goto out;
+    }
+    if (payload_len != map_len - ETCD_SNAPSHOT_HEADER_LEN) {
+        LOG_ERROR("Snapshot %s is truncated", path.c_str());
+        goto out;
+    }
+    payload = base + ETCD_SNAPSHOT_HEADER_LEN;
+    if (crc32(payload, payload_len) != crc) {
+        LOG_ERROR("Snapshot %s failed its checksum", path.c_str());
+        goto out;
+    }
+
+    snapshot.prefixes.clear();
+    snapshot.kvs.clear();
+    for (uint32_t i = 0; i < num_prefixes; i++) {
+        uint32_t len = 0;
+        std::string prefix;
+        if (!consume(payload, payload_len, &pos, &len, sizeof(len)) ||
+                !consume_string(payload, payload_len, &pos, len, prefix)) {
+            LOG_ERROR("Snapshot %s is malformed", path.c_str());
+            goto out;
+        }
+        snapshot.prefixes.push_back(prefix);
+    }
+    for (uint32_t i = 0; i < num_kvs; i++) {
+        uint32_t key_len = 0;
+        uint32_t value_len = 0;
+        std::string key;
+        if (!consume(payload, payload_len, &pos, &key_len, sizeof(key_len)) ||
+                !consume(payload, payload_len, &pos, &value_len, sizeof(value_len)) ||
+                !consume_string(payload, payload_len, &pos, key_len, key) ||
+                !consume_string(payload, payload_len, &pos, value_len, snapshot.kvs[key])) {
+            LOG_ERROR("Snapshot %s is malformed", path.c_str());
+            goto out;
+        }
+    }
+    LOG_DEBUG("Loaded %d keys at revision %ld from the snapshot %s",
+              (int) num_kvs, (long) snapshot.revision, path.c_str());
+    ret = true;
+out:
+    if (map != MAP_FAILED) {
+        munmap(map, map_len);
+    }
+    close(fd);
+    return ret;
+}
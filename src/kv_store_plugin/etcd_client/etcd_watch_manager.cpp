@@ -0,0 +1,964 @@
+// Copyright (c) 2020 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @file
+ * @brief Watch manager implementation
+ */
+
+#include <chrono>
+#include <cjson/cJSON.h>
+
+#include <eii/utils/logger.h>
+#include <eii/utils/json_config.h>
+#include <eii/config_manager/kv_store_plugin/kv_store_lazy_config.h>
+#include <eii/config_manager/kv_store_plugin/etcd_client/etcd_watch_manager.h>
+
+// Number of threads polling the completion queues of all Watch streams
+#define WATCH_POLLER_THREADS    2
+
+// Deadline of the Range used to resync a compacted watch
+#define WATCH_RESYNC_TIMEOUT_MS 5000
+
+using grpc::Channel;
+using grpc::ClientContext;
+using etcdserverpb::KV;
+using etcdserverpb::Watch;
+using etcdserverpb::RangeRequest;
+using etcdserverpb::RangeResponse;
+using etcdserverpb::WatchRequest;
+using etcdserverpb::WatchResponse;
+using etcdserverpb::WatchCreateRequest;
+
+/**
+ * Converts the value of a key to config_t, a value not in JSON format is
+ * wrapped into an object with the key as its only member
+ * @param key   - key whose value changed
+ * @param value - new value of the key
+ * @param lazy  - whether the value is only parsed on first access, see
+ *                kv_store_lazy_config_new()
+ * @return config_t on success, NULL on failure
+ */
+static config_t* value_to_config(const std::string& key, const std::string& value, bool lazy) {
+    if (value.empty()) {
+        LOG_ERROR_0("Value shouldn't be empty. Empty string is not supported");
+        return NULL;
+    }
+    if (lazy) {
+        return kv_store_lazy_config_new(key.c_str(), value.data(), value.size());
+    }
+    cJSON* val_json;
+    // Checking if the value updated is not in Json format
+    if (value[0] != '{') {
+        // Creating the cJSON object with Key as key and value as value
+        val_json = cJSON_CreateObject();
+        if(val_json == NULL){
+            LOG_ERROR_0("Create json object failed");
+            return NULL;
+        }
+        cJSON_AddStringToObject(val_json, key.c_str(), value.c_str());
+    } else{
+        // char* to cJSON conversion
+        val_json = cJSON_Parse(value.c_str());
+        if(val_json == NULL){
+            LOG_ERROR_0("cJSON Parse failed");
+            return NULL;
+        }
+    }
+
+    // cJSON to config_t conversion
+    config_t* config = config_new(
+        (void*) val_json, free_json, get_config_value, set_config_value);
+    if (config == NULL) {
+        cJSON_Delete(val_json);
+        LOG_ERROR_0("Failed to initialize configuration object");
+        return NULL;
+    }
+    return config;
+}
+
+/**
+ * Converts the value of a PUT event to config_t and notifies the subscriber
+ * @param sub - subscriber of the event
+ * @param key   - key carried by the event
+ * @param value - value carried by the event
+ */
+static void notify_put(const watch_subscription_t* sub, const std::string& key, const std::string& value) {
+    const char *kvs_key = key.c_str();
+    const char *kvs_value = value.c_str();
+    LOG_DEBUG("key:%s is updated with the value %s", kvs_key, kvs_value);
+
+    config_t* config = value_to_config(key, value, false);
+    if (config == NULL) {
+        return;
+    }
+    sub->user_callback(kvs_key, config, sub->user_data);
+}
+
+/**
+ * Delivers a batch in a single call of the batch callback of a subscriber
+ * @param sub   - subscriber of the batch
+ * @param batch - latest value of every key changed
+ */
+static void notify_batch(const watch_subscription_t* sub, const std::map<std::string, std::string>& batch) {
+    std::vector<const char*> keys;
+    std::vector<config_t*> values;
+    std::map<std::string, std::string>::const_iterator it;
+
+    for (it = batch.begin(); it != batch.end(); ++it) {
+        config_t* config = value_to_config(it->first, it->second, false);
+        if (config == NULL) {
+            continue;
+        }
+        keys.push_back(it->first.c_str());
+        values.push_back(config);
+    }
+    if (!keys.empty()) {
+        sub->batch_callback(keys.data(), values.data(), keys.size(), sub->user_data);
+    }
+}
+
+/**
+ * Converts an event to kv_store_watch_event_t and notifies the subscriber
+ * @param sub   - subscriber of the event
+ * @param event - put or delete event
+ */
+static void notify_event(const watch_subscription_t* sub, const mvccpb::Event& event) {
+    kv_store_watch_event_t watch_event;
+    const char *kvs_key = event.kv().key().c_str();
+
+    watch_event.key = kvs_key;
+    watch_event.mod_revision = event.kv().mod_revision();
+    watch_event.value = NULL;
+    watch_event.prev_value = NULL;
+    if (event.type() == mvccpb::Event::EventType::Event_EventType_DELETE) {
+        LOG_DEBUG("key:%s is deleted", kvs_key);
+        watch_event.type = KV_STORE_EVENT_DELETE;
+    } else {
+        LOG_DEBUG("key:%s is updated with the value %s", kvs_key, event.kv().value().c_str());
+        watch_event.type = KV_STORE_EVENT_PUT;
+        watch_event.value = value_to_config(event.kv().key(), event.kv().value(), sub->lazy_value);
+        if (watch_event.value == NULL) {
+            return;
+        }
+    }
+    // The previous value is only sent if it was requested and the key existed
+    if (event.has_prev_kv() && !event.prev_kv().value().empty()) {
+        watch_event.prev_value = value_to_config(event.kv().key(), event.prev_kv().value(),
+                                                 sub->lazy_value);
+    }
+    sub->event_callback(&watch_event, sub->user_data);
+}
+
+/**
+ * Notifies the subscriber of an event that its watch was created or canceled
+ * @param sub      - subscriber of the watch
+ * @param type     - KV_STORE_EVENT_CREATED or KV_STORE_EVENT_CANCELED
+ * @param revision - revision the watch was created or canceled at
+ */
+static void notify_state(const watch_subscription_t* sub, kv_store_event_type_t type, int64_t revision) {
+    kv_store_watch_event_t watch_event;
+
+    LOG_DEBUG("Watch on key %s %s", sub->create_req.key().c_str(),
+              type == KV_STORE_EVENT_CREATED ? "created" : "canceled");
+    watch_event.type = type;
+    watch_event.key = sub->create_req.key().c_str();
+    watch_event.value = NULL;
+    watch_event.prev_value = NULL;
+    watch_event.mod_revision = revision;
+    sub->event_callback(&watch_event, sub->user_data);
+}
+
+// Process wide poller pool, shared by the WatchManager of every EtcdClient
+static std::mutex pool_mtx;
+static std::weak_ptr<WatchPollerPool> pool_instance;
+
+std::shared_ptr<WatchPollerPool> WatchPollerPool::acquire() {
+    std::lock_guard<std::mutex> lock(pool_mtx);
+    std::shared_ptr<WatchPollerPool> pool = pool_instance.lock();
+    if (pool == NULL) {
+        pool.reset(new WatchPollerPool(WATCH_POLLER_THREADS));
+        pool_instance = pool;
+    }
+    return pool;
+}
+
+WatchPollerPool::WatchPollerPool(int num_pollers) {
+    next = 0;
+    for (int i = 0; i < num_pollers; i++) {
+        cqs.push_back(std::unique_ptr<grpc::CompletionQueue>(new grpc::CompletionQueue()));
+        pollers.push_back(std::thread(&WatchPollerPool::poll, cqs[i].get()));
+    }
+    LOG_DEBUG("Started %d watch poller threads", num_pollers);
+}
+
+grpc::CompletionQueue* WatchPollerPool::next_cq() {
+    std::lock_guard<std::mutex> lock(mtx);
+    grpc::CompletionQueue* cq = cqs[next].get();
+    next = (next + 1) % cqs.size();
+    return cq;
+}
+
+void WatchPollerPool::poll(grpc::CompletionQueue* cq) {
+    void* tag = NULL;
+    bool ok = false;
+    // Next() returns false only once the queue is shut down and drained
+    while (cq->Next(&tag, &ok)) {
+        watch_tag_t* watch_tag = static_cast<watch_tag_t*>(tag);
+        watch_tag->mgr->handle_event(watch_tag, ok);
+    }
+}
+
+WatchPollerPool::~WatchPollerPool() {
+    LOG_DEBUG_0("Stopping watch poller threads");
+    for (size_t i = 0; i < cqs.size(); i++) {
+        cqs[i]->Shutdown();
+    }
+    for (size_t i = 0; i < pollers.size(); i++) {
+        pollers[i].join();
+    }
+}
+
+WatchDispatcher::WatchDispatcher(size_t num_threads, size_t queue_size) {
+    this->queue_size = queue_size;
+    dropped = 0;
+    for (size_t i = 0; i < num_threads; i++) {
+        workers.push_back(std::unique_ptr<dispatcher_worker_t>(new dispatcher_worker_t));
+        workers[i]->stopping = false;
+    }
+    for (size_t i = 0; i < num_threads; i++) {
+        workers[i]->thread = std::thread(&WatchDispatcher::run, workers[i].get());
+    }
+    LOG_DEBUG("Started %d watch dispatcher threads with queues of %d events",
+              (int) num_threads, (int) queue_size);
+}
+
+WatchDispatcher::~WatchDispatcher() {
+    for (size_t i = 0; i < workers.size(); i++) {
+        std::lock_guard<std::mutex> lock(workers[i]->mtx);
+        workers[i]->stopping = true;
+        workers[i]->cv.notify_one();
+    }
+    for (size_t i = 0; i < workers.size(); i++) {
+        workers[i]->thread.join();
+    }
+}
+
+void WatchDispatcher::dispatch(uint64_t slot, const std::string& key,
+                               const std::function<void()>& task, bool coalesce) {
+    // Every task of a watch goes to the same worker, which runs them in
+    // order, so that its created and canceled notices stay in line with
+    // its changes
+    dispatcher_worker_t* worker = workers[slot % workers.size()].get();
+    std::lock_guard<std::mutex> lock(worker->mtx);
+    if (worker->queue.size() >= queue_size && coalesce) {
+        // The latest change of a key supersedes the one still queued
+        std::deque<dispatcher_task_t>::reverse_iterator it;
+        for (it = worker->queue.rbegin(); it != worker->queue.rend(); ++it) {
+            if (it->coalesce && it->slot == slot && it->key == key) {
+                uint64_t num_dropped = ++dropped;
+                LOG_DEBUG("Watch dispatcher queue is full, replacing the queued change of key %s "
+                          "(%llu changes dropped so far)", key.c_str(),
+                          (unsigned long long) num_dropped);
+                it->task = task;
+                return;
+            }
+        }
+        // Only a single change may be dropped, the created and canceled
+        // notices and the batches are always delivered
+        std::deque<dispatcher_task_t>::iterator oldest;
+        for (oldest = worker->queue.begin(); oldest != worker->queue.end(); ++oldest) {
+            if (oldest->coalesce) {
+                uint64_t num_dropped = ++dropped;
+                LOG_ERROR("Watch dispatcher queue is full, dropping the oldest change of key %s "
+                          "(%llu changes dropped so far)", oldest->key.c_str(),
+                          (unsigned long long) num_dropped);
+                worker->queue.erase(oldest);
+                break;
+            }
+        }
+    }
+    dispatcher_task_t queued;
+    queued.slot = slot;
+    queued.key = key;
+    queued.task = task;
+    queued.coalesce = coalesce;
+    worker->queue.push_back(queued);
+    worker->cv.notify_one();
+}
+
+uint64_t WatchDispatcher::get_dropped() {
+    return dropped;
+}
+
+void WatchDispatcher::run(dispatcher_worker_t* worker) {
+    std::unique_lock<std::mutex> lock(worker->mtx);
+    while (true) {
+        worker->cv.wait(lock, [worker] { return worker->stopping || !worker->queue.empty(); });
+        // Tasks still queued on shutdown are dropped
+        if (worker->stopping) {
+            return;
+        }
+        std::function<void()> task;
+        task.swap(worker->queue.front().task);
+        worker->queue.pop_front();
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+WatchManager::WatchManager(const std::vector<std::shared_ptr<Channel> >& channels) {
+    for (size_t i = 0; i < channels.size(); i++) {
+        watch_stubs.push_back(Watch::NewStub(channels[i]));
+        kv_stubs.push_back(KV::NewStub(channels[i]));
+    }
+    member = 0;
+    pool = WatchPollerPool::acquire();
+    cq = pool->next_cq();
+
+    start_tag.mgr = read_tag.mgr = write_tag.mgr = this;
+    finish_tag.mgr = retry_tag.mgr = batch_tag.mgr = this;
+    start_tag.op = WATCH_OP_START;
+    read_tag.op = WATCH_OP_READ;
+    write_tag.op = WATCH_OP_WRITE;
+    finish_tag.op = WATCH_OP_FINISH;
+    retry_tag.op = WATCH_OP_RETRY;
+    batch_tag.op = WATCH_OP_BATCH;
+
+    running = true;
+    held = false;
+    stream_broken = false;
+    start_in_flight = false;
+    read_in_flight = false;
+    write_in_flight = false;
+    finish_in_flight = false;
+    retry_in_flight = false;
+    batch_in_flight = false;
+    stream_id = 0;
+    reconnects = 0;
+    etcd_retry_policy_default(&retry_policy);
+}
+
+void WatchManager::set_retry_policy(const etcd_retry_policy_t& policy) {
+    std::lock_guard<std::mutex> lock(mtx);
+    retry_policy = policy;
+}
+
+void WatchManager::set_dispatcher(size_t num_threads, size_t queue_size) {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!subscriptions.empty()) {
+        LOG_ERROR_0("Watch dispatcher must be set before the first watch");
+        return;
+    }
+    if (num_threads == 0) {
+        dispatcher.reset();
+    } else {
+        dispatcher.reset(new WatchDispatcher(num_threads, queue_size));
+    }
+}
+
+uint64_t WatchManager::get_dropped_events() {
+    return dispatcher != NULL ? dispatcher->get_dropped() : 0;
+}
+
+void WatchManager::add_watch(const WatchCreateRequest& create_req,
+                             kv_store_watch_callback_t user_callback, void* user_data) {
+    std::shared_ptr<watch_subscription_t> sub(new watch_subscription_t);
+    sub->create_req.CopyFrom(create_req);
+    sub->user_callback = user_callback;
+    sub->user_data = user_data;
+    sub->event_callback = NULL;
+    sub->lazy_value = false;
+    sub->batch_callback = NULL;
+    sub->window_ms = 0;
+    sub->revision = create_req.start_revision() > 0 ? create_req.start_revision() - 1 : 0;
+    register_watch(sub);
+}
+
+void WatchManager::add_event_watch(const WatchCreateRequest& create_req,
+                                   kv_store_watch_event_callback_t event_callback, void* user_data,
+                                   bool lazy_value) {
+    std::shared_ptr<watch_subscription_t> sub(new watch_subscription_t);
+    sub->create_req.CopyFrom(create_req);
+    sub->user_callback = NULL;
+    sub->user_data = user_data;
+    sub->event_callback = event_callback;
+    sub->lazy_value = lazy_value;
+    sub->batch_callback = NULL;
+    sub->window_ms = 0;
+    sub->revision = create_req.start_revision() > 0 ? create_req.start_revision() - 1 : 0;
+    register_watch(sub);
+}
+
+void WatchManager::add_batched_watch(const WatchCreateRequest& create_req, int window_ms,
+                                     kv_store_watch_batch_callback_t batch_callback, void* user_data) {
+    std::shared_ptr<watch_subscription_t> sub(new watch_subscription_t);
+    sub->create_req.CopyFrom(create_req);
+    sub->user_callback = NULL;
+    sub->user_data = user_data;
+    sub->event_callback = NULL;
+    sub->lazy_value = false;
+    sub->batch_callback = batch_callback;
+    sub->window_ms = window_ms;
+    sub->revision = create_req.start_revision() > 0 ? create_req.start_revision() - 1 : 0;
+    register_watch(sub);
+}
+
+void WatchManager::register_watch(std::shared_ptr<watch_subscription_t> sub) {
+    std::lock_guard<std::mutex> lock(mtx);
+    sub->dispatch_slot = subscriptions.size();
+    subscriptions.push_back(sub);
+    if (held) {
+        // Registered once the stream is opened on release()
+        return;
+    }
+    if (is_idle()) {
+        // First watch of this client, the new stream registers it
+        start_stream();
+    } else if (stream != NULL && !stream_broken) {
+        send_create_request(sub);
+    }
+    // Otherwise the stream is being re-established and registers
+    // every subscription once it is opened
+}
+
+void WatchManager::hold() {
+    std::lock_guard<std::mutex> lock(mtx);
+    held = true;
+}
+
+void WatchManager::release() {
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!held) {
+        return;
+    }
+    held = false;
+    if (running && is_idle() && !subscriptions.empty()) {
+        start_stream();
+    }
+}
+
+bool WatchManager::is_idle() {
+    return stream == NULL && !retry_in_flight;
+}
+
+bool WatchManager::is_drained() {
+    return is_idle() && !batch_in_flight && resyncs.empty();
+}
+
+void WatchManager::start_stream() {
+    context.reset(new ClientContext());
+    stream = watch_stubs[member]->PrepareAsyncWatch(context.get(), cq);
+    stream_broken = false;
+    stream_id++;
+    pending.clear();
+    watchers.clear();
+    write_queue.clear();
+
+    start_in_flight = true;
+    stream->StartCall(&start_tag);
+    for (size_t i = 0; i < subscriptions.size(); i++) {
+        send_create_request(subscriptions[i]);
+    }
+}
+
+void WatchManager::send_create_request(std::shared_ptr<watch_subscription_t> sub) {
+    WatchRequest watch_req;
+    watch_req.mutable_create_request()->CopyFrom(sub->create_req);
+    if (sub->revision > 0) {
+        // Resume right after the last revision delivered to the subscriber
+        watch_req.mutable_create_request()->set_start_revision(sub->revision + 1);
+    }
+    pending.push_back(sub);
+    write_queue.push_back(watch_req);
+    flush_writes();
+}
+
+void WatchManager::flush_writes() {
+    // Only one write may be outstanding on an async stream at a time
+    if (start_in_flight || write_in_flight || stream_broken || write_queue.empty()) {
+        return;
+    }
+    write_in_flight = true;
+    stream->Write(write_queue.front(), &write_tag);
+}
+
+void WatchManager::break_stream() {
+    if (!stream_broken) {
+        stream_broken = true;
+        // Forces the outstanding read to complete
+        context->TryCancel();
+    }
+}
+
+void WatchManager::reap_stream() {
+    LOG_DEBUG("Watch stream closed (%s)", finish_status.error_message().c_str());
+    stream.reset();
+    context.reset();
+    if (running) {
+        // Reconnects to the next member, the broken stream may be the one
+        // of a member gone down
+        member = (member + 1) % watch_stubs.size();
+        // Backs off further on every reconnect until a watch is created
+        // again, so that a flapping etcd server is not hammered
+        int backoff_ms = etcd_retry_backoff_ms(&retry_policy, reconnects++);
+        LOG_DEBUG("Re-registering %d watches in %d ms...",
+                  (int) subscriptions.size(), backoff_ms);
+        gpr_timespec deadline = gpr_time_add(
+            gpr_now(GPR_CLOCK_MONOTONIC),
+            gpr_time_from_millis(backoff_ms, GPR_TIMESPAN));
+        retry_in_flight = true;
+        retry_alarm.Set(cq, deadline, &retry_tag);
+    }
+}
+
+void WatchManager::handle_event(watch_tag_t* tag, bool ok) {
+    bool has_response = false;
+    bool has_batches = false;
+    std::unique_ptr<resync_call_t> resynced;
+    std::vector<std::shared_ptr<watch_subscription_t> > lost;
+
+    std::unique_lock<std::mutex> lock(mtx);
+    switch (tag->op) {
+        case WATCH_OP_START:
+            start_in_flight = false;
+            if (ok && !stream_broken) {
+                read_in_flight = true;
+                stream->Read(&reply, &read_tag);
+                flush_writes();
+            } else {
+                break_stream();
+            }
+            break;
+        case WATCH_OP_READ:
+            read_in_flight = false;
+            if (ok && !stream_broken) {
+                // Every event of this stream is handled by the same poller
+                // thread, so the next read can be posted before processing.
+                // The previous batch is parsed into by that read, reusing
+                // its events and their buffers
+                delivered.Swap(&reply);
+                has_response = true;
+                read_in_flight = true;
+                stream->Read(&reply, &read_tag);
+            } else {
+                break_stream();
+            }
+            break;
+        case WATCH_OP_WRITE:
+            write_in_flight = false;
+            if (ok && !stream_broken) {
+                write_queue.pop_front();
+                flush_writes();
+            } else {
+                break_stream();
+            }
+            break;
+        case WATCH_OP_FINISH:
+            finish_in_flight = false;
+            // The watches of the stream are gone until it is reopened
+            if (running) {
+                std::map<int64_t, std::shared_ptr<watch_subscription_t> >::iterator it;
+                for (it = watchers.begin(); it != watchers.end(); ++it) {
+                    lost.push_back(it->second);
+                }
+            }
+            watchers.clear();
+            reap_stream();
+            break;
+        case WATCH_OP_RETRY:
+            retry_in_flight = false;
+            if (running) {
+                start_stream();
+            }
+            break;
+        case WATCH_OP_RESYNC:
+            // Processed below and released once its callbacks are dispatched
+            resynced.swap(resyncs[tag]);
+            break;
+        case WATCH_OP_BATCH:
+            // Delivered below, batch_in_flight is cleared once done so
+            // that the destructor waits for the batches to be dispatched
+            has_batches = true;
+            break;
+    }
+
+    // A broken stream is finished once nothing else is outstanding on it
+    if (stream != NULL && stream_broken && !start_in_flight && !read_in_flight
+            && !write_in_flight && !finish_in_flight) {
+        finish_in_flight = true;
+        stream->Finish(&finish_status, &finish_tag);
+    }
+
+    lock.unlock();
+
+    if (has_response) {
+        process_response(delivered);
+    }
+    if (has_batches) {
+        deliver_batches();
+    }
+    for (size_t i = 0; i < lost.size(); i++) {
+        notify_state_change(lost[i], KV_STORE_EVENT_CANCELED, lost[i]->revision);
+    }
+    if (resynced != NULL) {
+        complete_resync(resynced.get());
+        lock.lock();
+        resyncs.erase(tag);
+    } else {
+        lock.lock();
+    }
+    if (has_batches) {
+        batch_in_flight = false;
+        if (running) {
+            schedule_next_batch();
+        }
+    }
+    // The destructor may return as soon as the lock is released, this is
+    // the last access to this object
+    if (is_drained()) {
+        cv.notify_all();
+    }
+}
+void WatchManager::process_response(const WatchResponse& reply) {
+    std::shared_ptr<watch_subscription_t> sub;
+    bool compacted = false;
+    bool created = false;
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        if (reply.created()) {
+            if (pending.empty()) {
+                LOG_ERROR("Unexpected created response for watch %ld",
+                          (long) reply.watch_id());
+                return;
+            }
+            sub = pending.front();
+            pending.pop_front();
+            if (reply.canceled() && reply.compact_revision() == 0) {
+                LOG_ERROR("etcd refused watch on key %s",
+                          sub->create_req.key().c_str());
+                lock.unlock();
+                notify_state_change(sub, KV_STORE_EVENT_CANCELED, reply.header().revision());
+                return;
+            }
+            if (!reply.canceled()) {
+                reconnects = 0;
+                created = true;
+                watchers[reply.watch_id()] = sub;
+                LOG_DEBUG("Watch %ld created for key %s", (long) reply.watch_id(),
+                          sub->create_req.key().c_str());
+            }
+            // A fresh watch sees every change made after the revision it
+            // was created at, which is where a later resumption starts from
+            if (sub->revision == 0) {
+                sub->revision = reply.header().revision();
+            }
+        } else {
+            std::map<int64_t, std::shared_ptr<watch_subscription_t> >::iterator it;
+            it = watchers.find(reply.watch_id());
+            if (it == watchers.end()) {
+                LOG_DEBUG("Response for unknown watch %ld dropped",
+                          (long) reply.watch_id());
+                return;
+            }
+            sub = it->second;
+            if (reply.canceled()) {
+                watchers.erase(it);
+            }
+        }
+        if (reply.canceled()) {
+            if (reply.compact_revision() == 0) {
+                LOG_ERROR("Watch on key %s canceled by etcd",
+                          sub->create_req.key().c_str());
+                lock.unlock();
+                notify_state_change(sub, KV_STORE_EVENT_CANCELED, reply.header().revision());
+                return;
+            }
+            compacted = true;
+        }
+    }
+
+    if (created) {
+        notify_state_change(sub, KV_STORE_EVENT_CREATED, reply.header().revision());
+    }
+
+    if (compacted) {
+        // Revisions up to compact_revision are gone, the missed changes
+        // are recovered from the current state of the watched range
+        LOG_WARN("Watch on key %s compacted at revision %ld, resyncing",
+                 sub->create_req.key().c_str(), (long) reply.compact_revision());
+        resync(sub);
+        return;
+    }
+
+    // Callbacks are invoked without holding mtx so that they are free
+    // to register further watches. Events at or below the delivered
+    // revision are replays of a resumed watch and are skipped
+    int64_t delivered = sub->revision;
+    for (int cnt = 0; cnt < reply.events_size(); cnt++) {
+        const mvccpb::Event& event = reply.events(cnt);
+        int64_t mod_revision = event.kv().mod_revision();
+        if (mod_revision <= delivered) {
+            continue;
+        }
+        deliver(sub.get(), event);
+        if (mod_revision > sub->revision) {
+            sub->revision = mod_revision;
+        }
+    }
+    end_batch(sub);
+}
+
+void WatchManager::dispatch(watch_subscription_t* sub, const std::string& key,
+                            const std::function<void()>& task, bool coalesce) {
+    if (dispatcher == NULL) {
+        task();
+    } else {
+        dispatcher->dispatch(sub->dispatch_slot, key, task, coalesce);
+    }
+}
+
+void WatchManager::notify_state_change(std::shared_ptr<watch_subscription_t> sub,
+                                       kv_store_event_type_t type, int64_t revision) {
+    if (sub->event_callback == NULL) {
+        return;
+    }
+    dispatch(sub.get(), sub->create_req.key(),
+             [sub, type, revision] { notify_state(sub.get(), type, revision); }, false);
+}
+
+void WatchManager::deliver(watch_subscription_t* sub, const mvccpb::Event& event) {
+    const mvccpb::KeyValue& kvs = event.kv();
+    if (sub->event_callback != NULL) {
+        if (event.type() == mvccpb::Event::EventType::Event_EventType_DELETE) {
+            sub->keys.erase(kvs.key());
+        } else {
+            sub->keys.insert(kvs.key());
+        }
+        std::shared_ptr<mvccpb::Event> copy(new mvccpb::Event(event));
+        dispatch(sub, kvs.key(), [sub, copy] { notify_event(sub, *copy); });
+        return;
+    }
+    if (event.type() == mvccpb::Event::EventType::Event_EventType_DELETE) {
+        // Deletes are only notified to event callbacks, a key deleted
+        // within the window is left out of the batch
+        if (sub->batch_callback != NULL) {
+            sub->batch.erase(kvs.key());
+        }
+        return;
+    }
+    if (sub->batch_callback == NULL) {
+        std::string key = kvs.key();
+        std::string value = kvs.value();
+        dispatch(sub, key, [sub, key, value] { notify_put(sub, key, value); });
+        return;
+    }
+    // Later changes of a key replace the earlier ones in the batch
+    if (sub->batch.empty()) {
+        sub->batch_deadline = std::chrono::steady_clock::now() +
+                              std::chrono::milliseconds(sub->window_ms);
+    }
+    sub->batch[kvs.key()] = kvs.value();
+}
+
+void WatchManager::end_batch(std::shared_ptr<watch_subscription_t> sub) {
+    if (sub->batch_callback == NULL || sub->batch.empty()) {
+        return;
+    }
+    if (sub->window_ms == 0) {
+        dispatch_batch(sub.get());
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mtx);
+    if (running) {
+        schedule_batch(sub->batch_deadline);
+    }
+}
+
+void WatchManager::schedule_batch(std::chrono::steady_clock::time_point deadline) {
+    if (batch_in_flight) {
+        // The alarm reschedules itself for the earliest batch once fired
+        if (deadline < batch_alarm_deadline) {
+            batch_alarm.Cancel();
+        }
+        return;
+    }
+    std::chrono::steady_clock::duration delay = deadline - std::chrono::steady_clock::now();
+    gpr_timespec alarm_deadline = gpr_time_add(
+        gpr_now(GPR_CLOCK_MONOTONIC),
+        gpr_time_from_micros(std::chrono::duration_cast<std::chrono::microseconds>(delay).count(),
+                             GPR_TIMESPAN));
+    batch_in_flight = true;
+    batch_alarm_deadline = deadline;
+    batch_alarm.Set(cq, alarm_deadline, &batch_tag);
+}
+
+void WatchManager::dispatch_batch(watch_subscription_t* sub) {
+    std::shared_ptr<std::map<std::string, std::string> > batch(
+        new std::map<std::string, std::string>);
+    batch->swap(sub->batch);
+    LOG_DEBUG("Delivering %d changed keys of the watch on key %s",
+              (int) batch->size(), sub->create_req.key().c_str());
+    // A batch holds the changes of several keys, none replaces it
+    dispatch(sub, sub->create_req.key(), [sub, batch] { notify_batch(sub, *batch); }, false);
+}
+
+void WatchManager::deliver_batches() {
+    std::vector<std::shared_ptr<watch_subscription_t> > due;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (running) {
+            for (size_t i = 0; i < subscriptions.size(); i++) {
+                if (!subscriptions[i]->batch.empty() && subscriptions[i]->batch_deadline <= now) {
+                    due.push_back(subscriptions[i]);
+                }
+            }
+        }
+    }
+
+    // batch_in_flight stays set while delivering, so that the destructor
+    // waits for the callbacks to return
+    for (size_t i = 0; i < due.size(); i++) {
+        dispatch_batch(due[i].get());
+    }
+}
+
+void WatchManager::schedule_next_batch() {
+    bool pending = false;
+    std::chrono::steady_clock::time_point next;
+    for (size_t i = 0; i < subscriptions.size(); i++) {
+        if (!subscriptions[i]->batch.empty() &&
+                (!pending || subscriptions[i]->batch_deadline < next)) {
+            next = subscriptions[i]->batch_deadline;
+            pending = true;
+        }
+    }
+    if (pending) {
+        schedule_batch(next);
+    }
+}
+
+void WatchManager::resync(std::shared_ptr<watch_subscription_t> sub) {
+    std::unique_ptr<resync_call_t> call(new resync_call_t);
+    RangeRequest range_req;
+
+    call->tag.mgr = this;
+    call->tag.op = WATCH_OP_RESYNC;
+    call->sub = sub;
+    range_req.set_key(sub->create_req.key());
+    range_req.set_range_end(sub->create_req.range_end());
+    call->context.set_deadline(std::chrono::system_clock::now() +
+                               std::chrono::milliseconds(WATCH_RESYNC_TIMEOUT_MS));
+
+    // Read on the completion queue of the stream, so that the poller thread
+    // is not blocked and the range is processed on the thread of the stream
+    std::lock_guard<std::mutex> lock(mtx);
+    if (!running) {
+        return;
+    }
+    call->stream_id = stream_id;
+    call->reader = kv_stubs[member]->PrepareAsyncRange(&call->context, range_req, cq);
+    call->reader->StartCall();
+    call->reader->Finish(&call->reply, &call->status, &call->tag);
+    resyncs[&call->tag] = std::move(call);
+}
+
+void WatchManager::complete_resync(resync_call_t* call) {
+    watch_subscription_t* sub = call->sub.get();
+    const RangeResponse& range_resp = call->reply;
+
+    if (!call->status.ok()) {
+        LOG_ERROR("Resync of key %s failed with Error:%s",
+                  sub->create_req.key().c_str(), call->status.error_message().c_str());
+        // Reopening the stream retries the resumption and so the resync
+        std::lock_guard<std::mutex> lock(mtx);
+        if (stream != NULL && call->stream_id == stream_id) {
+            break_stream();
+        }
+        return;
+    }
+
+    // Only keys modified after the last delivered revision have changed,
+    // and the keys delivered but missing from the range have been deleted.
+    // Previous values within the compacted revisions are lost
+    std::set<std::string> deleted;
+    deleted.swap(sub->keys);
+    for (int i = 0; i < range_resp.kvs_size(); i++) {
+        const mvccpb::KeyValue& kvs = range_resp.kvs(i);
+        if (deleted.erase(kvs.key()) > 0) {
+            sub->keys.insert(kvs.key());
+        }
+        if (kvs.mod_revision() > sub->revision) {
+            mvccpb::Event event;
+            event.set_type(mvccpb::Event::EventType::Event_EventType_PUT);
+            event.mutable_kv()->CopyFrom(kvs);
+            deliver(sub, event);
+        }
+    }
+    std::set<std::string>::iterator it;
+    for (it = deleted.begin(); it != deleted.end(); ++it) {
+        // The revision of the delete is compacted, the one read is used
+        mvccpb::Event event;
+        event.set_type(mvccpb::Event::EventType::Event_EventType_DELETE);
+        event.mutable_kv()->set_key(*it);
+        event.mutable_kv()->set_mod_revision(range_resp.header().revision());
+        deliver(sub, event);
+    }
+    end_batch(call->sub);
+    if (range_resp.header().revision() > sub->revision) {
+        sub->revision = range_resp.header().revision();
+    }
+
+    // A stream opened meanwhile has registered the watch already
+    std::lock_guard<std::mutex> lock(mtx);
+    if (stream != NULL && !stream_broken && call->stream_id == stream_id) {
+        send_create_request(call->sub);
+    }
+}
+
+WatchManager::~WatchManager() {
+    LOG_DEBUG_0("WatchManager Destructor is called");
+    std::unique_lock<std::mutex> lock(mtx);
+    running = false;
+    if (stream != NULL) {
+        break_stream();
+    }
+    if (retry_in_flight) {
+        retry_alarm.Cancel();
+    }
+    if (batch_in_flight) {
+        batch_alarm.Cancel();
+    }
+    std::map<watch_tag_t*, std::unique_ptr<resync_call_t> >::iterator it;
+    for (it = resyncs.begin(); it != resyncs.end(); ++it) {
+        if (it->second != NULL) {
+            it->second->context.TryCancel();
+        }
+    }
+    // Wait for the poller to drain every operation of this stream so that
+    // no tag referring to this object is left on the completion queue
+    cv.wait(lock, [this] { return is_drained(); });
+    lock.unlock();
+    // Joins the dispatcher threads once the callbacks running have returned
+    dispatcher.reset();
+}
@@ -0,0 +1,571 @@
+// Copyright (c) 2021 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @file
+ * @brief KV Store read cache implementation
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <eii/config_manager/kv_store_plugin/kv_store_cache.h>
+
+#include <safe_lib.h>
+
+#define KV_STORE_CACHE_BUCKETS 64
+
+/**
+ * Cached value of a key, chained in its hash bucket
+ */
+typedef struct kv_store_cache_entry {
+    char* key;
+    char* value;
+    struct kv_store_cache_entry* next;
+} kv_store_cache_entry_t;
+
+typedef struct kv_store_cache kv_store_cache_t;
+
+/**
+ * Cached key prefix and the state of its watch
+ */
+typedef struct {
+    kv_store_cache_t* cache;
+    char* prefix;
+    size_t prefix_len;
+
+    // Whether the watch of the prefix is created, the keys under the
+    // prefix are only cached while it is. Guarded by the mtx of the cache
+    bool live;
+} kv_store_cache_prefix_t;
+
+/**
+ * Cache state, held as the handler of the wrapping kv_store_client_t
+ */
+struct kv_store_cache {
+    // Wrapped client and its handle
+    kv_store_client_t* kv_store_client;
+    void* handle;
+
+    // Cached key prefixes, each with its own watch
+    kv_store_cache_prefix_t* prefixes;
+    size_t num_prefixes;
+
+    // Guards every member below
+    pthread_mutex_t mtx;
+    kv_store_cache_entry_t* buckets[KV_STORE_CACHE_BUCKETS];
+
+    // Bumped on every invalidation, a value read from the kv store is only
+    // cached if no change was notified while it was being read
+    uint64_t generation;
+
+    kv_store_cache_stats_t stats;
+};
+
+static size_t cache_hash(const char* key) {
+    // djb2
+    size_t hash = 5381;
+    for (const char* c = key; *c != '\0'; c++) {
+        hash = ((hash << 5) + hash) + (unsigned char)*c;
+    }
+    return hash % KV_STORE_CACHE_BUCKETS;
+}
+
+static char* cache_strdup(const char* src) {
+    size_t len = strlen(src) + 1;
+    char* dest = (char*)malloc(len);
+    if (dest == NULL) {
+        LOG_ERROR_0("Failed to allocate memory");
+        return NULL;
+    }
+    int ret = strcpy_s(dest, len, src);
+    if (ret != 0) {
+        LOG_ERROR_0("Failed to copy the cached string");
+        free(dest);
+        return NULL;
+    }
+    return dest;
+}
+
+// Returns the cached prefix key falls under, NULL if it is not cached
+static kv_store_cache_prefix_t* cache_prefix_of(kv_store_cache_t* cache, const char* key) {
+    for (size_t i = 0; i < cache->num_prefixes; i++) {
+        kv_store_cache_prefix_t* prefix = &cache->prefixes[i];
+        if (strncmp(key, prefix->prefix, prefix->prefix_len) == 0) {
+            return prefix;
+        }
+    }
+    return NULL;
+}
+
+static void cache_entry_free(kv_store_cache_entry_t* entry) {
+    free(entry->key);
+    free(entry->value);
+    free(entry);
+}
+
+static void cache_prefixes_free(kv_store_cache_t* cache) {
+    if (cache->prefixes == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < cache->num_prefixes; i++) {
+        free(cache->prefixes[i].prefix);
+    }
+    free(cache->prefixes);
+}
+
+// Below helpers must be called with mtx held
+
+// Returns a copy of the cached value of key, NULL if it is not cached
+static char* cache_lookup(kv_store_cache_t* cache, const char* key, bool* found) {
+    *found = false;
+    kv_store_cache_entry_t* entry = cache->buckets[cache_hash(key)];
+    for (; entry != NULL; entry = entry->next) {
+        if (strcmp(entry->key, key) == 0) {
+            char* value = cache_strdup(entry->value);
+            *found = value != NULL;
+            return value;
+        }
+    }
+    return NULL;
+}
+
+static void cache_insert(kv_store_cache_t* cache, const char* key, const char* value) {
+    size_t bucket = cache_hash(key);
+    kv_store_cache_entry_t* entry = cache->buckets[bucket];
+    for (; entry != NULL; entry = entry->next) {
+        if (strcmp(entry->key, key) == 0) {
+            char* copy = cache_strdup(value);
+            if (copy != NULL) {
+                free(entry->value);
+                entry->value = copy;
+            }
+            return;
+        }
+    }
+    entry = (kv_store_cache_entry_t*)calloc(1, sizeof(kv_store_cache_entry_t));
+    if (entry == NULL) {
+        LOG_ERROR_0("Failed to allocate memory for the cache entry");
+        return;
+    }
+    entry->key = cache_strdup(key);
+    entry->value = cache_strdup(value);
+    if (entry->key == NULL || entry->value == NULL) {
+        cache_entry_free(entry);
+        return;
+    }
+    entry->next = cache->buckets[bucket];
+    cache->buckets[bucket] = entry;
+    cache->stats.entries++;
+}
+
+// Drops the entries of key. The key notified by the watch may carry a
+// prefix added by the kv store (ex: ETCD_PREFIX), so every entry whose
+// key ends the notified key is dropped
+static void cache_invalidate(kv_store_cache_t* cache, const char* key) {
+    size_t key_len = strlen(key);
+    cache->generation++;
+    for (int i = 0; i < KV_STORE_CACHE_BUCKETS; i++) {
+        kv_store_cache_entry_t** link = &cache->buckets[i];
+        while (*link != NULL) {
+            kv_store_cache_entry_t* entry = *link;
+            size_t entry_len = strlen(entry->key);
+            if (entry_len <= key_len &&
+                    strcmp(key + key_len - entry_len, entry->key) == 0) {
+                *link = entry->next;
+                cache_entry_free(entry);
+                cache->stats.entries--;
+                cache->stats.invalidations++;
+            } else {
+                link = &entry->next;
+            }
+        }
+    }
+}
+
+// Drops every entry under prefix
+static void cache_flush(kv_store_cache_t* cache, kv_store_cache_prefix_t* prefix) {
+    cache->generation++;
+    for (int i = 0; i < KV_STORE_CACHE_BUCKETS; i++) {
+        kv_store_cache_entry_t** link = &cache->buckets[i];
+        while (*link != NULL) {
+            kv_store_cache_entry_t* entry = *link;
+            if (strncmp(entry->key, prefix->prefix, prefix->prefix_len) == 0) {
+                *link = entry->next;
+                cache_entry_free(entry);
+                cache->stats.entries--;
+                cache->stats.invalidations++;
+            } else {
+                link = &entry->next;
+            }
+        }
+    }
+}
+
+static void cache_watch_cb(const kv_store_watch_event_t* event, void* user_data) {
+    kv_store_cache_prefix_t* prefix = (kv_store_cache_prefix_t*)user_data;
+    kv_store_cache_t* cache = prefix->cache;
+    pthread_mutex_lock(&cache->mtx);
+    switch (event->type) {
+        case KV_STORE_EVENT_CREATED:
+            // Values read before the watch was created may have missed a
+            // change, only the ones read from now on are cached
+            LOG_DEBUG("Caching the keys under %s", prefix->prefix);
+            prefix->live = true;
+            cache->generation++;
+            break;
+        case KV_STORE_EVENT_CANCELED:
+            // Changes are not notified anymore, the keys are read from the
+            // kv store until the watch is created again
+            LOG_WARN("Watch on %s lost, bypassing the cache for its keys", prefix->prefix);
+            prefix->live = false;
+            cache_flush(cache, prefix);
+            break;
+        default:
+            // Both puts and deletes make the cached value stale
+            LOG_DEBUG("Invalidating the cached key %s", event->key);
+            cache_invalidate(cache, event->key);
+            break;
+    }
+    pthread_mutex_unlock(&cache->mtx);
+    if (event->value != NULL) {
+        config_destroy(event->value);
+    }
+    if (event->prev_value != NULL) {
+        config_destroy(event->prev_value);
+    }
+}
+
+static void* kv_store_cache_init(void* kv_store_client) {
+    kv_store_client_t* client = (kv_store_client_t*)kv_store_client;
+    kv_store_cache_t* cache = (kv_store_cache_t*)client->handler;
+    kv_store_client_t* inner = cache->kv_store_client;
+
+    cache->handle = inner->init(inner);
+    if (cache->handle == NULL) {
+        LOG_ERROR_0("Failed to initialize the cached kv store client");
+        return NULL;
+    }
+    kv_store_watch_options_t opts = {0};
+    opts.prefix = true;
+    for (size_t i = 0; i < cache->num_prefixes; i++) {
+        kv_store_cache_prefix_t* prefix = &cache->prefixes[i];
+        if (inner->watch_events(cache->handle, prefix->prefix, &opts, cache_watch_cb, prefix) != 0) {
+            LOG_WARN("Failed to watch %s, its keys are not cached", prefix->prefix);
+        }
+    }
+    return cache;
+}
+
+static char* kv_store_cache_get(void* handle, char* key) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    kv_store_client_t* inner = cache->kv_store_client;
+    kv_store_cache_prefix_t* prefix = cache_prefix_of(cache, key);
+    if (prefix == NULL) {
+        return inner->get(cache->handle, key);
+    }
+
+    bool found = false;
+    pthread_mutex_lock(&cache->mtx);
+    if (!prefix->live) {
+        cache->stats.bypasses++;
+        pthread_mutex_unlock(&cache->mtx);
+        return inner->get(cache->handle, key);
+    }
+    char* value = cache_lookup(cache, key, &found);
+    if (found) {
+        cache->stats.hits++;
+        pthread_mutex_unlock(&cache->mtx);
+        return value;
+    }
+    cache->stats.misses++;
+    uint64_t generation = cache->generation;
+    pthread_mutex_unlock(&cache->mtx);
+
+    value = inner->get(cache->handle, key);
+    if (value != NULL) {
+        pthread_mutex_lock(&cache->mtx);
+        if (generation == cache->generation && prefix->live) {
+            cache_insert(cache, key, value);
+        }
+        pthread_mutex_unlock(&cache->mtx);
+    }
+    return value;
+}
+
+static char** kv_store_cache_get_many(void* handle, char** keys, size_t num_keys) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    kv_store_client_t* inner = cache->kv_store_client;
+    char** values = NULL;
+    char** miss_keys = NULL;
+    char** miss_values = NULL;
+    size_t* miss_index = NULL;
+    size_t num_miss = 0;
+    uint64_t generation = 0;
+
+    values = (char**)calloc(num_keys, sizeof(char*));
+    miss_keys = (char**)calloc(num_keys, sizeof(char*));
+    miss_index = (size_t*)calloc(num_keys, sizeof(size_t));
+    if (values == NULL || miss_keys == NULL || miss_index == NULL) {
+        LOG_ERROR_0("Failed to allocate memory for get_many");
+        goto err;
+    }
+
+    pthread_mutex_lock(&cache->mtx);
+    for (size_t i = 0; i < num_keys; i++) {
+        bool found = false;
+        kv_store_cache_prefix_t* prefix = cache_prefix_of(cache, keys[i]);
+        if (prefix != NULL && !prefix->live) {
+            cache->stats.bypasses++;
+        } else if (prefix != NULL) {
+            values[i] = cache_lookup(cache, keys[i], &found);
+            if (found) {
+                cache->stats.hits++;
+                continue;
+            }
+            cache->stats.misses++;
+        }
+        miss_keys[num_miss] = keys[i];
+        miss_index[num_miss] = i;
+        num_miss++;
+    }
+    generation = cache->generation;
+    pthread_mutex_unlock(&cache->mtx);
+
+    if (num_miss != 0) {
+        miss_values = inner->get_many(cache->handle, miss_keys, num_miss);
+        if (miss_values == NULL) {
+            goto err;
+        }
+        pthread_mutex_lock(&cache->mtx);
+        for (size_t i = 0; i < num_miss; i++) {
+            values[miss_index[i]] = miss_values[i];
+            if (miss_values[i] == NULL || generation != cache->generation) {
+                continue;
+            }
+            kv_store_cache_prefix_t* prefix = cache_prefix_of(cache, miss_keys[i]);
+            if (prefix != NULL && prefix->live) {
+                cache_insert(cache, miss_keys[i], miss_values[i]);
+            }
+        }
+        pthread_mutex_unlock(&cache->mtx);
+        free(miss_values);
+    }
+
+    free(miss_keys);
+    free(miss_index);
+    return values;
+err:
+    if (values != NULL) {
+        for (size_t i = 0; i < num_keys; i++) {
+            free(values[i]);
+        }
+        free(values);
+    }
+    if (miss_keys != NULL) {
+        free(miss_keys);
+    }
+    if (miss_index != NULL) {
+        free(miss_index);
+    }
+    return NULL;
+}
+
+static char* kv_store_cache_get_prefix(void* handle, char* key) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    return cache->kv_store_client->get_prefix(cache->handle, key);
+}
+
+static config_value_t* kv_store_cache_get_prefix_with_options(void* handle, char* key,
+                                                             const kv_store_read_options_t* opts) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    return cache->kv_store_client->get_prefix_with_options(cache->handle, key, opts);
+}
+
+static int kv_store_cache_scan_prefix(void* handle, char* key, size_t page_size,
+                                      kv_store_scan_callback_t cb, void* user_data) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    return cache->kv_store_client->scan_prefix(cache->handle, key, page_size, cb, user_data);
+}
+
+static int kv_store_cache_prefetch(void* handle, char** prefixes, size_t num_prefixes) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    return cache->kv_store_client->prefetch(cache->handle, prefixes, num_prefixes);
+}
+
+// Views are not cached, they are read from the wrapped client
+static int kv_store_cache_get_view(void* handle, char** keys, size_t num_keys, kv_store_value_view_t* views) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    return cache->kv_store_client->get_view(cache->handle, keys, num_keys, views);
+}
+
+static void kv_store_cache_release_view(void* handle, kv_store_value_view_t* view) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    cache->kv_store_client->release_view(cache->handle, view);
+}
+
+static int kv_store_cache_put(void* handle, char* key, char* value) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    int ret = cache->kv_store_client->put(cache->handle, key, value);
+    // Not waiting for the watch, the next read fetches the new value
+    pthread_mutex_lock(&cache->mtx);
+    cache_invalidate(cache, key);
+    pthread_mutex_unlock(&cache->mtx);
+    return ret;
+}
+
+static void kv_store_cache_watch(void* handle, char* key, kv_store_watch_callback_t cb, void* user_data) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    cache->kv_store_client->watch(cache->handle, key, cb, user_data);
+}
+
+static void kv_store_cache_watch_prefix(void* handle, char* key, kv_store_watch_callback_t cb, void* user_data) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    cache->kv_store_client->watch_prefix(cache->handle, key, cb, user_data);
+}
+
+static void kv_store_cache_watch_prefix_batched(void* handle, char* key, int window_ms,
+                                                kv_store_watch_batch_callback_t cb, void* user_data) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    cache->kv_store_client->watch_prefix_batched(cache->handle, key, window_ms, cb, user_data);
+}
+
+static int kv_store_cache_watch_events(void* handle, char* key, const kv_store_watch_options_t* opts,
+                                       kv_store_watch_event_callback_t cb, void* user_data) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    return cache->kv_store_client->watch_events(cache->handle, key, opts, cb, user_data);
+}
+
+static uint64_t kv_store_cache_get_dropped_watch_events(void* handle) {
+    kv_store_cache_t* cache = (kv_store_cache_t*)handle;
+    return cache->kv_store_client->get_dropped_watch_events(cache->handle);
+}
+
+static void kv_store_cache_deinit(void* kv_store_client) {
+    kv_store_client_t* client = (kv_store_client_t*)kv_store_client;
+    kv_store_cache_t* cache = (kv_store_cache_t*)client->handler;
+    if (cache == NULL) {
+        return;
+    }
+    // Freeing the wrapped client first stops its watches, no callback
+    // touches the cache once it returns
+    kv_client_free(cache->kv_store_client);
+    for (int i = 0; i < KV_STORE_CACHE_BUCKETS; i++) {
+        kv_store_cache_entry_t* entry = cache->buckets[i];
+        while (entry != NULL) {
+            kv_store_cache_entry_t* next = entry->next;
+            cache_entry_free(entry);
+            entry = next;
+        }
+    }
+    pthread_mutex_destroy(&cache->mtx);
+    cache_prefixes_free(cache);
+    free(cache);
+    client->handler = NULL;
+}
+
+kv_store_client_t* kv_store_cache_new(kv_store_client_t* kv_store_client,
+                                      char** prefixes, size_t num_prefixes) {
+    kv_store_client_t* client = NULL;
+    kv_store_cache_t* cache = NULL;
+
+    if (kv_store_client == NULL || prefixes == NULL || num_prefixes == 0) {
+        LOG_ERROR_0("kv_store_client and at least one prefix are required");
+        goto err;
+    }
+    for (size_t i = 0; i < num_prefixes; i++) {
+        if (prefixes[i] == NULL || strlen(prefixes[i]) == 0) {
+            LOG_ERROR_0("Cached prefixes must not be empty");
+            goto err;
+        }
+    }
+
+    cache = (kv_store_cache_t*)calloc(1, sizeof(kv_store_cache_t));
+    if (cache == NULL) {
+        LOG_ERROR_0("KV Store Cache: Failed to allocate Memory");
+        goto err;
+    }
+    cache->prefixes = (kv_store_cache_prefix_t*)calloc(num_prefixes, sizeof(kv_store_cache_prefix_t));
+    if (cache->prefixes == NULL) {
+        LOG_ERROR_0("KV Store Cache: Failed to allocate Memory");
+        goto err;
+    }
+    cache->num_prefixes = num_prefixes;
+    for (size_t i = 0; i < num_prefixes; i++) {
+        cache->prefixes[i].cache = cache;
+        cache->prefixes[i].prefix = cache_strdup(prefixes[i]);
+        if (cache->prefixes[i].prefix == NULL) {
+            goto err;
+        }
+        cache->prefixes[i].prefix_len = strlen(prefixes[i]);
+        cache->prefixes[i].live = false;
+    }
+    if (pthread_mutex_init(&cache->mtx, NULL) != 0) {
+        LOG_ERROR_0("Failed to initialize the cache mutex");
+        goto err;
+    }
+    cache->kv_store_client = kv_store_client;
+
+    client = (kv_store_client_t*)calloc(1, sizeof(kv_store_client_t));
+    if (client == NULL) {
+        LOG_ERROR_0("KV Store Client: Failed to allocate Memory");
+        pthread_mutex_destroy(&cache->mtx);
+        goto err;
+    }
+    client->kv_store_config = NULL;
+    client->handler = cache;
+    client->init = kv_store_cache_init;
+    client->get = kv_store_cache_get;
+    client->get_prefix = kv_store_cache_get_prefix;
+    client->get_prefix_with_options = kv_store_cache_get_prefix_with_options;
+    client->scan_prefix = kv_store_cache_scan_prefix;
+    client->get_many = kv_store_cache_get_many;
+    client->prefetch = kv_store_cache_prefetch;
+    client->get_view = kv_store_cache_get_view;
+    client->release_view = kv_store_cache_release_view;
+    client->put = kv_store_cache_put;
+    client->watch = kv_store_cache_watch;
+    client->watch_prefix = kv_store_cache_watch_prefix;
+    client->watch_prefix_batched = kv_store_cache_watch_prefix_batched;
+    client->watch_events = kv_store_cache_watch_events;
+    client->get_dropped_watch_events = kv_store_cache_get_dropped_watch_events;
+    client->deinit = kv_store_cache_deinit;
+    return client;
+err:
+    if (cache != NULL) {
+        cache_prefixes_free(cache);
+        free(cache);
+    }
+    return NULL;
+}
+
+int kv_store_cache_get_stats(kv_store_client_t* kv_store_client,
+                             kv_store_cache_stats_t* stats) {
+    if (kv_store_client == NULL || stats == NULL ||
+            kv_store_client->init != kv_store_cache_init) {
+        LOG_ERROR_0("kv_store_client is not a kv store cache");
+        return -1;
+    }
+    kv_store_cache_t* cache = (kv_store_cache_t*)kv_store_client->handler;
+    pthread_mutex_lock(&cache->mtx);
+    *stats = cache->stats;
+    pthread_mutex_unlock(&cache->mtx);
+    return 0;
+}
@@ -0,0 +1,160 @@
+// Copyright (c) 2020 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @file
+ * @brief Lazily parsed kv store value implementation
+ */
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cjson/cJSON.h>
+#include <eii/utils/logger.h>
+#include <eii/utils/json_config.h>
+#include <eii/config_manager/kv_store_plugin/kv_store_lazy_config.h>
+
+#include <safe_lib.h>
+
+/**
+ * Raw value held by a lazy config_t, parsed on first access
+ */
+typedef struct {
+    char* key;
+    char* raw;
+    size_t len;
+
+    // Guards every member below
+    pthread_mutex_t mtx;
+    bool parsed;
+    cJSON* json;
+} kv_store_lazy_value_t;
+
+// Parses the value once, returns NULL if it fails to parse
+static cJSON* lazy_materialize(kv_store_lazy_value_t* lazy) {
+    pthread_mutex_lock(&lazy->mtx);
+    if (!lazy->parsed) {
+        lazy->parsed = true;
+        if (lazy->raw[0] != '{') {
+            // Creating the cJSON object with the key as key and value as value
+            lazy->json = cJSON_CreateObject();
+            if (lazy->json == NULL) {
+                LOG_ERROR_0("Create json object failed");
+            } else {
+                cJSON_AddStringToObject(lazy->json, lazy->key, lazy->raw);
+            }
+        } else {
+            lazy->json = cJSON_Parse(lazy->raw);
+            if (lazy->json == NULL) {
+                LOG_ERROR("cJSON Parse of the value of key %s failed", lazy->key);
+            }
+        }
+    }
+    pthread_mutex_unlock(&lazy->mtx);
+    return lazy->json;
+}
+
+static config_value_t* lazy_get_config_value(const void* o, const char* key) {
+    cJSON* json = lazy_materialize((kv_store_lazy_value_t*) o);
+    if (json == NULL) {
+        return NULL;
+    }
+    return get_config_value(json, key);
+}
+
+static bool lazy_set_config_value(void* o, const char* key, config_value_t* value) {
+    cJSON* json = lazy_materialize((kv_store_lazy_value_t*) o);
+    if (json == NULL) {
+        return false;
+    }
+    return set_config_value(json, key, value);
+}
+
+static void lazy_free(void* o) {
+    kv_store_lazy_value_t* lazy = (kv_store_lazy_value_t*) o;
+    if (lazy->json != NULL) {
+        cJSON_Delete(lazy->json);
+    }
+    pthread_mutex_destroy(&lazy->mtx);
+    free(lazy->key);
+    free(lazy->raw);
+    free(lazy);
+}
+
+config_t* kv_store_lazy_config_new(const char* key, const char* value, size_t len) {
+    kv_store_lazy_value_t* lazy = NULL;
+    config_t* config = NULL;
+    size_t key_len = strlen(key);
+
+    lazy = (kv_store_lazy_value_t*) calloc(1, sizeof(kv_store_lazy_value_t));
+    if (lazy == NULL) {
+        LOG_ERROR_0("Failed to allocate lazy value");
+        return NULL;
+    }
+    lazy->key = (char*) malloc(key_len + 1);
+    lazy->raw = (char*) malloc(len + 1);
+    if (lazy->key == NULL || lazy->raw == NULL) {
+        LOG_ERROR_0("Failed to allocate lazy value");
+        goto err;
+    }
+    memcpy_s(lazy->key, key_len + 1, key, key_len);
+    lazy->key[key_len] = '\0';
+    if (len > 0) {
+        memcpy_s(lazy->raw, len + 1, value, len);
+    }
+    lazy->raw[len] = '\0';
+    lazy->len = len;
+    if (pthread_mutex_init(&lazy->mtx, NULL) != 0) {
+        LOG_ERROR_0("Failed to initialize lazy value mutex");
+        goto err;
+    }
+
+    config = config_new((void*) lazy, lazy_free, lazy_get_config_value, lazy_set_config_value);
+    if (config == NULL) {
+        LOG_ERROR_0("Failed to initialize configuration object");
+        pthread_mutex_destroy(&lazy->mtx);
+        goto err;
+    }
+    return config;
+err:
+    free(lazy->key);
+    free(lazy->raw);
+    free(lazy);
+    return NULL;
+}
+
+const char* kv_store_lazy_config_raw(const config_t* config, size_t* len) {
+    if (config->get_config_value != lazy_get_config_value) {
+        return NULL;
+    }
+    kv_store_lazy_value_t* lazy = (kv_store_lazy_value_t*) config->cfg;
+    if (len != NULL) {
+        *len = lazy->len;
+    }
+    return lazy->raw;
+}
+
+void* kv_store_lazy_config_json(const config_t* config) {
+    if (config->get_config_value != lazy_get_config_value) {
+        return config->cfg;
+    }
+    return lazy_materialize((kv_store_lazy_value_t*) config->cfg);
+}
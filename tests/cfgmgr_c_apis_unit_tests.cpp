@@ -801,6 +801,410 @@ TEST(ConfigManagerTest, getConfigValue) {
     cout << " =========== End Of getConfigValue() testcase ===========" << endl;
 }
 
+TEST(ConfigManagerTest, snapshot_test) {
+    cout << "Test Case: snapshot_test()\n";
+
+    const char* snapshot_file = "./cfgmgr_unittest_snapshot";
+    unlink(snapshot_file);
+    int result = setenv("CONFIGMGR_SNAPSHOT", snapshot_file, 1);
+    ASSERT_EQ(0, result);
+    result = setenv("AppName", "TestPubServer", 1);
+    ASSERT_EQ(0, result);
+
+    // The first initialization writes the snapshot
+    cfgmgr_ctx_t* cfg_mgr = cfgmgr_initialize();
+    ASSERT_NE(cfg_mgr, nullptr);
+    EXPECT_EQ(0, access(snapshot_file, F_OK));
+    cfgmgr_destroy(cfg_mgr);
+
+    // The next one starts from it while etcd server is unreachable
+    char* etcd_endpoint = getenv("ETCD_ENDPOINT");
+    string prev_endpoint = (etcd_endpoint != NULL) ? etcd_endpoint : "";
+    result = setenv("ETCD_ENDPOINT", "localhost:2399", 1);
+    ASSERT_EQ(0, result);
+    cfg_mgr = cfgmgr_initialize();
+    ASSERT_NE(cfg_mgr, nullptr);
+    EXPECT_NE(cfgmgr_get_num_publishers(cfg_mgr), -1);
+    cfgmgr_interface_t* pub_cfg = cfgmgr_get_publisher_by_index(cfg_mgr, 0);
+    EXPECT_NE(pub_cfg, nullptr);
+    config_value_t* max_workers = cfgmgr_get_app_config_value(cfg_mgr, "max_workers");
+    ASSERT_NE(max_workers, nullptr);
+    config_value_destroy(max_workers);
+    cfgmgr_destroy(cfg_mgr);
+    if (etcd_endpoint != NULL) {
+        setenv("ETCD_ENDPOINT", prev_endpoint.c_str(), 1);
+    } else {
+        unsetenv("ETCD_ENDPOINT");
+    }
+
+    // A stale snapshot is replaced by the app config read from etcd server
+    cfg_mgr = cfgmgr_initialize();
+    ASSERT_NE(cfg_mgr, nullptr);
+    char* app_config = cfg_mgr->kv_store_client->get(cfg_mgr->kv_store_handle,
+                                                     (char*) "/TestPubServer/config");
+    ASSERT_NE(app_config, nullptr);
+    cJSON* stale_config = cJSON_Parse(app_config);
+    ASSERT_NE(stale_config, nullptr);
+    cJSON_AddNumberToObject(stale_config, "snapshot_test", 1);
+    char* updated_config = cJSON_PrintUnformatted(stale_config);
+    EXPECT_EQ(0, cfg_mgr->kv_store_client->put(cfg_mgr->kv_store_handle,
+                                               (char*) "/TestPubServer/config", updated_config));
+    cfgmgr_destroy(cfg_mgr);
+    cJSON_Delete(stale_config);
+    free(updated_config);
+
+    cfg_mgr = cfgmgr_initialize();
+    ASSERT_NE(cfg_mgr, nullptr);
+    sleep(2);
+    config_value_t* snapshot_value = cfgmgr_get_app_config_value(cfg_mgr, "snapshot_test");
+    EXPECT_NE(snapshot_value, nullptr);
+    if (snapshot_value != NULL) {
+        config_value_destroy(snapshot_value);
+    }
+    EXPECT_EQ(0, cfg_mgr->kv_store_client->put(cfg_mgr->kv_store_handle,
+                                               (char*) "/TestPubServer/config", app_config));
+    free(app_config);
+    cfgmgr_destroy(cfg_mgr);
+
+    unsetenv("CONFIGMGR_SNAPSHOT");
+    unlink(snapshot_file);
+    cout << " =========== End Of snapshot testcase ===========" << endl;
+}
+
+TEST(ConfigManagerTest, config_diff) {
+    cout << "Test Case: config_diff()\n";
+
+    config_t* previous = json_config_new_from_buffer(
+            "{\"a\": 1, \"b\": {\"c\": [1, 2, 3], \"d\": \"x\"}, \"e/f\": true}");
+    ASSERT_NE(previous, nullptr);
+    config_t* current = json_config_new_from_buffer(
+            "{\"a\": 1, \"b\": {\"c\": [1, 5], \"d\": \"x\"}, \"g\": null}");
+    ASSERT_NE(current, nullptr);
+
+    cfgmgr_config_diff_t diff;
+    ASSERT_TRUE(cfgmgr_config_diff(previous, current, &diff));
+    ASSERT_EQ((size_t) 1, diff.num_added);
+    EXPECT_STREQ("/g", diff.added[0]);
+    ASSERT_EQ((size_t) 2, diff.num_removed);
+    EXPECT_STREQ("/b/c/2", diff.removed[0]);
+    EXPECT_STREQ("/e~1f", diff.removed[1]);
+    ASSERT_EQ((size_t) 1, diff.num_changed);
+    EXPECT_STREQ("/b/c/1", diff.changed[0]);
+    cfgmgr_config_diff_free(&diff);
+
+    // Identical configurations have no difference
+    ASSERT_TRUE(cfgmgr_config_diff(current, current, &diff));
+    EXPECT_EQ((size_t) 0, diff.num_added + diff.num_removed + diff.num_changed);
+    cfgmgr_config_diff_free(&diff);
+
+    // Every member of a deleted configuration is removed
+    ASSERT_TRUE(cfgmgr_config_diff(previous, NULL, &diff));
+    EXPECT_EQ((size_t) 3, diff.num_removed);
+    cfgmgr_config_diff_free(&diff);
+
+    config_destroy(previous);
+    config_destroy(current);
+    cout << " =========== End Of config_diff testcase ===========" << endl;
+}
+
+// Diffs notified to watch_diff_callback
+static int watch_diff_calls = 0;
+static size_t watch_diff_added = 0;
+static size_t watch_diff_changed = 0;
+
+static void watch_diff_callback(const char* key, config_t* value,
+                                const cfgmgr_config_diff_t* diff, void* user_data) {
+    watch_diff_added = diff->num_added;
+    watch_diff_changed = diff->num_changed;
+    __atomic_add_fetch(&watch_diff_calls, 1, __ATOMIC_SEQ_CST);
+    if (value != NULL) {
+        config_destroy(value);
+    }
+}
+
+TEST(ConfigManagerTest, watch_diff) {
+    cout << "Test Case: watch_diff()\n";
+
+    int result = setenv("AppName", "TestPubServer", 1);
+    ASSERT_EQ(0, result);
+    cfgmgr_ctx_t* cfg_mgr = cfgmgr_initialize();
+    ASSERT_NE(cfg_mgr, nullptr);
+    ASSERT_EQ(0, cfg_mgr->kv_store_client->put(cfg_mgr->kv_store_handle,
+                                               (char*) "/TestPubServer/watch_diff_test",
+                                               (char*) "{\"a\": 1}"));
+
+    // A change made right after the watch is registered is notified against
+    // the value read when registering it
+    ASSERT_TRUE(cfgmgr_watch_diff(cfg_mgr, "/TestPubServer/watch_diff_test",
+                                  watch_diff_callback, NULL));
+    ASSERT_EQ(0, cfg_mgr->kv_store_client->put(cfg_mgr->kv_store_handle,
+                                               (char*) "/TestPubServer/watch_diff_test",
+                                               (char*) "{\"a\": 2, \"b\": 1}"));
+    for (int i = 0; i < 50 && __atomic_load_n(&watch_diff_calls, __ATOMIC_SEQ_CST) == 0; i++) {
+        usleep(100 * 1000);
+    }
+    ASSERT_EQ(1, __atomic_load_n(&watch_diff_calls, __ATOMIC_SEQ_CST));
+    EXPECT_EQ((size_t) 1, watch_diff_added);
+    EXPECT_EQ((size_t) 1, watch_diff_changed);
+
+    cfgmgr_destroy(cfg_mgr);
+    cout << " =========== End Of watch_diff testcase ===========" << endl;
+}
+
+TEST(ConfigManagerTest, interface_by_name) {
+    cout << "Test Case: interface_by_name()\n";
+
+    int result = setenv("AppName", "TestPubServer", 1);
+    ASSERT_EQ(0, result);
+    cfgmgr_ctx_t* cfg_mgr = cfgmgr_initialize();
+    ASSERT_NE(cfg_mgr, nullptr);
+
+    // Every interface of a type is found under its name
+    int num_publishers = cfgmgr_get_num_publishers(cfg_mgr);
+    ASSERT_GT(num_publishers, 0);
+    for (int i = 0; i < num_publishers; i++) {
+        cfgmgr_interface_t* by_index = cfgmgr_get_publisher_by_index(cfg_mgr, i);
+        ASSERT_NE(by_index, nullptr);
+        config_value_t* name = config_value_object_get(by_index->interface, "Name");
+        ASSERT_NE(name, nullptr);
+        cfgmgr_interface_t* by_name = cfgmgr_get_publisher_by_name(cfg_mgr, name->body.string);
+        ASSERT_NE(by_name, nullptr);
+        EXPECT_EQ(CFGMGR_PUBLISHER, by_name->type);
+        config_value_destroy(name);
+        cfgmgr_interface_destroy(by_name);
+        cfgmgr_interface_destroy(by_index);
+    }
+
+    // Unknown names are not found
+    EXPECT_EQ(nullptr, cfgmgr_get_publisher_by_name(cfg_mgr, "no_such_interface"));
+    EXPECT_EQ(nullptr, cfgmgr_get_client_by_name(cfg_mgr, "no_such_interface"));
+
+    cfgmgr_destroy(cfg_mgr);
+    cout << " =========== End Of interface_by_name testcase ===========" << endl;
+}
+
+TEST(ConfigManagerTest, env_overrides) {
+    cout << "Test Case: env_overrides()\n";
+
+    int result = setenv("AppName", "TestPubServer", 1);
+    ASSERT_EQ(0, result);
+    cfgmgr_ctx_t* cfg_mgr = cfgmgr_initialize();
+    ASSERT_NE(cfg_mgr, nullptr);
+    cfgmgr_interface_t* server_cfg = cfgmgr_get_server_by_name(cfg_mgr, "default");
+    ASSERT_NE(server_cfg, nullptr);
+
+    // Overrides set after cfgmgr_initialize() apply once refreshed
+    result = setenv("SERVER_default_ENDPOINT", "127.0.0.1:66099", 1);
+    ASSERT_EQ(0, result);
+    config_t* server_config = cfgmgr_get_msgbus_config(server_cfg);
+    ASSERT_NE(server_config, nullptr);
+    char* config_str = configt_to_char(server_config);
+    ASSERT_NE(config_str, nullptr);
+    EXPECT_EQ(nullptr, strstr(config_str, "66099"));
+    free(config_str);
+    config_destroy(server_config);
+
+    ASSERT_TRUE(cfgmgr_refresh_env_overrides(cfg_mgr));
+    server_config = cfgmgr_get_msgbus_config(server_cfg);
+    ASSERT_NE(server_config, nullptr);
+    config_str = configt_to_char(server_config);
+    ASSERT_NE(config_str, nullptr);
+    EXPECT_NE(nullptr, strstr(config_str, "66099"));
+    free(config_str);
+    config_destroy(server_config);
+
+    unsetenv("SERVER_default_ENDPOINT");
+    cfgmgr_interface_destroy(server_cfg);
+    cfgmgr_destroy(cfg_mgr);
+    cout << " =========== End Of env_overrides testcase ===========" << endl;
+}
+
+TEST(ConfigManagerTest, msgbus_config_cache) {
+    cout << "Test Case: msgbus_config_cache()\n";
+
+    int result = setenv("CONFIGMGR_MSGBUS_CACHE", "true", 1);
+    ASSERT_EQ(0, result);
+    result = setenv("AppName", "TestPubServer", 1);
+    ASSERT_EQ(0, result);
+    cfgmgr_ctx_t* cfg_mgr = cfgmgr_initialize();
+    ASSERT_NE(cfg_mgr, nullptr);
+    cfgmgr_interface_t* pub_cfg = cfgmgr_get_publisher_by_index(cfg_mgr, 0);
+    ASSERT_NE(pub_cfg, nullptr);
+
+    // Repeated calls share one immutable config
+    config_t* first = cfgmgr_get_msgbus_config(pub_cfg);
+    ASSERT_NE(first, nullptr);
+    config_t* second = cfgmgr_get_msgbus_config(pub_cfg);
+    ASSERT_NE(second, nullptr);
+    EXPECT_EQ(first->cfg, second->cfg);
+    config_value_t* value = config_value_new_string("value");
+    EXPECT_FALSE(config_set(second, "key", value));
+    config_value_destroy(value);
+
+    // A changed env override rebuilds the config once refreshed
+    result = setenv("PUBLISHER_TYPE", "zmq_tcp", 1);
+    ASSERT_EQ(0, result);
+    config_t* unchanged = cfgmgr_get_msgbus_config(pub_cfg);
+    ASSERT_NE(unchanged, nullptr);
+    EXPECT_EQ(first->cfg, unchanged->cfg);
+    config_destroy(unchanged);
+    ASSERT_TRUE(cfgmgr_refresh_env_overrides(cfg_mgr));
+    config_t* third = cfgmgr_get_msgbus_config(pub_cfg);
+    ASSERT_NE(third, nullptr);
+    EXPECT_NE(first->cfg, third->cfg);
+    unsetenv("PUBLISHER_TYPE");
+
+    config_destroy(first);
+    config_destroy(second);
+    cfgmgr_interface_destroy(pub_cfg);
+    cfgmgr_destroy(cfg_mgr);
+    // Configs handed out outlive cfg_mgr
+    config_value_t* type = config_get(third, "type");
+    EXPECT_NE(type, nullptr);
+    config_value_destroy(type);
+    config_destroy(third);
+    unsetenv("CONFIGMGR_MSGBUS_CACHE");
+    cout << " =========== End Of msgbus_config_cache testcase ===========" << endl;
+}
+
+TEST(ConfigManagerTest, all_msgbus_configs) {
+    cout << "Test Case: all_msgbus_configs()\n";
+
+    int result = setenv("AppName", "TestPubServer", 1);
+    ASSERT_EQ(0, result);
+    cfgmgr_ctx_t* cfg_mgr = cfgmgr_initialize();
+    ASSERT_NE(cfg_mgr, nullptr);
+
+    int num_configs = 0;
+    cfgmgr_msgbus_config_t* configs = cfgmgr_get_all_msgbus_configs(cfg_mgr, &num_configs);
+    ASSERT_NE(configs, nullptr);
+    EXPECT_EQ(cfgmgr_get_num_publishers(cfg_mgr) + cfgmgr_get_num_subscribers(cfg_mgr) +
+              cfgmgr_get_num_servers(cfg_mgr) + cfgmgr_get_num_clients(cfg_mgr), num_configs);
+
+    // Every config matches the one built for the interface alone
+    for (int i = 0; i < num_configs; i++) {
+        cfgmgr_interface_t* interface = NULL;
+        if (configs[i].type == CFGMGR_PUBLISHER) {
+            interface = cfgmgr_get_publisher_by_index(cfg_mgr, configs[i].index);
+        } else if (configs[i].type == CFGMGR_SUBSCRIBER) {
+            interface = cfgmgr_get_subscriber_by_index(cfg_mgr, configs[i].index);
+        } else if (configs[i].type == CFGMGR_SERVER) {
+            interface = cfgmgr_get_server_by_index(cfg_mgr, configs[i].index);
+        } else {
+            interface = cfgmgr_get_client_by_index(cfg_mgr, configs[i].index);
+        }
+        ASSERT_NE(interface, nullptr);
+        if (i > 0) {
+            EXPECT_LE(configs[i - 1].type, configs[i].type);
+        }
+        config_t* expected = cfgmgr_get_msgbus_config(interface);
+        ASSERT_NE(expected, nullptr);
+        char* expected_str = configt_to_char(expected);
+        char* config_str = configt_to_char(configs[i].msgbus_config);
+        ASSERT_NE(expected_str, nullptr);
+        ASSERT_NE(config_str, nullptr);
+        EXPECT_STREQ(expected_str, config_str);
+        free(expected_str);
+        free(config_str);
+        config_destroy(expected);
+        cfgmgr_interface_destroy(interface);
+    }
+
+    cfgmgr_msgbus_configs_destroy(configs, num_configs);
+    cfgmgr_destroy(cfg_mgr);
+    cout << " =========== End Of all_msgbus_configs testcase ===========" << endl;
+}
+
+TEST(ConfigManagerTest, key_resolver_stats) {
+    cout << "Test Case: key_resolver_stats()\n";
+
+    int result = setenv("AppName", "TestPubServer", 1);
+    ASSERT_EQ(0, result);
+    cfgmgr_ctx_t* cfg_mgr = cfgmgr_initialize();
+    ASSERT_NE(cfg_mgr, nullptr);
+
+    cfgmgr_key_stats_t stats;
+    if (cfgmgr_is_dev_mode(cfg_mgr)) {
+        // No key material is resolved in dev mode
+        EXPECT_FALSE(cfgmgr_get_key_stats(cfg_mgr, &stats));
+        cfgmgr_destroy(cfg_mgr);
+        return;
+    }
+
+    cfgmgr_interface_t* pub_ctx = cfgmgr_get_publisher_by_index(cfg_mgr, 0);
+    ASSERT_NE(pub_ctx, nullptr);
+    config_t* first = cfgmgr_get_msgbus_config(pub_ctx);
+    ASSERT_NE(first, nullptr);
+    ASSERT_TRUE(cfgmgr_get_key_stats(cfg_mgr, &stats));
+    uint64_t fetches_saved = stats.fetches_saved;
+
+    // The keys resolved for the first config are reused by the second
+    config_t* second = cfgmgr_get_msgbus_config(pub_ctx);
+    ASSERT_NE(second, nullptr);
+    ASSERT_TRUE(cfgmgr_get_key_stats(cfg_mgr, &stats));
+    EXPECT_GT(stats.fetches_saved, fetches_saved);
+
+    config_destroy(first);
+    config_destroy(second);
+    cfgmgr_interface_destroy(pub_ctx);
+    cfgmgr_destroy(cfg_mgr);
+    cout << " =========== End Of key_resolver_stats testcase ===========" << endl;
+}
+
+TEST(ConfigManagerTest, key_resolver_watch) {
+    cout << "Test Case: key_resolver_watch()\n";
+
+    // Keys are only resolved in prod mode
+    const char* dev_mode_env = getenv("DEV_MODE");
+    string dev_mode = (dev_mode_env != NULL) ? dev_mode_env : "";
+    int result = setenv("DEV_MODE", "false", 1);
+    ASSERT_EQ(0, result);
+    result = setenv("AppName", "TestSubClient", 1);
+    ASSERT_EQ(0, result);
+    cfgmgr_ctx_t* cfg_mgr = cfgmgr_initialize();
+    ASSERT_NE(cfg_mgr, nullptr);
+    ASSERT_FALSE(cfgmgr_is_dev_mode(cfg_mgr));
+    cfgmgr_interface_t* client_ctx = cfgmgr_get_client_by_name(cfg_mgr, "default");
+    ASSERT_NE(client_ctx, nullptr);
+    config_t* client_config = cfgmgr_get_msgbus_config(client_ctx);
+    ASSERT_NE(client_config, nullptr);
+    config_destroy(client_config);
+
+    // A new public key of the server is carried by the next config
+    char* public_key = cfg_mgr->kv_store_client->get(cfg_mgr->kv_store_handle,
+                                                     (char*) "/Publickeys/TestPubServer");
+    ASSERT_NE(public_key, nullptr);
+    ASSERT_EQ(0, cfg_mgr->kv_store_client->put(cfg_mgr->kv_store_handle,
+                                               (char*) "/Publickeys/TestPubServer",
+                                               (char*) "key_resolver_watch_test"));
+    bool updated = false;
+    for (int i = 0; i < 50 && !updated; i++) {
+        client_config = cfgmgr_get_msgbus_config(client_ctx);
+        ASSERT_NE(client_config, nullptr);
+        char* config_str = configt_to_char(client_config);
+        ASSERT_NE(config_str, nullptr);
+        updated = (strstr(config_str, "key_resolver_watch_test") != NULL);
+        free(config_str);
+        config_destroy(client_config);
+        if (!updated) {
+            usleep(100 * 1000);
+        }
+    }
+    EXPECT_TRUE(updated);
+
+    EXPECT_EQ(0, cfg_mgr->kv_store_client->put(cfg_mgr->kv_store_handle,
+                                               (char*) "/Publickeys/TestPubServer", public_key));
+    free(public_key);
+    cfgmgr_interface_destroy(client_ctx);
+    cfgmgr_destroy(cfg_mgr);
+    if (dev_mode.empty()) {
+        unsetenv("DEV_MODE");
+    } else {
+        setenv("DEV_MODE", dev_mode.c_str(), 1);
+    }
+    cout << " =========== End Of key_resolver_watch testcase ===========" << endl;
+}
+
 int main(int argc, char **argv) {
     etcd_requirements_put();
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,133 @@
+// Copyright (c) 2020 Intel Corporation.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to
+// deal in the Software without restriction, including without limitation the
+// rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM,OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+// IN THE SOFTWARE.
+
+/**
+ * @brief Microbenchmark counting the heap allocations of
+ *        EtcdClient::get_prefix() against a running etcd server
+ */
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <thread>
+#include <stdlib.h>
+
+#include "eii/config_manager/kv_store_plugin/etcd_client/etcd_client.h"
+
+#define BENCH_HOST       "localhost"
+#define BENCH_PORT       "2379"
+#define BENCH_PREFIX     "/alloc_bench/"
+#define BENCH_NUM_KEYS   256
+#define BENCH_VALUE_LEN  512
+#define BENCH_ITERATIONS 100
+
+static std::atomic<bool> counting(false);
+static std::atomic<long> allocations(0);
+
+void* operator new(size_t size) {
+    if (counting) {
+        allocations++;
+    }
+    void* ptr = malloc(size ? size : 1);
+    if (ptr == NULL) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+// Deletes the keys written by the benchmark, EtcdClient has no delete API
+static void delete_bench_keys() {
+    std::shared_ptr<Channel> channel = grpc::CreateChannel(
+            BENCH_HOST ":" BENCH_PORT, grpc::InsecureChannelCredentials());
+    std::unique_ptr<KV::Stub> stub = KV::NewStub(channel);
+    etcdserverpb::DeleteRangeRequest request;
+    etcdserverpb::DeleteRangeResponse reply;
+    ClientContext context;
+    std::string range_end = BENCH_PREFIX;
+    range_end.back()++;
+    request.set_key(BENCH_PREFIX);
+    request.set_range_end(range_end);
+    Status status = stub->DeleteRange(&context, request, &reply);
+    EXPECT_TRUE(status.ok()) << status.error_message();
+}
+
+// Counts the allocations of a get_prefix() call
+static long count_get_prefix_allocations(EtcdClient& client) {
+    std::string prefix = BENCH_PREFIX;
+    allocations = 0;
+    counting = true;
+    std::vector<std::string> values = client.get_prefix(prefix);
+    counting = false;
+    EXPECT_EQ(values.size(), (size_t) BENCH_NUM_KEYS);
+    return allocations;
+}
+
+// Deletes the keys of the benchmark whatever its outcome
+class EtcdClientBenchmark : public ::testing::Test {
+    protected:
+        void TearDown() override {
+            delete_bench_keys();
+        }
+};
+
+TEST_F(EtcdClientBenchmark, get_prefix_allocations) {
+    EtcdClient client(BENCH_HOST, BENCH_PORT);
+    std::string value(BENCH_VALUE_LEN, 'v');
+
+    for (int i = 0; i < BENCH_NUM_KEYS; i++) {
+        std::string key = BENCH_PREFIX + std::to_string(i);
+        ASSERT_EQ(client.put(key, value), 0);
+    }
+
+    // Warm up the channel
+    std::string prefix = BENCH_PREFIX;
+    ASSERT_EQ(client.get_prefix(prefix).size(), (size_t) BENCH_NUM_KEYS);
+
+    // First call of a thread, without a reply to reuse
+    long cold = 0;
+    std::thread cold_thread([&] { cold = count_get_prefix_allocations(client); });
+    cold_thread.join();
+
+    allocations = 0;
+    counting = true;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BENCH_ITERATIONS; i++) {
+        prefix = BENCH_PREFIX;
+        std::vector<std::string> values = client.get_prefix(prefix);
+        EXPECT_EQ(values.size(), (size_t) BENCH_NUM_KEYS);
+    }
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+    counting = false;
+
+    double per_call = (double) allocations / BENCH_ITERATIONS;
+    std::cout << "get_prefix() of " << BENCH_NUM_KEYS << " keys: "
+              << per_call << " allocations and "
+              << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() / BENCH_ITERATIONS
+              << " us per call, " << cold << " allocations for the first call of a thread"
+              << std::endl;
+
+    // The KeyValue entries of the reused reply are not allocated again
+    EXPECT_LT(per_call + BENCH_NUM_KEYS / 2, (double) cold);
+}
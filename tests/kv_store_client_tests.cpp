@@ -23,16 +23,44 @@
  */
 
 #include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <string>
 
 #include "eii/config_manager/kv_store_plugin/kv_store_plugin.h"
+#include "eii/config_manager/kv_store_plugin/kv_store_cache.h"
+#include "eii/config_manager/kv_store_plugin/kv_store_lazy_config.h"
 #include "eii/utils/json_config.h"
+#include "eii/config_manager/kv_store_plugin/etcd_client/etcd_retry.h"
+#include "eii/config_manager/kv_store_plugin/etcd_client/protobuf/rpc.grpc.pb.h"
+#include <grpcpp/grpcpp.h>
 
 #define KV_STORE_CONFIG "./kv_store_unittest_config.json"
 
 static int watch_cb = 0;
 static int watch_prefix_cb = 0;
+static int watch_cancel_cb = 0;
+static int watch_batch_cb = 0;
+static size_t watch_batch_keys = 0;
+static std::atomic<int> watch_slow_cb(0);
+static std::atomic<int> watch_fast_cb(0);
+static std::atomic<int> watch_coalesced_cb(0);
+static std::atomic<int64_t> watch_coalesced_value(0);
+static int watch_event_cb = 0;
+static int watch_event_prev = 0;
+static int watch_event_created = 0;
+static int watch_event_deleted = 0;
+static std::string watch_event_deleted_prev;
+static int watch_lazy_cb = 0;
+static int watch_lazy_raw = 0;
+static int watch_parsed_cb = 0;
 
 void watch_callback(const char* key, config_t* value, void *user_data){
     std::cout << "kv_store_client: watch_callback is called ....." << std::endl;
@@ -44,6 +72,122 @@ void watch_prefix_callback(const char* key, config_t* value, void *user_data){
     watch_prefix_cb++;
 }
 
+void watch_batch_callback(const char** keys, config_t** values, size_t num, void *user_data){
+    std::cout << "kv_store_client: watch_batch_callback is called with " << num << " keys" << std::endl;
+    watch_batch_cb++;
+    watch_batch_keys += num;
+    for (size_t i = 0; i < num; i++) {
+        config_destroy(values[i]);
+    }
+}
+
+void watch_dispatch_callback(const char* key, config_t* value, void *user_data){
+    std::cout << "kv_store_client: watch_dispatch_callback is called for " << key << std::endl;
+    if (strcmp(key, "/dispatchwatch/slow") == 0) {
+        sleep(3);
+        watch_slow_cb++;
+    } else {
+        watch_fast_cb++;
+    }
+    config_destroy(value);
+}
+
+void watch_coalesce_callback(const char* key, config_t* value, void *user_data){
+    std::cout << "kv_store_client: watch_coalesce_callback is called for " << key << std::endl;
+    if (strcmp(key, "/dispatchcoalesce/slow") == 0) {
+        sleep(3);
+    } else {
+        config_value_t* v = value->get_config_value(value->cfg, "v");
+        if (v != NULL) {
+            watch_coalesced_value = v->body.integer;
+            config_value_destroy(v);
+        }
+        watch_coalesced_cb++;
+    }
+    config_destroy(value);
+}
+
+void watch_event_callback(const kv_store_watch_event_t* event, void *user_data){
+    std::cout << "kv_store_client: watch_event_callback is called for " << event->key
+              << " at revision " << event->mod_revision << std::endl;
+    if (event->type == KV_STORE_EVENT_CREATED) {
+        watch_event_created++;
+        return;
+    }
+    watch_event_cb++;
+    if (event->type == KV_STORE_EVENT_DELETE) {
+        watch_event_deleted++;
+        if (event->prev_value != NULL) {
+            // A value not in JSON format is wrapped with its key as member
+            config_value_t* prev = event->prev_value->get_config_value(
+                    event->prev_value->cfg, event->key);
+            if (prev != NULL) {
+                watch_event_deleted_prev = prev->body.string;
+                config_value_destroy(prev);
+            }
+        }
+    }
+    if (event->prev_value != NULL) {
+        watch_event_prev++;
+        config_destroy(event->prev_value);
+    }
+    if (event->value != NULL) {
+        config_destroy(event->value);
+    }
+}
+
+void watch_lazy_callback(const kv_store_watch_event_t* event, void *user_data){
+    std::cout << "kv_store_client: watch_lazy_callback is called ....." << std::endl;
+    if (event->value == NULL) {
+        return;
+    }
+    watch_lazy_cb++;
+    size_t len = 0;
+    const char* raw = kv_store_lazy_config_raw(event->value, &len);
+    if (raw != NULL && len == strlen("{\"lazy\": 1}") &&
+            strncmp(raw, "{\"lazy\": 1}", len) == 0) {
+        watch_lazy_raw++;
+    }
+    // Reading a value parses the payload on first use
+    config_value_t* lazy = event->value->get_config_value(event->value->cfg, "lazy");
+    if (lazy != NULL) {
+        config_value_destroy(lazy);
+    }
+    config_destroy(event->value);
+}
+
+void watch_parsed_callback(const char* key, config_t* value, void *user_data){
+    std::cout << "kv_store_client: watch_parsed_callback is called ....." << std::endl;
+    watch_parsed_cb++;
+    config_destroy(value);
+}
+
+int scan_callback(const char** keys, const char** values, size_t num, void *user_data){
+    std::cout << "kv_store_client: scan_callback is called with " << num << " keys" << std::endl;
+    size_t* scanned = (size_t*) user_data;
+    *scanned += num;
+    return 0;
+}
+
+void watch_cancel_callback(const char* key, config_t* value, void *user_data){
+    std::cout << "kv_store_client: watch_cancel_callback is called ....." << std::endl;
+    watch_cancel_cb++;
+}
+
+// Deletes key from the etcd server of KV_STORE_CONFIG, kv_store_client_t
+// has no delete API
+int delete_key(const char* key){
+    std::shared_ptr<grpc::Channel> channel = grpc::CreateChannel(
+            "localhost:2379", grpc::InsecureChannelCredentials());
+    std::unique_ptr<etcdserverpb::KV::Stub> stub = etcdserverpb::KV::NewStub(channel);
+    etcdserverpb::DeleteRangeRequest request;
+    etcdserverpb::DeleteRangeResponse reply;
+    grpc::ClientContext context;
+    request.set_key(key);
+    grpc::Status status = stub->DeleteRange(&context, request, &reply);
+    return status.ok() ? 0 : -1;
+}
+
 kv_store_client_t* get_kv_store_client(){
     config_t* config = json_config_new(KV_STORE_CONFIG);
     kv_store_client_t *kv_store_client = create_kv_client(config);
@@ -74,6 +218,238 @@ TEST(KVStoreClientTest, get){
     kv_client_free(kv_store_client);
 }
 
+TEST(KVStoreClientTest, get_many){
+    std::cout << "Test Case: get_many()\n";
+    kv_store_client_t *kv_store_client = get_kv_store_client();
+    EXPECT_NE(kv_store_client, nullptr);
+    void *handle = kv_store_client->init(kv_store_client);
+
+    int status = kv_store_client->put(handle, "/test_get_many_1", "value_1");
+    EXPECT_EQ(status, 0);
+    status = kv_store_client->put(handle, "/test_get_many_2", "value_2");
+    EXPECT_EQ(status, 0);
+
+    char* keys[] = {"/test_get_many_1", "/test_get_many_missing", "/test_get_many_2"};
+    char** values = kv_store_client->get_many(handle, keys, 3);
+    ASSERT_NE(nullptr, values);
+    ASSERT_STREQ("value_1", values[0]);
+    ASSERT_EQ(nullptr, values[1]);
+    ASSERT_STREQ("value_2", values[2]);
+    for (int i = 0; i < 3; i++) {
+        free(values[i]);
+    }
+    free(values);
+
+    kv_client_free(kv_store_client);
+}
+
+TEST(KVStoreClientTest, get_view){
+    std::cout << "Test Case: get_view()\n";
+    kv_store_client_t *kv_store_client = get_kv_store_client();
+    EXPECT_NE(kv_store_client, nullptr);
+    void *handle = kv_store_client->init(kv_store_client);
+
+    int status = kv_store_client->put(handle, "/test_get_view", "value_1");
+    EXPECT_EQ(status, 0);
+
+    char* keys[] = {"/test_get_view", "/test_get_view_missing"};
+    kv_store_value_view_t views[2];
+    status = kv_store_client->get_view(handle, keys, 2, views);
+    ASSERT_EQ(0, status);
+    ASSERT_STREQ("value_1", views[0].data);
+    ASSERT_EQ(strlen("value_1"), views[0].len);
+    ASSERT_EQ(nullptr, views[1].data);
+    for (int i = 0; i < 2; i++) {
+        kv_store_client->release_view(handle, &views[i]);
+    }
+
+    kv_client_free(kv_store_client);
+}
+
+TEST(KVStoreClientTest, get_prefix_with_options){
+    std::cout << "Test Case: get_prefix_with_options()\n";
+    kv_store_client_t *kv_store_client = get_kv_store_client();
+    EXPECT_NE(kv_store_client, nullptr);
+    void *handle = kv_store_client->init(kv_store_client);
+
+    int status = kv_store_client->put(handle, "/test_options/a", "value_a");
+    EXPECT_EQ(status, 0);
+    status = kv_store_client->put(handle, "/test_options/b", "value_b");
+    EXPECT_EQ(status, 0);
+
+    kv_store_read_options_t opts = {};
+    opts.count_only = true;
+    config_value_t* count = kv_store_client->get_prefix_with_options(handle, "/test_options/", &opts);
+    ASSERT_NE(nullptr, count);
+    ASSERT_EQ(CVT_INTEGER, count->type);
+    ASSERT_EQ(2, count->body.integer);
+    config_value_destroy(count);
+
+    opts = {};
+    opts.keys_only = true;
+    opts.limit = 1;
+    config_value_t* keys = kv_store_client->get_prefix_with_options(handle, "/test_options/", &opts);
+    ASSERT_NE(nullptr, keys);
+    ASSERT_EQ((size_t) 1, config_value_array_len(keys));
+    config_value_t* key = config_value_array_get(keys, 0);
+    ASSERT_STREQ("/test_options/a", key->body.string);
+    config_value_destroy(key);
+    config_value_destroy(keys);
+
+    opts = {};
+    opts.consistency = KV_STORE_CONSISTENCY_SERIALIZABLE;
+    config_value_t* values = kv_store_client->get_prefix_with_options(handle, "/test_options/", &opts);
+    ASSERT_NE(nullptr, values);
+    ASSERT_EQ((size_t) 2, config_value_array_len(values));
+    config_value_destroy(values);
+
+    kv_client_free(kv_store_client);
+}
+
+TEST(KVStoreClientTest, scan_prefix){
+    std::cout << "Test Case: scan_prefix()\n";
+    kv_store_client_t *kv_store_client = get_kv_store_client();
+    EXPECT_NE(kv_store_client, nullptr);
+    void *handle = kv_store_client->init(kv_store_client);
+
+    char key[32];
+    for (int i = 0; i < 5; i++) {
+        snprintf(key, sizeof(key), "/test_scan/%d", i);
+        int status = kv_store_client->put(handle, key, "test_scan_value");
+        EXPECT_EQ(status, 0);
+    }
+
+    // Pages of 2 keys
+    size_t scanned = 0;
+    int status = kv_store_client->scan_prefix(handle, "/test_scan/", 2, scan_callback, &scanned);
+    ASSERT_EQ(0, status);
+    ASSERT_EQ((size_t) 5, scanned);
+
+    kv_client_free(kv_store_client);
+}
+
+TEST(KVStoreClientTest, failover){
+    std::cout << "Test Case: failover\n";
+    // First member accepts connections but never answers, its channel
+    // stays connecting while requests go to the healthy one
+    int silent_fd = socket(AF_INET, SOCK_STREAM, 0);
+    ASSERT_GE(silent_fd, 0);
+    struct sockaddr_in silent_addr;
+    memset(&silent_addr, 0, sizeof(silent_addr));
+    silent_addr.sin_family = AF_INET;
+    silent_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addr_len = sizeof(silent_addr);
+    ASSERT_EQ(0, bind(silent_fd, (struct sockaddr*) &silent_addr, sizeof(silent_addr)));
+    ASSERT_EQ(0, listen(silent_fd, 16));
+    ASSERT_EQ(0, getsockname(silent_fd, (struct sockaddr*) &silent_addr, &addr_len));
+    std::string endpoints = "127.0.0.1:" + std::to_string(ntohs(silent_addr.sin_port)) +
+                            ",localhost:2379";
+    setenv("ETCD_ENDPOINT", endpoints.c_str(), 1);
+    kv_store_client_t *kv_store_client = get_kv_store_client();
+    unsetenv("ETCD_ENDPOINT");
+    EXPECT_NE(kv_store_client, nullptr);
+    void *handle = kv_store_client->init(kv_store_client);
+    ASSERT_NE(nullptr, handle);
+
+    int status = kv_store_client->put(handle, "/test_failover", "test_failover_1234");
+    EXPECT_EQ(status, 0);
+
+    // Every request is served by the healthy member without waiting for
+    // the deadline of the unreachable one
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; i++) {
+        char *get_value = kv_store_client->get(handle, "/test_failover");
+        ASSERT_STREQ("test_failover_1234", get_value);
+        free(get_value);
+    }
+    long elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    std::cout << "10 get() served in " << elapsed_ms << " ms\n";
+    EXPECT_LT(elapsed_ms, ETCD_DEFAULT_TIMEOUT_MS);
+
+    kv_client_free(kv_store_client);
+    close(silent_fd);
+}
+
+TEST(KVStoreClientTest, retry){
+    std::cout << "Test Case: retry\n";
+    // Unreachable member, get is attempted 3 times within a bounded time
+    setenv("ETCD_ENDPOINT", "127.0.0.1:1", 1);
+    config_t* config = json_config_new_from_buffer(
+            "{\"type\": \"etcd\", \"etcd_kv_store\": {\"cert_file\": \"\","
+            " \"key_file\": \"\", \"ca_file\": \"\", \"timeout_ms\": 1000,"
+            " \"max_attempts\": 3, \"initial_backoff_ms\": 100, \"max_backoff_ms\": 200}}");
+    kv_store_client_t *kv_store_client = create_kv_client(config);
+    unsetenv("ETCD_ENDPOINT");
+    ASSERT_NE(nullptr, kv_store_client);
+    void *handle = kv_store_client->init(kv_store_client);
+    ASSERT_NE(nullptr, handle);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    char *get_value = kv_store_client->get(handle, "/test_retry");
+    long elapsed_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    std::cout << "get() failed after " << elapsed_ms << " ms\n";
+    ASSERT_EQ(nullptr, get_value);
+    // Two retries backing off at least 50 and 100 ms
+    EXPECT_GE(elapsed_ms, 150);
+    EXPECT_LT(elapsed_ms, 3000);
+
+    kv_client_free(kv_store_client);
+    config_destroy(config);
+}
+
+TEST(KVStoreClientTest, consistency_config){
+    std::cout << "Test Case: consistency_config\n";
+    // Only serializable and linearizable are accepted, an empty value too
+    // is refused
+    const char* values[] = {"", "eventual"};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        std::string json = std::string("{\"type\": \"etcd\", \"etcd_kv_store\": {\"cert_file\": \"\","
+                " \"key_file\": \"\", \"ca_file\": \"\", \"consistency\": \"") + values[i] + "\"}}";
+        config_t* config = json_config_new_from_buffer(json.c_str());
+        ASSERT_NE(nullptr, config);
+        EXPECT_EQ(nullptr, create_kv_client(config)) << "consistency \"" << values[i] << "\"";
+        config_destroy(config);
+    }
+}
+
+TEST(KVStoreClientTest, prefetch){
+    std::cout << "Test Case: prefetch()\n";
+    kv_store_client_t *kv_store_client = get_kv_store_client();
+    EXPECT_NE(kv_store_client, nullptr);
+    void *handle = kv_store_client->init(kv_store_client);
+
+    int status = kv_store_client->put(handle, "/test_prefetch/a", "value_1");
+    EXPECT_EQ(status, 0);
+
+    char* prefixes[] = {"/test_prefetch/"};
+    status = kv_store_client->prefetch(handle, prefixes, 1);
+    ASSERT_EQ(0, status);
+
+    // Reads under the prefix are served from the prefetched keys, which
+    // follow the puts of the client
+    char *get_value = kv_store_client->get(handle, "/test_prefetch/a");
+    ASSERT_STREQ("value_1", get_value);
+    free(get_value);
+    status = kv_store_client->put(handle, "/test_prefetch/a", "value_2");
+    EXPECT_EQ(status, 0);
+    get_value = kv_store_client->get(handle, "/test_prefetch/a");
+    ASSERT_STREQ("value_2", get_value);
+    free(get_value);
+
+    // Dropping the prefetched keys reads from the kv store again
+    status = kv_store_client->prefetch(handle, NULL, 0);
+    ASSERT_EQ(0, status);
+    status = kv_store_client->put(handle, "/test_prefetch/a", "value_3");
+    EXPECT_EQ(status, 0);
+    get_value = kv_store_client->get(handle, "/test_prefetch/a");
+    ASSERT_STREQ("value_3", get_value);
+    free(get_value);
+
+    kv_client_free(kv_store_client);
+}
+
 TEST(KVStoreClientTest, put){
     std::cout << "Test Case: put()\n";
     kv_store_client_t *kv_store_client = get_kv_store_client();
@@ -116,6 +492,210 @@ TEST(KVStoreClientTest, watch_prefix){
     kv_client_free(kv_store_client); 
 }
 
+TEST(KVStoreClientTest, watch_prefix_batched){
+    std::cout << "Test Case: watch_prefix_batched()\n";
+    kv_store_client_t *kv_store_client = get_kv_store_client();
+    EXPECT_NE(kv_store_client, nullptr);
+    void *handle = kv_store_client->init(kv_store_client);
+
+    kv_store_client->watch_prefix_batched(handle, "/batchwatch", 2000, watch_batch_callback, NULL);
+    sleep(5);
+    int status = kv_store_client->put(handle, "/batchwatch/a", "value_1");
+    EXPECT_EQ(status, 0);
+    status = kv_store_client->put(handle, "/batchwatch/b", "value_2");
+    EXPECT_EQ(status, 0);
+    status = kv_store_client->put(handle, "/batchwatch/a", "value_3");
+    EXPECT_EQ(status, 0);
+    sleep(5);
+    ASSERT_EQ(1, watch_batch_cb);
+    ASSERT_EQ((size_t) 2, watch_batch_keys);
+    kv_client_free(kv_store_client);
+}
+
+TEST(KVStoreClientTest, watch_events){
+    std::cout << "Test Case: watch_events()\n";
+    kv_store_client_t *kv_store_client = get_kv_store_client();
+    EXPECT_NE(kv_store_client, nullptr);
+    void *handle = kv_store_client->init(kv_store_client);
+
+    kv_store_watch_options_t opts = {};
+    opts.prefix = true;
+    opts.prev_value = true;
+    int status = kv_store_client->watch_events(handle, "/eventwatch/", &opts, watch_event_callback, NULL);
+    EXPECT_EQ(status, 0);
+    sleep(5);
+    // The watch is notified once it is created
+    ASSERT_EQ(1, watch_event_created);
+    status = kv_store_client->put(handle, "/eventwatch/key", "value_1");
+    EXPECT_EQ(status, 0);
+    status = kv_store_client->put(handle, "/eventwatch/key", "value_2");
+    EXPECT_EQ(status, 0);
+    sleep(5);
+    ASSERT_EQ(2, watch_event_cb);
+    // Only the second put has a previous value, unless an earlier run left the key
+    ASSERT_GE(watch_event_prev, 1);
+
+    // A delete is notified with the value it removed
+    status = delete_key("/eventwatch/key");
+    EXPECT_EQ(status, 0);
+    sleep(5);
+    ASSERT_EQ(3, watch_event_cb);
+    ASSERT_EQ(1, watch_event_deleted);
+    ASSERT_EQ("value_2", watch_event_deleted_prev);
+    kv_client_free(kv_store_client);
+}
+
+TEST(KVStoreClientTest, watch_lazy_value){
+    std::cout << "Test Case: watch values keep the raw payload\n";
+    kv_store_client_t *kv_store_client = get_kv_store_client();
+    EXPECT_NE(kv_store_client, nullptr);
+    void *handle = kv_store_client->init(kv_store_client);
+
+    kv_store_watch_options_t opts = {};
+    opts.lazy_value = true;
+    int status = kv_store_client->watch_events(handle, "/lazywatch", &opts, watch_lazy_callback, NULL);
+    EXPECT_EQ(status, 0);
+    kv_store_client->watch(handle, "/lazywatch", watch_parsed_callback, NULL);
+    sleep(5);
+    status = kv_store_client->put(handle, "/lazywatch", "{\"lazy\": 1}");
+    EXPECT_EQ(status, 0);
+    // A value failing to parse is only notified to the lazy watch
+    status = kv_store_client->put(handle, "/lazywatch", "{\"lazy\": ");
+    EXPECT_EQ(status, 0);
+    sleep(5);
+    ASSERT_EQ(2, watch_lazy_cb);
+    ASSERT_EQ(1, watch_lazy_raw);
+    ASSERT_EQ(1, watch_parsed_cb);
+    kv_client_free(kv_store_client);
+}
+
+TEST(KVStoreClientTest, watch_dispatcher){
+    std::cout << "Test Case: watch callbacks on dispatcher threads\n";
+    config_t* config = json_config_new_from_buffer(
+            "{\"type\": \"etcd\", \"etcd_kv_store\": {\"cert_file\": \"\","
+            " \"key_file\": \"\", \"ca_file\": \"\", \"dispatcher_threads\": 8,"
+            " \"dispatcher_queue_size\": 16}}");
+    kv_store_client_t *kv_store_client = create_kv_client(config);
+    ASSERT_NE(nullptr, kv_store_client);
+    void *handle = kv_store_client->init(kv_store_client);
+    ASSERT_NE(nullptr, handle);
+
+    // The callbacks of a watch run in order on one dispatcher thread, the
+    // slow and the fast key are watched separately to run on two threads
+    std::string slow_key = "/dispatchwatch/slow";
+    std::string fast_key = "/dispatchwatch/fast";
+    kv_store_client->watch(handle, &slow_key[0], watch_dispatch_callback, NULL);
+    kv_store_client->watch(handle, &fast_key[0], watch_dispatch_callback, NULL);
+    sleep(5);
+    int status = kv_store_client->put(handle, &slow_key[0], "value_1");
+    EXPECT_EQ(status, 0);
+    status = kv_store_client->put(handle, &fast_key[0], "value_2");
+    EXPECT_EQ(status, 0);
+    // The slow callback does not hold back the other watch
+    sleep(1);
+    ASSERT_EQ(0, watch_slow_cb);
+    ASSERT_EQ(1, watch_fast_cb);
+    sleep(4);
+    ASSERT_EQ(1, watch_slow_cb);
+
+    kv_client_free(kv_store_client);
+    config_destroy(config);
+}
+
+TEST(KVStoreClientTest, watch_dispatcher_coalesce){
+    std::cout << "Test Case: watch changes coalesced on a full dispatcher queue\n";
+    config_t* config = json_config_new_from_buffer(
+            "{\"type\": \"etcd\", \"etcd_kv_store\": {\"cert_file\": \"\","
+            " \"key_file\": \"\", \"ca_file\": \"\", \"dispatcher_threads\": 1,"
+            " \"dispatcher_queue_size\": 1}}");
+    kv_store_client_t *kv_store_client = create_kv_client(config);
+    ASSERT_NE(nullptr, kv_store_client);
+    void *handle = kv_store_client->init(kv_store_client);
+    ASSERT_NE(nullptr, handle);
+
+    kv_store_client->watch_prefix(handle, "/dispatchcoalesce/", watch_coalesce_callback, NULL);
+    sleep(5);
+    // The single dispatcher thread is held by the slow callback while the
+    // key changes three times
+    int status = kv_store_client->put(handle, "/dispatchcoalesce/slow", "{\"v\": 0}");
+    EXPECT_EQ(status, 0);
+    sleep(1);
+    for (int i = 1; i <= 3; i++) {
+        std::string value = "{\"v\": " + std::to_string(i) + "}";
+        status = kv_store_client->put(handle, "/dispatchcoalesce/key", &value[0]);
+        EXPECT_EQ(status, 0);
+    }
+    sleep(4);
+    // Only the latest change is notified, the others are counted as dropped
+    ASSERT_EQ(1, watch_coalesced_cb);
+    ASSERT_EQ(3, watch_coalesced_value);
+    ASSERT_EQ((uint64_t) 2, kv_store_client->get_dropped_watch_events(handle));
+
+    kv_client_free(kv_store_client);
+    config_destroy(config);
+}
+
+TEST(KVStoreClientTest, watch_cancel){
+    std::cout << "Test Case: watch cancelled by kv_client_free()\n";
+    kv_store_client_t *watch_client = get_kv_store_client();
+    EXPECT_NE(watch_client, nullptr);
+    void *watch_handle = watch_client->init(watch_client);
+
+    watch_client->watch(watch_handle, "/watch_cancel_test", watch_cancel_callback, NULL);
+    sleep(5);
+    kv_client_free(watch_client);
+
+    kv_store_client_t *kv_store_client = get_kv_store_client();
+    EXPECT_NE(kv_store_client, nullptr);
+    void *handle = kv_store_client->init(kv_store_client);
+    int status = kv_store_client->put(handle, "/watch_cancel_test", "test_cancel");
+    EXPECT_EQ(status, 0);
+    sleep(5);
+    ASSERT_EQ(0, watch_cancel_cb);
+    kv_client_free(kv_store_client);
+}
+
+TEST(KVStoreClientTest, cache){
+    std::cout << "Test Case: kv store cache\n";
+    char* prefixes[] = {"/test_cache/"};
+    kv_store_client_t *kv_store_cache = kv_store_cache_new(get_kv_store_client(), prefixes, 1);
+    ASSERT_NE(kv_store_cache, nullptr);
+    void *cache_handle = kv_store_cache->init(kv_store_cache);
+    ASSERT_NE(cache_handle, nullptr);
+
+    kv_store_client_t *kv_store_client = get_kv_store_client();
+    EXPECT_NE(kv_store_client, nullptr);
+    void *handle = kv_store_client->init(kv_store_client);
+    int status = kv_store_client->put(handle, "/test_cache/key", "value_1");
+    EXPECT_EQ(status, 0);
+    sleep(5);
+
+    kv_store_cache_stats_t stats;
+    char *get_value = kv_store_cache->get(cache_handle, "/test_cache/key");
+    ASSERT_STREQ("value_1", get_value);
+    free(get_value);
+    get_value = kv_store_cache->get(cache_handle, "/test_cache/key");
+    ASSERT_STREQ("value_1", get_value);
+    free(get_value);
+    ASSERT_EQ(0, kv_store_cache_get_stats(kv_store_cache, &stats));
+    ASSERT_EQ(1, stats.hits);
+    ASSERT_EQ(1, stats.misses);
+
+    // A change made by another client is seen once the watch notifies it
+    status = kv_store_client->put(handle, "/test_cache/key", "value_2");
+    EXPECT_EQ(status, 0);
+    sleep(5);
+    get_value = kv_store_cache->get(cache_handle, "/test_cache/key");
+    ASSERT_STREQ("value_2", get_value);
+    free(get_value);
+    ASSERT_EQ(0, kv_store_cache_get_stats(kv_store_cache, &stats));
+    ASSERT_EQ(1, stats.invalidations);
+    ASSERT_EQ(2, stats.misses);
+
+    kv_client_free(kv_store_client);
+    kv_client_free(kv_store_cache);
+}
+
 int main(int argc, char **argv) {
 
     testing::InitGoogleTest(&argc, argv);